@@ -0,0 +1,99 @@
+// 播放事件通道：A2DP 回調送出一個事件、loop() 取出的成本
+// 另外用兩個執行緒同時送出 / 取出，確認事件內容完整、不會亂序，放不下時只丟掉並計數
+
+#include <thread>
+#include "audio_events.h"
+#include "bench_util.h"
+
+typedef AudioEventChannel<AUDIO_EVENT_QUEUE> Channel;
+
+// 事件的各欄位都由 value 算出，取出時可以檢查有沒有讀到寫到一半的事件
+static bool postNumbered(Channel &channel, uint32_t n) {
+  return channel.post(n % AUDIO_EVENT_TYPES, n & 1, (uint16_t)(n * 7), n);
+}
+
+static bool intact(const AudioEvent &event) {
+  uint32_t n = event.value;
+  return event.type == n % AUDIO_EVENT_TYPES && event.clip == (bool)(n & 1) && event.playback == (uint16_t)(n * 7);
+}
+
+static bool checkThreads() {
+  static Channel channel;
+  const uint32_t total = 2000000;
+  std::atomic<bool> done{false};
+
+  std::thread producer([&]() {
+    for (uint32_t n = 1; n <= total; n++) {
+      // 放不下（丟掉）時讓出 CPU，單核心時消費者才有機會執行
+      if (!postNumbered(channel, n)) std::this_thread::yield();
+    }
+    done = true;
+  });
+
+  uint32_t received = 0;
+  uint32_t last = 0;
+  bool ordered = true;
+  bool complete = true;
+  AudioEvent event = {};
+  for (;;) {
+    bool finished = done;  // 先讀，之後再取一次就不會漏掉最後的事件
+    bool any = false;
+    while (channel.poll(event)) {
+      if (event.value <= last) ordered = false;
+      if (!intact(event)) complete = false;
+      last = event.value;
+      received++;
+      any = true;
+    }
+    if (finished) break;
+    if (!any) std::this_thread::yield();
+  }
+  producer.join();
+
+  bool ok = benchCheck(ordered && complete, "兩個執行緒傳遞事件，內容完整、沒有亂序");
+  ok &= benchCheck(received + channel.dropped() == total, "取出的加上丟掉的等於送出的");
+  printf("    送出 %u 個，取出 %u 個，放不下丟掉 %u 個\n", (unsigned)total, (unsigned)received,
+         (unsigned)channel.dropped());
+  return ok;
+}
+
+// loop() 卡住：通道滿了之後送出的事件丟掉，回調不會等待；恢復後依序取出
+static bool checkStall() {
+  Channel channel;
+  uint32_t accepted = 0;
+  for (uint32_t n = 1; n <= AUDIO_EVENT_QUEUE + 8; n++) {
+    if (channel.post(AUDIO_EVENT_POSITION, true, 1, n)) accepted++;
+  }
+  AudioEvent event = {};
+  uint32_t expected = 1;
+  bool ordered = true;
+  while (channel.poll(event)) {
+    if (event.value != expected++) ordered = false;
+  }
+  return benchCheck(accepted == AUDIO_EVENT_QUEUE && channel.dropped() == 8 && ordered &&
+                    channel.received(AUDIO_EVENT_POSITION) == AUDIO_EVENT_QUEUE &&
+                    channel.maxPending() == AUDIO_EVENT_QUEUE,
+                    "通道滿了丟掉新事件並計數，之前的事件依序取出");
+}
+
+int main() {
+  printf("【播放事件通道】容量 %d 個事件\n", AUDIO_EVENT_QUEUE);
+
+  static Channel channel;
+  uint32_t n = 0;
+  AudioEvent event = {};
+  double ns = benchNs([&]() {
+    postNumbered(channel, n++);
+    channel.poll(event);
+    benchKeep(event.value);
+  }, 20000000);
+  benchRow("post() + poll()", ns, ns, "事件");
+
+  ns = benchNs([&]() { benchKeep(channel.poll(event)); }, 20000000);
+  benchRow("poll()（沒有事件）", ns, ns, "次");
+
+  printf("\n");
+  bool ok = checkStall();
+  ok &= checkThreads();
+  return ok ? 0 : 1;
+}
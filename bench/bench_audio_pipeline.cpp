@@ -0,0 +1,236 @@
+// A2DP 回調的音頻處理：區塊處理（audio_pipeline.h）與原本逐樣本呼叫 readSample()、
+// 浮點相位、每個 frame 檢查 EOF 的 fillSoundFrames() 比較每秒產出的 frames
+// 另外檢查重採樣結果與精確的零階保持一致、來不及補時維持上一個樣本、播完時補 0
+
+#include <string.h>
+#include <vector>
+#include "audio_pipeline.h"
+#include "bench_util.h"
+
+#define BLOCK_SAMPLES 256   // 與 main.cpp 的 AUDIO_BLOCK_SAMPLES 相同
+#define CALLBACK_FRAMES 512 // 每次回調要求的 frames（與藍牙堆疊相同）
+#define DST_RATE 44100
+#define AUDIBLE 300
+
+struct Frame {
+  int16_t channel1;
+  int16_t channel2;
+};
+
+// 模擬環形緩衝區：音源 task 已經把樣本準備好，取完從頭再來（ended = true 時播完就停）
+struct FakeRing {
+  std::vector<int16_t> data;
+  size_t pos = 0;
+  bool ended = false;
+  size_t limit = 0;  // 目前可以取到的位置（模擬來不及補）
+
+  size_t read(int16_t *dst, size_t count) {
+    if (pos >= limit) {
+      if (ended) return 0;
+      pos = 0;
+    }
+    size_t n = limit - pos;
+    if (n > count) n = count;
+    memcpy(dst, data.data() + pos, n * sizeof(int16_t));
+    pos += n;
+    return n;
+  }
+  bool sourceEnded() const { return ended && pos >= limit; }
+};
+
+static FakeRing ring;
+static bool rewardPending = false;  // 與實際播放相同，平常不在量測延遲
+static uint32_t rewardFrame = 0;
+
+// ---------- 原本的做法 ----------
+static int16_t legacyBlock[BLOCK_SAMPLES];
+static int legacyIndex = 0;
+static int legacySize = 0;
+static float legacyPosition = 1.0;
+static int16_t legacyLast = 0;
+
+static bool legacyReadSample(int16_t &sample) {
+  if (legacyIndex >= legacySize) {
+    legacySize = ring.read(legacyBlock, BLOCK_SAMPLES);
+    legacyIndex = 0;
+    if (legacySize == 0) {
+      if (ring.sourceEnded()) return false;
+      sample = legacyLast;
+      return true;
+    }
+  }
+  sample = legacyBlock[legacyIndex++];
+  return true;
+}
+
+static void legacyReset() {
+  legacyIndex = legacySize = 0;
+  legacyPosition = 1.0;
+  legacyLast = 0;
+}
+
+static bool legacyFill(Frame *frame, int32_t count, uint32_t rate) {
+  float ratio = (float)rate / (float)DST_RATE;
+  for (int i = 0; i < count; i++) {
+    if (legacyPosition >= 1.0) {
+      int16_t sample;
+      if (!legacyReadSample(sample)) {
+        for (int j = i; j < count; j++) frame[j].channel1 = frame[j].channel2 = 0;
+        return false;
+      }
+      legacyLast = sample;
+      legacyPosition -= 1.0;
+      if (rewardPending && (sample > AUDIBLE || sample < -AUDIBLE)) {
+        rewardFrame = i;
+        rewardPending = false;
+      }
+    }
+    frame[i].channel1 = legacyLast;
+    frame[i].channel2 = legacyLast;
+    legacyPosition += ratio;
+  }
+  return true;
+}
+
+// ---------- 區塊處理（與 main.cpp 的 fillSoundFrames() 相同） ----------
+static AudioPipeline<BLOCK_SAMPLES> pipeline(DST_RATE);
+
+static bool blockFill(Frame *frame, int32_t count, uint32_t rate) {
+  pipeline.setSourceRate(rate);
+  for (int32_t done = 0; done < count;) {
+    int32_t n = count - done;
+    if (n > BLOCK_SAMPLES) n = BLOCK_SAMPLES;
+    uint32_t need = pipeline.needed(n);
+    uint32_t got = ring.read(pipeline.fetchBuffer(), need);
+    bool ended = false;
+    if (got < need) {
+      ended = ring.sourceEnded();
+      pipeline.pad(got, need, ended);
+    }
+    const int16_t *mono = pipeline.resample(n);
+    if (rewardPending) {
+      for (int32_t i = 0; i < n; i++) {
+        if (mono[i] > AUDIBLE || mono[i] < -AUDIBLE) {
+          rewardFrame = done + i;
+          rewardPending = false;
+          break;
+        }
+      }
+    }
+    writeMonoFrames(frame + done, mono, n);
+    done += n;
+    if (ended) {
+      writeSilentFrames(frame + done, count - done);
+      return false;
+    }
+  }
+  return true;
+}
+
+static Frame frames[CALLBACK_FRAMES];
+
+static void benchRate(const char *title, uint32_t rate) {
+  const long iterations = 100000;
+  printf("【%s】每次回調 %d frames\n", title, CALLBACK_FRAMES);
+  ring.ended = false;
+  ring.limit = ring.data.size();
+
+  ring.pos = 0;
+  legacyReset();
+  double legacyNs = benchNs([&]() {
+    legacyFill(frames, CALLBACK_FRAMES, rate);
+    benchKeep(frames[CALLBACK_FRAMES - 1].channel1);
+  }, iterations);
+  benchRow("原本逐樣本", legacyNs, legacyNs / CALLBACK_FRAMES, "frame");
+
+  ring.pos = 0;
+  pipeline.reset();
+  double blockNs = benchNs([&]() {
+    blockFill(frames, CALLBACK_FRAMES, rate);
+    benchKeep(frames[CALLBACK_FRAMES - 1].channel1);
+  }, iterations);
+  benchRow("區塊處理", blockNs, blockNs / CALLBACK_FRAMES, "frame");
+
+  printf("  每秒 %.1f → %.1f 百萬 frames（%.1f 倍）\n\n", CALLBACK_FRAMES * 1000.0 / legacyNs,
+         CALLBACK_FRAMES * 1000.0 / blockNs, legacyNs / blockNs);
+}
+
+// 播一段音源到結束，收集所有輸出
+static std::vector<int16_t> playToEnd(size_t samples, int32_t callbackFrames, uint32_t rate) {
+  std::vector<int16_t> out;
+  ring.pos = 0;
+  ring.limit = samples;
+  ring.ended = true;
+  pipeline.reset();
+  static Frame buffer[CALLBACK_FRAMES];
+  bool playing = true;
+  while (playing) {
+    playing = blockFill(buffer, callbackFrames, rate);
+    for (int32_t i = 0; i < callbackFrames; i++) out.push_back(buffer[i].channel1);
+  }
+  return out;
+}
+
+static bool checkPipeline() {
+  bool ok = true;
+  printf("【正確性】\n");
+
+  // 精確的零階保持：第 i 個輸出 = 第 floor(i * rate / 44100) 個來源樣本，播完之後全是 0
+  // （4kHz 每個樣本重複超過 AUDIO_RUN_MAX 次，走通用做法）
+  const uint32_t rates[] = {8000, 16000, 22050, 4000};
+  bool exact = true;
+  for (uint32_t rate : rates) {
+    const size_t samples = rate + 123;
+    std::vector<int16_t> out = playToEnd(samples, 300, rate);  // 回調大小不是區塊的整數倍
+    size_t last = 0;
+    for (size_t i = 0; i < out.size(); i++) {
+      size_t src = (size_t)((uint64_t)i * rate / DST_RATE);
+      int16_t expected = src < samples ? ring.data[src] : 0;
+      if (out[i] != expected) exact = false;
+      if (src < samples) last = i;
+    }
+    if (out.size() <= last + 1) exact = false;
+  }
+  ok &= benchCheck(exact, "8k / 16k / 22.05k / 4kHz 重採樣都與精確的零階保持一致，播完後補 0");
+
+  // 整數相位不累積誤差：播了 N 秒，取用的來源樣本剛好是 N * 8000 個
+  ring.data.assign(8000 * 30, 1000);
+  ring.pos = 0;
+  ring.limit = ring.data.size();
+  ring.ended = true;
+  pipeline.reset();
+  long callbacks = 30L * DST_RATE / CALLBACK_FRAMES;
+  for (long i = 0; i < callbacks; i++) blockFill(frames, CALLBACK_FRAMES, 8000);
+  size_t expectedUsed = (size_t)((uint64_t)(callbacks * CALLBACK_FRAMES - 1) * 8000 / DST_RATE) + 1;
+  ok &= benchCheck(ring.pos == expectedUsed, "播放 30 秒後取用的來源樣本數沒有誤差");
+
+  // 來不及補：維持上一個樣本，補上之後從下一個樣本繼續
+  for (size_t i = 0; i < ring.data.size(); i++) ring.data[i] = (int16_t)(i + 1);
+  ring.pos = 0;
+  ring.limit = 10;
+  ring.ended = false;
+  pipeline.reset();
+  blockFill(frames, 100, 8000);  // 需要 18 個，只有 10 個
+  bool held = frames[99].channel1 == 10 && frames[99].channel2 == 10;
+  ring.limit = 1000;
+  blockFill(frames, 10, 8000);
+  ok &= benchCheck(held && frames[0].channel1 == 11, "來不及補時維持上一個樣本，之後接著播");
+
+  // 44.1kHz 合成音效一比一複製
+  ring.pos = 0;
+  pipeline.reset();
+  blockFill(frames, CALLBACK_FRAMES, DST_RATE);
+  bool same = true;
+  for (int i = 0; i < CALLBACK_FRAMES; i++) same &= frames[i].channel1 == i + 1;
+  ok &= benchCheck(same, "與輸出相同取樣率時一比一複製");
+  return ok;
+}
+
+int main() {
+  ring.data.resize(8000 * 6);  // 6 秒 8kHz
+  for (size_t i = 0; i < ring.data.size(); i++) ring.data[i] = (int16_t)(i * 37);
+
+  benchRate("8kHz 音檔 → 44.1kHz", 8000);
+  benchRate("44.1kHz 合成音效", DST_RATE);
+  return checkPipeline() ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+// 音源區塊讀取成本比較（MemorySource / StreamSource / ToneSource）
+// 以及原本逐樣本組合 bytes 的 readSample() 作為對照
+
+#include <string.h>
+#include <vector>
+#include "playback_source.h"
+#include "bench_util.h"
+
+#define BLOCK_SAMPLES 256
+#define CLIP_SAMPLES (8000 * 6)  // 6 秒 8kHz
+
+// 模擬 ClipReader：虛擬 read()，資料在 RAM 中
+class FakeReader {
+ public:
+  virtual ~FakeReader() {}
+  virtual size_t read(uint8_t *buf, size_t len) {
+    size_t left = size - pos;
+    if (len > left) len = left;
+    memcpy(buf, data + pos, len);
+    pos += len;
+    return len;
+  }
+  virtual uint32_t position() { return pos; }
+  virtual void close() {}
+
+  const uint8_t *data = NULL;
+  size_t size = 0;
+  size_t pos = 0;
+};
+
+static std::vector<int16_t> clip(CLIP_SAMPLES);
+static int16_t block[BLOCK_SAMPLES];
+
+// 原本的做法：512 bytes 緩衝，逐樣本檢查並組合高低位元組
+static uint8_t legacyBuffer[512];
+static int legacyIndex = 0;
+static int legacySize = 0;
+
+static int16_t legacyReadSample(FakeReader &reader) {
+  if (legacyIndex >= legacySize) {
+    legacySize = reader.read(legacyBuffer, sizeof(legacyBuffer));
+    legacyIndex = 0;
+    if (legacySize == 0) return 0;
+  }
+  if (legacyIndex + 1 < legacySize) {
+    uint8_t low = legacyBuffer[legacyIndex++];
+    uint8_t high = legacyBuffer[legacyIndex++];
+    return (int16_t)((high << 8) | low);
+  }
+  return 0;
+}
+
+int main() {
+  for (size_t i = 0; i < clip.size(); i++) clip[i] = (int16_t)(i * 37);
+  const long iterations = 200000;
+
+  printf("【音源區塊讀取】每區塊 %d 樣本\n", BLOCK_SAMPLES);
+
+  MemorySource memory;
+  double ns = benchNs([&]() {
+    if (memory.remaining() < BLOCK_SAMPLES) memory.begin(clip.data(), clip.size());
+    benchKeep(memory.pull(block, BLOCK_SAMPLES) + block[0]);
+  }, iterations);
+  benchRow("MemorySource", ns, ns / BLOCK_SAMPLES, "sample");
+
+  FakeReader reader;
+  reader.data = (const uint8_t *)clip.data();
+  reader.size = clip.size() * sizeof(int16_t);
+  StreamSource<FakeReader> stream;
+  stream.begin(&reader);
+  ns = benchNs([&]() {
+    if (reader.pos >= reader.size) reader.pos = 0;
+    benchKeep(stream.pull(block, BLOCK_SAMPLES) + block[0]);
+  }, iterations);
+  benchRow("StreamSource（假 reader）", ns, ns / BLOCK_SAMPLES, "sample");
+
+  ToneSource tone;
+  tone.begin(440, 8000, 6000, 8000);
+  ns = benchNs([&]() {
+    if (tone.pull(block, BLOCK_SAMPLES) == 0) tone.begin(440, 8000, 6000, 8000);
+    benchKeep(block[0]);
+  }, iterations);
+  benchRow("ToneSource", ns, ns / BLOCK_SAMPLES, "sample");
+
+  PlaybackSource<FakeReader> playback;
+  playback.playMemory(clip.data(), clip.size(), 8000);
+  ns = benchNs([&]() {
+    if (playback.pull(block, BLOCK_SAMPLES) == 0) playback.playMemory(clip.data(), clip.size(), 8000);
+    benchKeep(block[0]);
+  }, iterations);
+  benchRow("PlaybackSource（記憶體）", ns, ns / BLOCK_SAMPLES, "sample");
+
+  // 套用音量（clips.meta 的增益，+6 dB）
+  playback.playMemory(clip.data(), clip.size(), 8000, AUDIO_GAIN_UNITY * 2);
+  ns = benchNs([&]() {
+    if (playback.pull(block, BLOCK_SAMPLES) == 0) {
+      playback.playMemory(clip.data(), clip.size(), 8000, AUDIO_GAIN_UNITY * 2);
+    }
+    benchKeep(block[0]);
+  }, iterations);
+  benchRow("PlaybackSource（記憶體 + 音量）", ns, ns / BLOCK_SAMPLES, "sample");
+
+  reader.pos = 0;
+  ns = benchNs([&]() {
+    if (reader.pos >= reader.size) reader.pos = 0;
+    uint32_t sum = 0;
+    for (int i = 0; i < BLOCK_SAMPLES; i++) sum += legacyReadSample(reader);
+    benchKeep(sum);
+  }, iterations);
+  benchRow("原本 readSample() 逐樣本", ns, ns / BLOCK_SAMPLES, "sample");
+
+  // 正確性：只播 clips.meta 指定的範圍，增益後截斷不溢位
+  printf("\n【播放範圍與音量】\n");
+  const uint32_t start = 1000 * sizeof(int16_t);
+  const uint32_t end = 5001 * sizeof(int16_t);
+  PlaybackSource<FakeReader> ranged;
+  reader.pos = start;
+  ranged.playStream(&reader, 8000, AUDIO_GAIN_UNITY * 4, end);
+  bool correct = true;
+  size_t played = 0;
+  while (size_t n = ranged.pull(block, BLOCK_SAMPLES)) {
+    for (size_t i = 0; i < n; i++) {
+      int32_t expected = (int32_t)clip[start / sizeof(int16_t) + played + i] * 4;
+      if (expected > 32767) expected = 32767;
+      if (expected < -32768) expected = -32768;
+      if (block[i] != expected) correct = false;
+    }
+    played += n;
+  }
+  if (!correct || played != (end - start) / sizeof(int16_t)) {
+    printf("  ❌ 播放 %zu 個樣本（預期 %u），內容%s\n", played, (unsigned)((end - start) / sizeof(int16_t)),
+           correct ? "正確" : "錯誤");
+    return 1;
+  }
+  printf("  ✅ 播放 %zu 個樣本，剛好停在結尾，增益正確\n", played);
+
+  return 0;
+}
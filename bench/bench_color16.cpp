@@ -0,0 +1,99 @@
+// 燈光輸出每幀成本：原本 8-bit 路徑 vs 16-bit gamma + 時間抖動（13 位元 LEDC）
+// 另外統計淡出過程實際輸出幾種不同亮度（階數不夠就會看到一階一階）
+
+#include <set>
+#include "color16.h"
+#include "bench_util.h"
+
+#define HIRES_BITS 13
+
+// 與 src/main.cpp 相同的彩虹色彩計算
+static void getRainbowColor(int position, int &r, int &g, int &b) {
+  position = position % 256;
+  if (position < 85) {
+    r = 255 - position * 3; g = position * 3; b = 0;
+  } else if (position < 170) {
+    position -= 85;
+    r = 0; g = 255 - position * 3; b = position * 3;
+  } else {
+    position -= 170;
+    r = position * 3; g = 0; b = 255 - position * 3;
+  }
+}
+
+static uint32_t duty[3];
+
+// 8-bit：彩虹 → 乘亮度 → 共陽極反轉
+static void frame8(size_t count, int colorPos, uint16_t brightness) {
+  for (size_t i = 0; i < count; i++) {
+    int r, g, b;
+    getRainbowColor(colorPos + (int)i, r, g, b);
+    PixelColor color = {(uint8_t)r, (uint8_t)g, (uint8_t)b};
+    color = pixelScaled(color, brightness >> 8);
+    duty[0] = 255 - color.r;
+    duty[1] = 255 - color.g;
+    duty[2] = 255 - color.b;
+  }
+}
+
+// 16-bit：彩虹 → gamma 展開 → 乘線性亮度 → 抖動到 13 位元 → 反轉
+static uint16_t residues[3];
+static void frame16(size_t count, int colorPos, uint16_t brightness) {
+  uint16_t level = gammaLevel16(brightness);
+  for (size_t i = 0; i < count; i++) {
+    int r, g, b;
+    getRainbowColor(colorPos + (int)i, r, g, b);
+    PixelColor color = {(uint8_t)r, (uint8_t)g, (uint8_t)b};
+    PixelColor16 linear;
+    pixelGammaExpand(&linear, &color, 1);
+    pixelScale16(&linear, 1, level);
+    const uint32_t max = (1u << HIRES_BITS) - 1;
+    duty[0] = max - ditherStep(linear.r, HIRES_BITS, residues[0]);
+    duty[1] = max - ditherStep(linear.g, HIRES_BITS, residues[1]);
+    duty[2] = max - ditherStep(linear.b, HIRES_BITS, residues[2]);
+  }
+}
+
+int main() {
+  printf("【燈光輸出】每幀成本（類比燈條 = 1 顆）\n");
+  const long iterations = 2000000;
+  volatile int colorPos = 17;
+  const size_t counts[] = {1, 60};
+
+  for (size_t count : counts) {
+    uint16_t brightness = 0;
+    double ns8 = benchNs([&]() {
+      frame8(count, colorPos, brightness += 97);
+      benchKeep(duty[0] + duty[1] + duty[2]);
+    }, iterations / count);
+    double ns16 = benchNs([&]() {
+      frame16(count, colorPos, brightness += 97);
+      benchKeep(duty[0] + duty[1] + duty[2]);
+    }, iterations / count);
+
+    char label[40];
+    snprintf(label, sizeof(label), "8-bit（%zu 顆）", count);
+    benchRow(label, ns8, ns8 / count, "pixel");
+    snprintf(label, sizeof(label), "16-bit + 抖動（%zu 顆）", count);
+    benchRow(label, ns16, ns16 / count, "pixel");
+  }
+
+  // 呼吸淡出 2 秒（100 幀/秒，共 200 幀）紅色通道實際輸出了幾種不同亮度
+  // 8-bit 加 gamma 後低亮度會擠在同一階（看起來一階一階），16-bit + 抖動每幀都不同
+  // 16-bit 路徑以 1kHz 抖動，每幀取 10 次輸出的總和
+  std::set<uint32_t> linear8, gamma8, gamma16Dither;
+  uint16_t residue = 0;
+  for (int frame = 0; frame < 200; frame++) {
+    uint16_t brightness = (uint16_t)(65535 - frame * 65535L / 200);
+    linear8.insert(pixelScaled({255, 0, 0}, brightness >> 8).r);
+    gamma8.insert(gamma16(255) * (uint32_t)gammaLevel16(brightness) / 65535 >> 8);
+
+    uint16_t linear = scale16(gamma16(255), gammaLevel16(brightness));
+    uint32_t sum = 0;
+    for (int k = 0; k < 10; k++) sum += ditherStep(linear, HIRES_BITS, residue);
+    gamma16Dither.insert(sum);
+  }
+  printf("\n  淡出 200 幀的不同輸出亮度：8-bit（現行，無 gamma）%zu 階，8-bit + gamma %zu 階，"
+         "16-bit + gamma + 抖動 %zu 階\n", linear8.size(), gamma8.size(), gamma16Dither.size());
+  return 0;
+}
@@ -0,0 +1,81 @@
+// 閒置判斷（idle_policy.h）：每次 loop() 呼叫 idleDecide() 的成本，
+// 並逐一檢查每個擋住休眠的原因，以及全部條件都滿足時才休眠
+
+#include "idle_policy.h"
+#include "bench_util.h"
+
+// 可以休眠的狀態：NORMAL、沒播放、沒按按鈕、藍牙沒連線、燈光全亮/全暗、安靜夠久
+static IdleInputs quietInputs(unsigned long now) {
+  IdleInputs in;
+  in.now = now;
+  in.lastActivity = now - IDLE_QUIET_MS;
+  in.normalState = true;
+  in.playing = false;
+  in.buttonHeld = false;
+  in.linkActive = false;
+  in.ledsSteady = true;
+  return in;
+}
+
+static bool checkDecisions() {
+  bool ok = true;
+  printf("【正確性】\n");
+
+  IdleInputs in = quietInputs(100000);
+  ok &= benchCheck(idleDecide(in) == IDLE_SLEEP, "全部條件都滿足時休眠");
+
+  in = quietInputs(100000);
+  in.normalState = false;
+  ok &= benchCheck(idleDecide(in) == IDLE_BUSY_STATE, "不在 NORMAL 模式（抽籤動畫）不休眠");
+
+  in = quietInputs(100000);
+  in.playing = true;
+  ok &= benchCheck(idleDecide(in) == IDLE_BUSY_PLAYING, "播放中不休眠");
+
+  in = quietInputs(100000);
+  in.buttonHeld = true;
+  ok &= benchCheck(idleDecide(in) == IDLE_BUSY_BUTTON, "按鈕還按著不休眠");
+
+  in = quietInputs(100000);
+  in.linkActive = true;
+  ok &= benchCheck(idleDecide(in) == IDLE_BUSY_LINK, "藍牙連線中或正在連線不休眠");
+
+  in = quietInputs(100000);
+  in.ledsSteady = false;
+  ok &= benchCheck(idleDecide(in) == IDLE_BUSY_PWM, "燈光需要 PWM 或燈條畫面還在傳送時不休眠");
+
+  in = quietInputs(100000);
+  in.lastActivity = in.now - IDLE_QUIET_MS + 1;
+  ok &= benchCheck(idleDecide(in) == IDLE_BUSY_RECENT, "最後一次操作未滿 IDLE_QUIET_MS 不休眠");
+
+  // 多個原因同時存在時回報第一個（與 idleDecide() 的檢查順序相同）
+  in = quietInputs(100000);
+  in.normalState = false;
+  in.playing = true;
+  in.ledsSteady = false;
+  in.lastActivity = in.now;
+  ok &= benchCheck(idleDecide(in) == IDLE_BUSY_STATE, "同時有多個原因時回報最前面的");
+
+  // millis() 溢位：最後一次操作在溢位前，經過的時間仍正確
+  in = quietInputs(2000);
+  in.lastActivity = (unsigned long)0 - 2000;
+  ok &= benchCheck(idleDecide(in) == IDLE_BUSY_RECENT, "millis() 溢位後仍算出安靜不到 5 秒");
+  in.now = IDLE_QUIET_MS - 2000;
+  ok &= benchCheck(idleDecide(in) == IDLE_SLEEP, "millis() 溢位後安靜滿 5 秒就休眠");
+  return ok;
+}
+
+int main() {
+  printf("【閒置判斷】每次 loop() 呼叫一次\n");
+  IdleInputs in = quietInputs(100000);
+  unsigned long n = 0;
+  double ns = benchNs([&]() {
+    in.now = 100000 + (n++ & 0x1FFF);
+    in.ledsSteady = (n & 3) != 0;
+    benchKeep(idleDecide(in));
+  }, 20000000);
+  benchRow("idleDecide()", ns, ns, "次");
+
+  printf("\n");
+  return checkDecisions() ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+// 像素運算成本：整批 multiply-shift 與原本逐色 (c * brightness) / 255 的比較
+// 燈條長度 60 / 300 / 1000 顆，每個數字是處理一整幀的時間
+
+#include <vector>
+#include "pixel_kernels.h"
+#include "bench_util.h"
+
+// 原本的做法：每顆 LED 三次除法
+static void divideScale(PixelColor *pixels, size_t count, int brightness) {
+  for (size_t i = 0; i < count; i++) {
+    pixels[i].r = (pixels[i].r * brightness) / 255;
+    pixels[i].g = (pixels[i].g * brightness) / 255;
+    pixels[i].b = (pixels[i].b * brightness) / 255;
+  }
+}
+
+static void fillGradient(std::vector<PixelColor> &pixels) {
+  for (size_t i = 0; i < pixels.size(); i++) {
+    pixels[i].r = (uint8_t)(i * 7);
+    pixels[i].g = (uint8_t)(i * 13 + 80);
+    pixels[i].b = (uint8_t)(255 - i * 3);
+  }
+}
+
+static void benchFrame(size_t count) {
+  std::vector<PixelColor> frame(count), other(count), saved(count);
+  fillGradient(frame);
+  fillGradient(other);
+  saved = frame;
+  const long iterations = 2000000 / count;
+  double ns;
+
+  printf("\n  --- %zu 顆 ---\n", count);
+
+  // 亮度在迴圈中變動，避免編譯器把除數當常數最佳化
+  volatile int brightness = 200;
+
+  ns = benchNs([&]() {
+    frame = saved;
+    divideScale(frame.data(), count, brightness);
+    benchKeep(frame[count / 2].r);
+  }, iterations);
+  benchRow("逐色 /255（原本）", ns, ns / count, "pixel");
+
+  ns = benchNs([&]() {
+    frame = saved;
+    pixelScale(frame.data(), count, (uint8_t)brightness);
+    benchKeep(frame[count / 2].r);
+  }, iterations);
+  benchRow("pixelScale", ns, ns / count, "pixel");
+
+  ns = benchNs([&]() {
+    frame = saved;
+    pixelFadeToBlack(frame.data(), count, 16);
+    benchKeep(frame[count / 2].r);
+  }, iterations);
+  benchRow("pixelFadeToBlack", ns, ns / count, "pixel");
+
+  ns = benchNs([&]() {
+    frame = saved;
+    pixelAddSat(frame.data(), other.data(), count);
+    benchKeep(frame[count / 2].r);
+  }, iterations);
+  benchRow("pixelAddSat", ns, ns / count, "pixel");
+
+  ns = benchNs([&]() {
+    pixelLerp(frame.data(), saved.data(), other.data(), count, (uint8_t)brightness);
+    benchKeep(frame[count / 2].r);
+  }, iterations);
+  benchRow("pixelLerp", ns, ns / count, "pixel");
+
+  ns = benchNs([&]() {
+    frame = saved;
+    pixelHueRotate(frame.data(), count, 40);
+    benchKeep(frame[count / 2].r);
+  }, iterations);
+  benchRow("pixelHueRotate", ns, ns / count, "pixel");
+
+  // 複製本身的成本（上面多數項目包含一次複製）
+  ns = benchNs([&]() {
+    frame = saved;
+    benchKeep(frame[count / 2].r);
+  }, iterations);
+  benchRow("（僅複製畫面）", ns, ns / count, "pixel");
+}
+
+int main() {
+  printf("【像素運算】每幀處理整條燈條\n");
+
+  // 正確性抽查：255 不變、0 全暗、lerp 端點、色相旋轉 0 不變
+  PixelColor c = {200, 100, 7};
+  PixelColor full = pixelScaled(c, 255);
+  PixelColor off = pixelScaled(c, 0);
+  PixelColor a[1] = {{10, 20, 30}}, b[1] = {{250, 240, 230}}, out[1];
+  pixelLerp(out, a, b, 1, 255);
+  PixelColor rot[1] = {c};
+  pixelHueRotate(rot, 1, 0);
+  bool ok = full.r == 200 && full.b == 7 && off.r == 0 && out[0].r == 250 && out[0].b == 230 &&
+            rot[0].r == 200 && rot[0].g == 100 && rot[0].b == 7;
+  printf("  正確性抽查：%s\n", ok ? "OK" : "❌ 失敗");
+
+  const size_t counts[] = {60, 300, 1000};
+  for (size_t count : counts) benchFrame(count);
+  return ok ? 0 : 1;
+}
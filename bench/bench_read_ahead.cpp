@@ -0,0 +1,164 @@
+// 預讀大小自動調整：用簡單的 flash 讀取延遲模型比較「固定 512 bytes」與自動調整
+//   每次讀取耗時 = 固定成本 + bytes × 每 byte 成本（+ 跨越檔案中 4KB 邊界的額外成本）
+// 數字是模型估計，實際耗時用裝置上的 R 指令查看
+
+#include <string.h>
+#include <vector>
+#include "audio_source.h"
+#include "bench_util.h"
+
+#define BLOCK_SAMPLES 256
+#define WAV_HEADER 44
+
+struct FlashModel {
+  const char *name;
+  uint32_t overheadUs;   // 每次讀取的固定成本（檔案系統查表、SPI 指令）
+  float usPerByte;
+  uint32_t boundaryPenaltyUs;  // 模型假設：讀取跨越檔案中的 4KB 邊界時多查一次表
+};
+
+static uint32_t clockUs = 0;
+static uint32_t modelClock() { return clockUs; }
+
+// 假的 flash 檔案：每次 read() 依模型推進虛擬時鐘
+class ModelReader {
+ public:
+  size_t read(uint8_t *buf, size_t len) {
+    size_t left = data.size() - pos;
+    if (len > left) len = left;
+    if (len == 0) return 0;
+
+    uint32_t cost = model->overheadUs + (uint32_t)(len * model->usPerByte);
+    if (pos / READ_AHEAD_CEILING != (pos + len - 1) / READ_AHEAD_CEILING) cost += model->boundaryPenaltyUs;
+    clockUs += cost;
+    totalUs += cost;
+    if (cost > maxUs) maxUs = cost;
+    reads++;
+
+    memcpy(buf, data.data() + pos, len);
+    pos += len;
+    return len;
+  }
+  uint32_t position() { return pos; }
+  void close() {}
+
+  std::vector<uint8_t> data;
+  const FlashModel *model = NULL;
+  size_t pos = 0;
+  uint32_t reads = 0;
+  uint64_t totalUs = 0;
+  uint32_t maxUs = 0;
+};
+
+// 對照組：原本的做法，每次固定讀 readSize bytes（不對齊）
+class FixedStream {
+ public:
+  size_t pull(ModelReader &reader, int16_t *dst, size_t n, size_t readSize) {
+    size_t got = 0;
+    while (got < n) {
+      if (index >= size) {
+        size = reader.read(buffer, readSize);
+        index = 0;
+        if (size == 0) break;
+      }
+      size_t take = (size - index) / 2;
+      if (take > n - got) take = n - got;
+      memcpy(dst + got, buffer + index, take * 2);
+      index += take * 2;
+      got += take;
+    }
+    return got;
+  }
+
+ private:
+  uint8_t buffer[READ_AHEAD_CEILING];
+  size_t index = 0;
+  size_t size = 0;
+};
+
+static void printRow(const char *label, const ModelReader &reader, double audioSeconds) {
+  printf("  %-26s %6.1f 次/秒  %5u bytes/次  讀取 %6.0f us/秒  最長 %5u us\n", label,
+         reader.reads / audioSeconds, (unsigned)((reader.data.size() - WAV_HEADER) / reader.reads),
+         reader.totalUs / audioSeconds, (unsigned)reader.maxUs);
+}
+
+static void runModel(const FlashModel &model, uint32_t rate, const std::vector<uint8_t> &file) {
+  double audioSeconds = (file.size() - WAV_HEADER) / 2.0 / rate;
+  int16_t block[BLOCK_SAMPLES];
+  printf("\n  --- %s，%u Hz ---\n", model.name, (unsigned)rate);
+
+  const size_t fixedSizes[2] = {512, 4096};
+  for (int f = 0; f < 2; f++) {
+    ModelReader reader;
+    reader.data = file;
+    reader.model = &model;
+    reader.pos = WAV_HEADER;
+    static FixedStream fixed;
+    fixed = FixedStream();
+    while (fixed.pull(reader, block, BLOCK_SAMPLES, fixedSizes[f]) > 0) {}
+    char label[48];
+    snprintf(label, sizeof(label), "固定 %u bytes%s", (unsigned)fixedSizes[f], f == 0 ? "（原本）" : "");
+    printRow(label, reader, audioSeconds);
+  }
+
+  ModelReader reader;
+  reader.data = file;
+  reader.model = &model;
+  reader.pos = WAV_HEADER;
+  StreamSource<ModelReader> stream;  // 每次從頭學起（裝置上會沿用上一個音檔學到的大小）
+  stream.begin(&reader, rate * 2, modelClock);
+  while (stream.pull(block, BLOCK_SAMPLES) > 0) {}
+  printRow("自動調整", reader, audioSeconds);
+  printf("  %-26s 最後 %u bytes（放大 %u 次、縮小 %u 次）\n", "", (unsigned)stream.readAhead().chunkSize(),
+         (unsigned)stream.readAhead().readStats().grows, (unsigned)stream.readAhead().readStats().shrinks);
+}
+
+// 經過預讀緩衝區讀出的樣本要和檔案內容完全相同（各種區塊大小、奇數長度）
+static bool checkIntegrity(const std::vector<uint8_t> &file) {
+  static const FlashModel model = {"check", 300, 0.5f, 0};
+  const size_t blocks[4] = {1, 37, 256, 1000};
+  for (int b = 0; b < 4; b++) {
+    ModelReader reader;
+    reader.data = file;
+    reader.model = &model;
+    reader.pos = WAV_HEADER;
+    StreamSource<ModelReader> stream;
+    stream.begin(&reader, 16000, modelClock);
+
+    std::vector<int16_t> out;
+    std::vector<int16_t> block(blocks[b]);
+    size_t n;
+    while ((n = stream.pull(block.data(), block.size())) > 0) out.insert(out.end(), block.begin(), block.begin() + n);
+
+    size_t expected = (file.size() - WAV_HEADER) / 2;
+    if (out.size() != expected || memcmp(out.data(), file.data() + WAV_HEADER, expected * 2) != 0) {
+      printf("  ❌ 區塊 %u 樣本：輸出與檔案內容不同\n", (unsigned)blocks[b]);
+      return false;
+    }
+  }
+  printf("  ✅ 各種區塊大小讀出的樣本與檔案內容相同\n");
+  return true;
+}
+
+int main() {
+  const FlashModel models[2] = {
+    {"SPIFFS（約 4MB/s）", 400, 0.25f, 150},
+    {"較慢的 flash（約 1MB/s）", 400, 1.0f, 150},
+  };
+  const uint32_t rates[2] = {8000, 16000};
+
+  printf("【預讀】每次從音源取 %d 樣本，讀取預算 %d us，記憶體上限 %d bytes\n",
+         BLOCK_SAMPLES, READ_AHEAD_BUDGET_US, READ_AHEAD_MAX);
+  for (int m = 0; m < 2; m++) {
+    for (int r = 0; r < 2; r++) {
+      std::vector<uint8_t> file(WAV_HEADER + rates[r] * 2 * 6);  // 6 秒
+      for (size_t i = 0; i < file.size(); i++) file[i] = (uint8_t)(i * 131 + (i >> 9));
+      runModel(models[m], rates[r], file);
+    }
+  }
+
+  printf("\n");
+  std::vector<uint8_t> odd(WAV_HEADER + 33333);
+  for (size_t i = 0; i < odd.size(); i++) odd[i] = (uint8_t)(i * 7 + 3);
+  return checkIntegrity(odd) ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// 環形緩衝區成本：音源 task 放入一個區塊、A2DP 回調取出一個區塊，與直接複製一個區塊比較
+// 另外用兩個執行緒同時放入 / 取出，確認樣本不會遺失、重複或亂序
+
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include "spsc_ring.h"
+#include "bench_util.h"
+
+#define BLOCK 256  // 與 AUDIO_BLOCK_SAMPLES 相同
+
+typedef SpscRing<int16_t, 4096> Ring;
+
+// 生產者以不規則的區塊大小放入遞增的數列，消費者同樣不規則地取出並檢查
+static bool checkOrdering() {
+  static Ring ring;
+  const uint32_t total = 20000000;
+  uint32_t mismatchAt = 0;
+  bool mismatch = false;
+
+  std::thread producer([&]() {
+    int16_t chunk[BLOCK];
+    uint32_t next = 0;
+    unsigned seed = 1;
+    while (next < total) {
+      uint32_t want = 1 + rand_r(&seed) % BLOCK;
+      if (want > total - next) want = total - next;
+      for (uint32_t i = 0; i < want; i++) chunk[i] = (int16_t)(next + i);
+      uint32_t pushed = 0;
+      while (pushed < want) pushed += ring.push(chunk + pushed, want - pushed);
+      next += want;
+    }
+  });
+
+  int16_t chunk[BLOCK];
+  uint32_t expected = 0;
+  unsigned seed = 2;
+  while (expected < total) {
+    uint32_t got = ring.pop(chunk, 1 + rand_r(&seed) % BLOCK);
+    for (uint32_t i = 0; i < got; i++) {
+      if (!mismatch && chunk[i] != (int16_t)(expected + i)) {
+        mismatch = true;
+        mismatchAt = expected + i;
+      }
+    }
+    expected += got;
+  }
+  producer.join();
+
+  if (mismatch) {
+    printf("  ❌ 第 %u 個樣本順序錯誤\n", (unsigned)mismatchAt);
+    return false;
+  }
+  printf("  ✅ 兩個執行緒傳遞 %u 個樣本，沒有遺失或亂序\n", (unsigned)total);
+  return true;
+}
+
+// 換音源：生產者暫停時記下寫入位置，消費者丟掉之前的樣本，只會讀到新音源
+static bool checkDiscard() {
+  static Ring ring;
+  int16_t block[BLOCK];
+  for (int i = 0; i < BLOCK; i++) block[i] = 1;
+  ring.push(block, BLOCK);
+  ring.pop(block, 10);
+
+  uint32_t flushTo = ring.writePosition();
+  for (int i = 0; i < BLOCK; i++) block[i] = 2;
+  ring.push(block, 100);
+  ring.discardTo(flushTo);
+  ring.discardTo(flushTo);  // 重複套用不影響
+
+  uint32_t got = ring.pop(block, BLOCK);
+  for (uint32_t i = 0; i < got; i++) {
+    if (block[i] != 2) got = 0;
+  }
+  if (got != 100) {
+    printf("  ❌ 換音源後讀到舊樣本或少了新樣本\n");
+    return false;
+  }
+  printf("  ✅ 換音源後只讀到新音源的樣本\n");
+  return true;
+}
+
+int main() {
+  printf("【環形緩衝區】每次 %d 個樣本\n", BLOCK);
+
+  static int16_t source[BLOCK];
+  static int16_t dest[BLOCK];
+  for (int i = 0; i < BLOCK; i++) source[i] = (int16_t)(i * 37);
+
+  double ns = benchNs([&]() {
+    memcpy(dest, source, sizeof(source));
+    benchKeep(dest[BLOCK - 1]);
+  }, 5000000);
+  benchRow("直接複製（原本的區塊緩衝區）", ns, ns / BLOCK, "樣本");
+
+  static Ring ring;
+  ns = benchNs([&]() {
+    ring.push(source, BLOCK);
+    benchKeep(ring.pop(dest, BLOCK));
+  }, 5000000);
+  benchRow("push + pop", ns, ns / BLOCK, "樣本");
+
+  ns = benchNs([&]() {
+    ring.push(source, 100);
+    ring.push(source, BLOCK - 100);  // 跨過結尾
+    benchKeep(ring.pop(dest, 37) + ring.pop(dest, BLOCK - 37));
+  }, 5000000);
+  benchRow("push + pop（分段）", ns, ns / BLOCK, "樣本");
+
+  printf("\n");
+  bool ok = checkOrdering();
+  ok = checkDiscard() && ok;
+  return ok ? 0 : 1;
+}
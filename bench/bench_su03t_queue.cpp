@@ -0,0 +1,136 @@
+// SU-03T 指令佇列：用假的 UART（小傳送緩衝區、每毫秒送出 1 byte，約 9600 bps）檢查
+// 排入與 service() 都不會等待、送出的 bytes 正確、播報中不送下一筆、回報解析與逾時
+// 另外量測 service() 的成本（原本 speakText() 每次卡住 loop() 100ms 以上）
+
+#include <deque>
+#include <vector>
+#include "su03t_queue.h"
+#include "bench_util.h"
+
+#define TX_FIFO 4  // 故意比一筆指令小，指令要分好幾次送
+
+class FakeUart {
+ public:
+  int availableForWrite() { return TX_FIFO - (int)fifo.size(); }
+
+  size_t write(const uint8_t *buf, size_t len) {
+    if ((int)len > availableForWrite()) overflows++;  // 驅動不應該超過可寫入的量
+    for (size_t i = 0; i < len && (int)fifo.size() < TX_FIFO; i++) fifo.push_back(buf[i]);
+    return len;
+  }
+
+  int available() { return (int)rx.size(); }
+
+  int read() {
+    if (rx.empty()) return -1;
+    int c = rx.front();
+    rx.pop_front();
+    return c;
+  }
+
+  // UART 中斷：經過 ms 毫秒送出的 bytes
+  void tick(int ms) {
+    for (int i = 0; i < ms && !fifo.empty(); i++) {
+      wire.push_back(fifo.front());
+      fifo.pop_front();
+    }
+  }
+
+  void reply(uint8_t code) {
+    const uint8_t frame[SU03T_FRAME_LEN] = {SU03T_HEAD0, SU03T_HEAD1, code, SU03T_TAIL0, SU03T_TAIL1};
+    rx.insert(rx.end(), frame, frame + SU03T_FRAME_LEN);
+  }
+
+  std::deque<uint8_t> fifo;
+  std::deque<uint8_t> rx;
+  std::vector<uint8_t> wire;
+  int overflows = 0;
+};
+
+typedef Su03tQueue<FakeUart, 4> Queue;
+
+// 跑 ms 毫秒的 loop()（每 10ms 一次 service()）
+static void run(Queue &queue, FakeUart &uart, uint32_t &now, uint32_t ms) {
+  for (uint32_t end = now + ms; now < end; now += 10) {
+    queue.service(now);
+    uart.tick(10);
+  }
+}
+
+static bool wireIs(const FakeUart &uart, std::initializer_list<uint8_t> prompts) {
+  std::vector<uint8_t> expected;
+  for (uint8_t prompt : prompts) {
+    const uint8_t frame[SU03T_FRAME_LEN] = {SU03T_HEAD0, SU03T_HEAD1, prompt, SU03T_TAIL0, SU03T_TAIL1};
+    expected.insert(expected.end(), frame, frame + SU03T_FRAME_LEN);
+  }
+  return uart.wire == expected;
+}
+
+static bool checkQueue() {
+  bool ok = true;
+  FakeUart uart;
+  Queue queue(uart);
+  uint32_t now = 1000;
+
+  // 連續排入三筆：第一筆分段送出，之後等模組回報播報結束
+  ok &= queue.say(1, now) && queue.say(2, now) && queue.say(3, now);
+  run(queue, uart, now, 50);
+  ok &= benchCheck(wireIs(uart, {1}) && queue.busy(), "第一筆分段送出，播報中不送下一筆");
+
+  uart.reply(SU03T_EVENT_DONE);
+  queue.service(now);
+  uart.tick(10);
+  ok &= benchCheck(wireIs(uart, {1}), "回報結束後仍等到間隔（SU03T_GAP_MS）才送下一筆");
+  run(queue, uart, now, SU03T_GAP_MS + 50);
+  ok &= benchCheck(wireIs(uart, {1, 2}), "間隔到了送出第二筆");
+
+  // 沒有回報：逾時後送出第三筆
+  run(queue, uart, now, SU03T_BUSY_TIMEOUT_MS + 50);
+  ok &= benchCheck(wireIs(uart, {1, 2, 3}) && queue.stats().timeouts == 1, "沒有回報時逾時繼續");
+
+  // 佇列滿了丟掉
+  for (int i = 0; i < 6; i++) queue.say(10 + i, now);
+  ok &= benchCheck(queue.pending() == 4 && queue.stats().dropped == 2, "佇列滿了丟掉新的指令");
+  queue.clear();
+
+  // 回報夾雜雜訊與壞掉的封包
+  const uint8_t noise[] = {0x00, 0xAA, 0x55, 0x07, 0x12, 0xAA, 0xAA, 0x55, 0x09, 0x55, 0xAA, SU03T_HEAD0,
+                           SU03T_HEAD1, SU03T_EVENT_WAKE, SU03T_TAIL0, SU03T_TAIL1};
+  uart.rx.insert(uart.rx.end(), noise, noise + sizeof(noise));
+  run(queue, uart, now, 20);
+  ok &= benchCheck(queue.takeCommand() == 9 && queue.takeCommand() == 0 && queue.stats().badFrames == 1,
+                   "從雜訊中解析出語音指令，壞掉的封包只計數");
+
+  ok &= benchCheck(uart.overflows == 0, "寫入量從不超過 availableForWrite()");
+  return ok;
+}
+
+int main() {
+  printf("【SU-03T 指令佇列】\n");
+
+  FakeUart uart;
+  Queue queue(uart);
+  uint32_t now = 0;
+  double ns = benchNs([&]() {
+    queue.service(now++);
+    benchKeep(queue.pending());
+  }, 10000000);
+  benchRow("service()（沒有指令）", ns, ns, "次");
+
+  ns = benchNs([&]() {
+    queue.say(1, now);
+    for (int i = 0; i < 3; i++) {
+      queue.service(now);
+      uart.tick(2);
+    }
+    uart.reply(SU03T_EVENT_DONE);
+    queue.service(now);
+    now += SU03T_GAP_MS;
+    benchKeep(uart.wire.size());
+    uart.wire.clear();
+  }, 1000000);
+  benchRow("say() + 送出 + 回報結束", ns, ns / 4, "次 service()");
+
+  printf("\n");
+  return checkQueue() ? 0 : 1;
+}
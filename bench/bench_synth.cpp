@@ -0,0 +1,100 @@
+// 合成器成本：每個輸出 frame（44.1kHz）需要多少時間與 CPU 週期
+// 以目前韌體使用的旋律與各音色量測，並與 ESP32 的每 frame 預算比較
+
+#include "synth.h"
+#include "bench_util.h"
+
+#define BLOCK_SAMPLES 256
+#define OUTPUT_RATE 44100
+#define ESP32_MHZ 240
+
+static int16_t block[BLOCK_SAMPLES];
+
+// 與 src/main.cpp 相同的旋律
+static const char *FANFARE_MELODY = "T150 @2 V13 O5 L16 C E G >C8 R16 <G16 >C4.";
+static const char *CHIME_ON_MELODY = "T240 @1 V10 O6 L32 C G";
+
+// 每個音色持續演奏同一個長音（不含休止符，量測最壞情況）
+static const char *VOICE_MELODIES[] = {
+  "@0 T30 O5 A1",
+  "@1 T30 O5 A1",
+  "@2 T30 O5 A1",
+};
+
+static void benchMelody(const char *label, const char *melody) {
+  SynthSource synth;
+  synth.begin(melody, OUTPUT_RATE);
+
+  const long iterations = 20000;
+  uint64_t cyclesStart = benchCycles();
+  double ns = benchNs([&]() {
+    if (synth.pull(block, BLOCK_SAMPLES) < BLOCK_SAMPLES) synth.begin(melody, OUTPUT_RATE);
+    benchKeep(block[BLOCK_SAMPLES / 2]);
+  }, iterations);
+  uint64_t cycles = benchCycles() - cyclesStart;
+
+  // benchNs 另外跑了 10% 暖身
+  double cyclesPerFrame = (double)cycles / ((iterations + iterations / 10 + 1) * BLOCK_SAMPLES);
+  benchRow(label, ns, ns / BLOCK_SAMPLES, "frame");
+  if (cycles > 0) {
+    printf("  %-28s %10.1f cycles/frame\n", "", cyclesPerFrame);
+  }
+}
+
+// 整段旋律的 frame 數與內容的簡單總和
+static size_t renderMelody(const char *melody, int64_t &sum) {
+  SynthSource synth;
+  synth.begin(melody, OUTPUT_RATE);
+  size_t total = 0;
+  size_t n;
+  sum = 0;
+  while ((n = synth.pull(block, BLOCK_SAMPLES)) > 0) {
+    for (size_t i = 0; i < n; i++) sum += block[i] * (int64_t)(total + i + 1);
+    total += n;
+  }
+  return total;
+}
+
+// 超出範圍的長度與八度：限制在 1-64 與 0-8，不會除以 0 或位移超過 64 位元
+static void checkOutOfRange() {
+  int64_t sumA, sumB;
+  size_t zeroLength = renderMelody("L0 C", sumA);
+  size_t wholeNote = renderMelody("L1 C", sumB);
+  benchCheck(zeroLength == wholeNote && sumA == sumB, "L0 當作 L1（全音符）");
+
+  size_t tiny = renderMelody("C0 C99", sumA);
+  size_t expected = renderMelody("C1 C64", sumB);
+  benchCheck(tiny == expected && sumA == sumB, "音符長度 0 當作 1、超過 64 當作 64");
+
+  renderMelody("O99 A", sumA);
+  renderMelody("O8 A", sumB);
+  benchCheck(sumA == sumB, "O99 當作 O8");
+
+  renderMelody("O0 <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< A", sumA);
+  renderMelody("O0 A", sumB);
+  benchCheck(sumA == sumB, "< 不會低於 O0");
+
+  renderMelody("O8 >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> A", sumA);
+  renderMelody("O8 A", sumB);
+  benchCheck(sumA == sumB, "> 不會高於 O8");
+}
+
+int main() {
+  printf("【合成器】每區塊 %d frame，%d Hz\n", BLOCK_SAMPLES, OUTPUT_RATE);
+  printf("  ESP32 %d MHz 的預算：%d cycles/frame（全部 CPU 時間）\n",
+         ESP32_MHZ, ESP32_MHZ * 1000000 / OUTPUT_RATE);
+
+  benchMelody("@0 正弦（長音）", VOICE_MELODIES[0]);
+  benchMelody("@1 鐘聲 FM（長音）", VOICE_MELODIES[1]);
+  benchMelody("@2 銅管 FM（長音）", VOICE_MELODIES[2]);
+  benchMelody("慶祝音效", FANFARE_MELODY);
+  benchMelody("按鈕提示音", CHIME_ON_MELODY);
+
+  // 旋律總長度（確認解析結果）
+  int64_t sum;
+  size_t total = renderMelody(FANFARE_MELODY, sum);
+  printf("  慶祝音效長度：%zu frame（%.0f ms）\n", total, total * 1000.0 / OUTPUT_RATE);
+
+  checkOutOfRange();
+  return 0;
+}
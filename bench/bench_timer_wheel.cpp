@@ -0,0 +1,153 @@
+// 計時輪成本：每次 loop() 呼叫 advance() 的耗時，與逐一比較 millis() 期限的輪詢做法比較
+// 另外確認計時器只觸發一次、不會提早
+
+#include <stdlib.h>
+#include <vector>
+#include "timer_wheel.h"
+#include "bench_util.h"
+
+typedef TimerWheel<64, 10> Wheel;
+
+struct Probe {
+  WheelTimer timer;
+  uint32_t deadline;
+  uint32_t firedAt;
+  int fireCount;
+};
+
+static uint32_t clockMs = 0;
+
+static void onProbe(void *arg) {
+  Probe *p = (Probe *)arg;
+  p->fireCount++;
+  p->firedAt = clockMs;
+}
+
+static void onRearm(void *arg) {
+  benchKeep(1);
+}
+
+// 隨機期限與不規則的 loop() 間隔，檢查每個計時器剛好觸發一次、不早於期限、最多晚一格
+static bool checkFiring() {
+  static Wheel wheel;
+  std::vector<Probe> probes(500);
+  clockMs = 0xFFFF0000u;  // 途中經過 millis() 溢位
+  wheel.begin(clockMs);
+  srand(7);
+
+  for (size_t i = 0; i < probes.size(); i++) {
+    uint32_t delay = rand() % 120000;
+    wheelTimerInit(probes[i].timer, onProbe, &probes[i]);
+    probes[i].deadline = clockMs + delay;
+    probes[i].fireCount = 0;
+    wheel.start(probes[i].timer, delay, clockMs);
+    clockMs += rand() % 7;
+    wheel.advance(clockMs);
+  }
+
+  for (int pass = 0; pass < 200000 && !wheel.idle(); pass++) {
+    clockMs += 1 + rand() % 25;
+    wheel.advance(clockMs);
+  }
+
+  for (size_t i = 0; i < probes.size(); i++) {
+    const Probe &p = probes[i];
+    int32_t late = (int32_t)(p.firedAt - p.deadline);
+    if (p.fireCount != 1 || late < 0 || late > 10 + 25) {
+      printf("  ❌ 計時器 %zu：觸發 %d 次，晚 %d ms\n", i, p.fireCount, (int)late);
+      return false;
+    }
+  }
+  printf("  ✅ %zu 個計時器各觸發一次，沒有提早\n", probes.size());
+  return true;
+}
+
+// 每 10 秒重新計時一次的計時器（與 onLotteryCountdown() 相同，用目前的 millis() 重新 start）
+static TimerWheel<64, 10> rearmWheel;
+static WheelTimer rearmTimer;
+static int rearmCount = 0;
+
+static void onCountdown(void *arg) {
+  rearmCount++;
+  rearmWheel.start(rearmTimer, 10000, clockMs);
+}
+
+// loop() 卡住 35 秒（例如抽籤後等待播放）：補跑時重新計時的計時器只觸發一次，從現在起再等 10 秒
+static bool checkRearmCatchUp() {
+  clockMs = 0;
+  rearmCount = 0;
+  rearmWheel.begin(clockMs);
+  wheelTimerInit(rearmTimer, onCountdown);
+  rearmWheel.start(rearmTimer, 10000, clockMs);
+
+  clockMs = 35000;
+  rearmWheel.advance(clockMs);
+  bool once = rearmCount == 1;
+
+  clockMs = 44990;
+  rearmWheel.advance(clockMs);
+  bool notEarly = rearmCount == 1;
+
+  clockMs = 45010;
+  rearmWheel.advance(clockMs);
+  return benchCheck(once && notEarly && rearmCount == 2,
+                    "loop() 卡住 35 秒後，補跑中重新計時的計時器只觸發一次，10 秒後再觸發");
+}
+
+static void benchPass(size_t armed) {
+  static Wheel wheel;
+  std::vector<WheelTimer> timers(armed);
+  std::vector<uint32_t> deadlines(armed);
+  uint32_t now = 0;
+  wheel.begin(now);
+  for (size_t i = 0; i < armed; i++) {
+    wheelTimerInit(timers[i], onRearm);
+    wheel.start(timers[i], 3600000, now);  // 一小時後，測試期間不會觸發
+    deadlines[i] = now + 3600000;
+  }
+
+  char label[48];
+  double ns;
+
+  snprintf(label, sizeof(label), "輪詢 %zu 個期限", armed);
+  ns = benchNs([&]() {
+    now += 10;
+    uint32_t due = 0;
+    for (size_t i = 0; i < armed; i++) {
+      if ((int32_t)(now - deadlines[i]) >= 0) due++;
+    }
+    benchKeep(due);
+  }, 2000000);
+  benchRow(label, ns, ns, "pass");
+
+  snprintf(label, sizeof(label), "計時輪 %zu 個計時器", armed);
+  ns = benchNs([&]() {
+    now += 10;
+    benchKeep(wheel.advance(now));
+  }, 2000000);
+  benchRow(label, ns, ns, "pass");
+}
+
+int main() {
+  printf("【計時輪】每次 loop() 經過 10ms（一格）\n");
+  benchPass(0);
+  benchPass(2);
+  benchPass(16);
+  benchPass(128);
+
+  printf("\n  --- start + cancel ---\n");
+  static Wheel wheel;
+  WheelTimer timer;
+  wheel.begin(0);
+  wheelTimerInit(timer, onRearm);
+  double ns = benchNs([&]() {
+    wheel.start(timer, 60000, 0);
+    wheel.cancel(timer);
+  }, 5000000);
+  benchRow("start + cancel", ns, ns, "op");
+
+  printf("\n");
+  bool ok = checkFiring();
+  ok &= checkRearmCatchUp();
+  return ok ? 0 : 1;
+}
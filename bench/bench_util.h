@@ -0,0 +1,48 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+// 電腦端效能測試的共用工具（計時、防止編譯器把結果最佳化掉）
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// 重複執行 fn，回傳每次的平均耗時（奈秒）
+template <typename Fn>
+double benchNs(Fn fn, long iterations) {
+  // 先暖身，讓快取與分支預測穩定
+  for (long i = 0; i < iterations / 10 + 1; i++) fn();
+
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+// 讓編譯器以為結果會被使用
+static volatile uint32_t benchSink;
+inline void benchKeep(uint32_t value) { benchSink = benchSink + value; }
+
+// CPU 週期計數器（x86 以外的平台回傳 0，表示不支援）
+inline uint64_t benchCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+inline void benchRow(const char *name, double ns, double perUnit, const char *unit) {
+  printf("  %-28s %10.1f ns  %8.2f ns/%s\n", name, ns, perUnit, unit);
+}
+
+// 正確性檢查：印出 ✅ / ❌ 與說明，回傳 ok（make run 時數一下 ❌ 就知道有沒有失敗）
+inline bool benchCheck(bool ok, const char *message) {
+  printf("  %s %s\n", ok ? "✅" : "❌", message);
+  return ok;
+}
+
+#endif
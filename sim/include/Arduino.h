@@ -0,0 +1,176 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+// 模擬器用的 Arduino API（只實作韌體有用到的部分，實作在 sim_platform.cpp）
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+using std::max;
+using std::min;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+
+#define DEC 10
+#define HEX 16
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+class String {
+ public:
+  String() {}
+  String(const char *c) : s(c ? c : "") {}
+  String(const std::string &x) : s(x) {}
+  String(char c) : s(1, c) {}
+  String(int v) : s(std::to_string(v)) {}
+  String(unsigned v) : s(std::to_string(v)) {}
+  String(long v) : s(std::to_string(v)) {}
+  String(unsigned long v) : s(std::to_string(v)) {}
+
+  const char *c_str() const { return s.c_str(); }
+  unsigned length() const { return s.size(); }
+  bool startsWith(const String &p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+  bool endsWith(const String &p) const {
+    return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0;
+  }
+  int indexOf(char c) const {
+    size_t p = s.find(c);
+    return p == std::string::npos ? -1 : (int)p;
+  }
+  String substring(unsigned from) const { return s.substr(from); }
+  String substring(unsigned from, unsigned to) const { return s.substr(from, to - from); }
+  char operator[](unsigned i) const { return s[i]; }
+
+  bool operator==(const String &o) const { return s == o.s; }
+  bool operator!=(const String &o) const { return s != o.s; }
+  bool operator==(const char *o) const { return s == o; }
+  bool operator!=(const char *o) const { return s != o; }
+  String &operator+=(const String &o) {
+    s += o.s;
+    return *this;
+  }
+
+  std::string s;
+};
+
+inline String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+inline String operator+(const char *a, const String &b) { return String(std::string(a) + b.s); }
+inline String operator+(const String &a, const char *b) { return String(a.s + b); }
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t n) {
+    for (size_t i = 0; i < n; i++) write(buf[i]);
+    return n;
+  }
+  size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+
+  size_t print(const char *str) { return write(str); }
+  size_t print(const String &str) { return write(str.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(long v, int base = DEC) { return printNumber(base == HEX ? "%lX" : "%ld", v); }
+  size_t print(unsigned long v, int base = DEC) { return printNumber(base == HEX ? "%lX" : "%lu", v); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long long v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned long long v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(double v, int digits = 2) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", digits, v);
+    return write(buf);
+  }
+
+  template <typename T>
+  size_t println(T v) { return print(v) + write("\n"); }
+  template <typename T>
+  size_t println(T v, int base) { return print(v, base) + write("\n"); }
+  size_t println() { return write("\n"); }
+
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+  virtual void flush() {}
+
+ private:
+  template <typename T>
+  size_t printNumber(const char *format, T v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), format, v);
+    return write(buf);
+  }
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() { return -1; }
+  void setTimeout(unsigned long) {}
+};
+
+// 序列埠：輸出寫進 serial.log，輸入來自腳本的 serial 指令
+class HardwareSerial : public Stream {
+ public:
+  explicit HardwareSerial(int port) : port(port) {}
+  void begin(unsigned long baud, uint32_t config = 0, int rxPin = -1, int txPin = -1) {}
+  void end() {}
+  void updateBaudRate(unsigned long baud) {}
+  size_t write(uint8_t c) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  int availableForWrite() { return 128; }
+  size_t setRxBufferSize(size_t n) { return n; }
+  size_t setTxBufferSize(size_t n) { return n; }
+  operator bool() const { return true; }
+
+ private:
+  int port;
+};
+
+#define SERIAL_8N1 0x800001c
+
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+int analogRead(uint8_t pin);
+
+long random(long high);
+long random(long low, long high);
+void randomSeed(unsigned long seed);
+
+double ledcSetup(uint8_t channel, double freq, uint8_t bits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcDetachPin(uint8_t pin);
+void ledcWrite(uint8_t channel, uint32_t duty);
+
+bool setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getCpuFrequencyMhz();
+
+#endif
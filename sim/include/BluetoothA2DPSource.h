@@ -0,0 +1,43 @@
+#ifndef SIM_BLUETOOTH_A2DP_SOURCE_H
+#define SIM_BLUETOOTH_A2DP_SOURCE_H
+
+// 模擬的 A2DP source：喇叭開著時搜尋到後（ssid 回調接受）連線，或用位址直接連線，
+// 連線後由虛擬時鐘定期呼叫資料回調
+
+#include <vector>
+#include "Arduino.h"
+
+typedef uint8_t esp_bd_addr_t[6];
+
+typedef enum {
+  ESP_A2D_CONNECTION_STATE_DISCONNECTED = 0,
+  ESP_A2D_CONNECTION_STATE_CONNECTING,
+  ESP_A2D_CONNECTION_STATE_CONNECTED,
+  ESP_A2D_CONNECTION_STATE_DISCONNECTING
+} esp_a2d_connection_state_t;
+
+struct Frame {
+  int16_t channel1;
+  int16_t channel2;
+  Frame(int v = 0) : channel1(v), channel2(v) {}
+};
+
+typedef int32_t (*music_data_frames_cb_t)(Frame *data, int32_t len);
+
+class BluetoothA2DPSource {
+ public:
+  void start(const char *name, music_data_frames_cb_t callback);
+  void start(std::vector<const char *> names, music_data_frames_cb_t callback);
+  void set_ssid_callback(bool (*callback)(const char *ssid, esp_bd_addr_t address, int rssi));
+  void set_on_connection_state_changed(void (*callback)(esp_a2d_connection_state_t, void *), void *obj = NULL);
+  void set_auto_reconnect(bool active, int count = 2) {}
+  bool connect_to(esp_bd_addr_t peer);
+  void disconnect();
+  bool is_connected();
+  esp_bd_addr_t *get_current_peer_address();
+  void set_volume(uint8_t volume) {}
+  void set_task_core(int core) {}
+  void set_task_priority(unsigned int priority) {}
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef SIM_FS_H
+#define SIM_FS_H
+
+// 模擬的檔案系統：對應到電腦上的一個資料夾（--clips）
+
+#include "Arduino.h"
+#include <memory>
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct FileImpl;
+
+class File : public Stream {
+ public:
+  File() {}
+  explicit File(std::shared_ptr<FileImpl> impl) : impl(impl) {}
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t n) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  size_t read(uint8_t *buf, size_t n);
+  bool seek(uint32_t pos, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  void close();
+  operator bool() const;
+  const char *name() const;
+  bool isDirectory() const;
+  File openNextFile(const char *mode = "r");
+
+ private:
+  std::shared_ptr<FileImpl> impl;
+};
+
+class FS {
+ public:
+  File open(const char *path, const char *mode = "r", bool create = false);
+  File open(const String &path, const char *mode = "r", bool create = false) {
+    return open(path.c_str(), mode, create);
+  }
+  bool exists(const char *path);
+  bool remove(const char *path);
+  bool rename(const char *from, const char *to);
+
+ protected:
+  bool mounted = false;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
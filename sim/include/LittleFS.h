@@ -0,0 +1,19 @@
+#ifndef SIM_LITTLEFS_H
+#define SIM_LITTLEFS_H
+
+#include "FS.h"
+
+class LittleFSFS : public fs::FS {
+ public:
+  bool begin(bool formatOnFail = false, const char *basePath = "/littlefs", uint8_t maxOpen = 10,
+             const char *label = "spiffs") {
+    mounted = true;
+    return true;
+  }
+  void end() { mounted = false; }
+  bool format() { return true; }
+};
+
+extern LittleFSFS LittleFS;
+
+#endif
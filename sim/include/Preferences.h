@@ -0,0 +1,35 @@
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+// 模擬的 NVS：存在記憶體中，單次模擬期間有效（--nvs 可以存到檔案，下一次模擬接著用）
+
+#include "Arduino.h"
+
+class Preferences {
+ public:
+  bool begin(const char *name, bool readOnly = false);
+  void end() {}
+  bool clear();
+  bool remove(const char *key);
+  bool isKey(const char *key);
+  size_t putBytes(const char *key, const void *value, size_t len);
+  size_t getBytes(const char *key, void *buf, size_t maxLen);
+  size_t getBytesLength(const char *key);
+  size_t putUShort(const char *key, uint16_t value) { return putBytes(key, &value, sizeof(value)); }
+  uint16_t getUShort(const char *key, uint16_t defaultValue = 0) { return getValue(key, defaultValue); }
+  size_t putUInt(const char *key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+  uint32_t getUInt(const char *key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  size_t putUChar(const char *key, uint8_t value) { return putBytes(key, &value, sizeof(value)); }
+  uint8_t getUChar(const char *key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+
+ private:
+  template <typename T>
+  T getValue(const char *key, T defaultValue) {
+    T value;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+  }
+
+  std::string space;
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef SIM_SPIFFS_H
+#define SIM_SPIFFS_H
+
+#include "FS.h"
+
+class SPIFFSFS : public fs::FS {
+ public:
+  bool begin(bool formatOnFail = false, const char *basePath = "/spiffs", uint8_t maxOpen = 10,
+             const char *label = NULL) {
+    mounted = true;
+    return true;
+  }
+  void end() { mounted = false; }
+  bool format() { return true; }
+};
+
+extern SPIFFSFS SPIFFS;
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef SIM_DRIVER_RMT_H
+#define SIM_DRIVER_RMT_H
+
+// 模擬器不模擬 RMT 波形：傳送立即完成，送出的資料交給模擬器記錄燈光（見 sim_core.cpp）
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+typedef enum { RMT_CHANNEL_0, RMT_CHANNEL_1 } rmt_channel_t;
+
+typedef struct {
+  union {
+    struct {
+      uint32_t duration0 : 15;
+      uint32_t level0 : 1;
+      uint32_t duration1 : 15;
+      uint32_t level1 : 1;
+    };
+    uint32_t val;
+  };
+} rmt_item32_t;
+
+typedef struct {
+  int rmt_mode;
+  rmt_channel_t channel;
+  gpio_num_t gpio_num;
+  uint8_t clk_div;
+  uint8_t mem_block_num;
+} rmt_config_t;
+
+#define RMT_DEFAULT_CONFIG_TX(gpio, ch) {0, ch, gpio, 80, 1}
+
+typedef void (*sample_to_rmt_t)(const void *src, rmt_item32_t *dest, size_t srcSize, size_t wantedNum,
+                                size_t *translatedSize, size_t *itemNum);
+
+inline esp_err_t rmt_config(const rmt_config_t *config) { return ESP_OK; }
+inline esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rxBufSize, int flags) { return ESP_OK; }
+inline esp_err_t rmt_translator_init(rmt_channel_t channel, sample_to_rmt_t translator) { return ESP_OK; }
+void simRmtWrite(const uint8_t *src, size_t size);
+
+inline esp_err_t rmt_write_sample(rmt_channel_t channel, const uint8_t *src, size_t size, bool wait) {
+  simRmtWrite(src, size);
+  return ESP_OK;
+}
+inline esp_err_t rmt_wait_tx_done(rmt_channel_t channel, uint32_t waitTicks) { return ESP_OK; }
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef SIM_ESP_PM_H
+#define SIM_ESP_PM_H
+
+// 模擬器不啟用 CONFIG_PM_ENABLE，cpu_scaling 會走 setCpuFrequencyMhz() 路徑
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef enum { ESP_PM_CPU_FREQ_MAX, ESP_PM_APB_FREQ_MAX, ESP_PM_NO_LIGHT_SLEEP } esp_pm_lock_type_t;
+typedef struct esp_pm_lock *esp_pm_lock_handle_t;
+
+#endif
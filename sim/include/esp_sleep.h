@@ -0,0 +1,22 @@
+#ifndef SIM_ESP_SLEEP_H
+#define SIM_ESP_SLEEP_H
+
+// 模擬的 light sleep：虛擬時鐘直接跳到下一次按鈕、序列埠輸入或計時器喚醒
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED,
+  ESP_SLEEP_WAKEUP_TIMER = 4,
+  ESP_SLEEP_WAKEUP_GPIO = 7,
+  ESP_SLEEP_WAKEUP_UART = 8
+} esp_sleep_wakeup_cause_t;
+
+esp_err_t esp_sleep_enable_gpio_wakeup(void);
+esp_err_t esp_sleep_enable_uart_wakeup(int uartNum);
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs);
+esp_err_t esp_light_sleep_start(void);
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void);
+
+#endif
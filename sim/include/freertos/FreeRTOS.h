@@ -0,0 +1,17 @@
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+// 模擬器是單執行緒，FreeRTOS 物件都是空殼
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdMS_TO_TICKS(ms) (ms)
+#define portMAX_DELAY 0xffffffff
+
+#endif
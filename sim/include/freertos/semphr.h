@@ -0,0 +1,12 @@
+#ifndef SIM_FREERTOS_SEMPHR_H
+#define SIM_FREERTOS_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+typedef void *SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return (SemaphoreHandle_t)1; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex) { return pdTRUE; }
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef SIM_H
+#define SIM_H
+
+// ========== 電腦端模擬器（內部介面）==========
+// 韌體的 setup()/loop() 原封不動在電腦上執行，時間由虛擬時鐘提供：
+//   delay() / light sleep 直接把時鐘往前推，推進途中依時間處理腳本事件、
+//   esp_timer 週期回調與 A2DP 拉取音訊，所以幾小時的模擬只需要幾秒。
+// sim_platform.cpp 實作假的 Arduino / ESP-IDF API，透過這裡的函式存取模擬狀態。
+
+#include <stdint.h>
+#include <string>
+#include <BluetoothA2DPSource.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+
+// 韌體腳位（與 main.cpp 相同）
+#define SIM_PIN_YELLOW 13
+#define SIM_PIN_BLACK 14
+#define SIM_PIN_RED 12
+#define SIM_PIN_GREEN 33
+#define SIM_PIN_BLUE 32
+#define SIM_PIN_LED_R 16
+#define SIM_PIN_LED_G 17
+#define SIM_PIN_LED_B 5
+
+#define SIM_AUDIO_RATE 44100
+#define SIM_AUDIO_BLOCK 512        // A2DP 每次拉取的 frame 數（約 11.6ms）
+#define SIM_LOOP_COST_US 200       // 每次 loop() 本身耗費的時間
+#define SIM_PRESS_MS 150           // 按鈕按住多久
+#define SIM_BT_SEARCH_MS 1500      // start() 後搜尋到喇叭所需時間（ssid 回調拒絕時再搜尋一次）
+#define SIM_BT_CONNECT_MS 800      // connect_to() 連線所需時間
+#define SIM_AUDIO_GAP_MS 500       // 靜音超過這個時間就結束目前的 WAV 片段
+
+// 假的喇叭（只有這個位址能用 connect_to() 連上）
+#define SIM_SPEAKER_NAME "Bose Mini II SoundLink"
+static const esp_bd_addr_t SIM_SPEAKER_ADDRESS = {0x04, 0x52, 0xC7, 0x5A, 0x1B, 0x3E};
+
+// 模擬結束（時間到或腳本 end）
+struct SimFinished {};
+
+struct SimOptions {
+  std::string script;
+  std::string outDir = "sim_out";
+  std::string clipDir;        // 空字串 = 產生合成音檔
+  uint32_t seed = 1;
+  uint64_t untilUs = 0;       // 0 = 腳本最後一個事件後 5 秒
+  bool verbose = false;       // 序列埠輸出同時印到終端機
+  bool pty = false;           // 序列埠接到虛擬終端機（電腦端程式，例如 tools/upload_clips.py）
+  std::string nvsFile;        // NVS 內容從這個檔案讀入、結束時寫回（模擬重新開機）
+};
+
+bool simParseTime(const std::string &token, uint64_t &us);
+bool simLoadScript(const SimOptions &options);
+void simBegin();
+int simFinish(double wallSeconds);  // 寫出檔案、印出摘要，回傳 exit code
+
+// 虛擬時鐘
+uint64_t simNowUs();
+void simAdvance(uint64_t us);
+void simLoopDone();
+void simLightSleep(uint64_t maxUs);
+esp_sleep_wakeup_cause_t simWakeCause();
+
+// 腳位與燈光
+int simPinLevel(int pin);
+void simPinWrite(int pin, int level);
+void simLedcSetup(int channel, int bits);
+void simLedcAttach(int pin, int channel);
+void simLedcDetach(int pin);
+void simLedcWrite(int channel, uint32_t duty);
+
+// 序列埠
+void simSerialWrite(uint8_t c);
+int simSerialAvailable();
+int simSerialRead(bool consume);
+
+// 藍牙
+void simA2dpStart(music_data_frames_cb_t callback);
+void simA2dpStateCallback(void (*callback)(esp_a2d_connection_state_t, void *), void *obj);
+void simA2dpSsidCallback(bool (*callback)(const char *, esp_bd_addr_t, int));
+bool simA2dpConnectTo(const esp_bd_addr_t peer);
+void simA2dpDisconnect();
+bool simA2dpConnected();
+
+// esp_timer
+esp_timer_handle_t simTimerCreate(const esp_timer_create_args_t *args);
+void simTimerStart(esp_timer_handle_t timer, uint64_t periodUs);
+void simTimerStop(esp_timer_handle_t timer);
+
+// NVS（sim_platform.cpp）
+bool simNvsLoad(const std::string &path);
+bool simNvsSave(const std::string &path);
+
+// 其他
+const std::string &simClipDir();
+uint32_t simSeed();
+
+#endif
@@ -0,0 +1,854 @@
+#include "sim.h"
+#include <Arduino.h>
+#include <driver/rmt.h>
+#include "ws2812_strip.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+// ========== 虛擬時鐘、腳本、燈光與音訊紀錄 ==========
+
+static SimOptions options;
+static uint64_t nowUs = 0;
+static uint64_t endUs = 0;
+static uint32_t loopCount = 0;
+static uint32_t sleepCount = 0;
+static esp_sleep_wakeup_cause_t wakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+// ---------- 腳本 ----------
+
+enum EventKind {
+  EV_PIN,
+  EV_SERIAL,
+  EV_SPEAKER,
+  EV_EXPECT_LED,
+  EV_EXPECT_SERIAL,
+  EV_EXPECT_AUDIO,
+  EV_END
+};
+
+struct ScriptEvent {
+  uint64_t us;
+  EventKind kind;
+  int pin;
+  int value;
+  int rgb[3];
+  std::string text;
+  int line;
+};
+
+static std::vector<ScriptEvent> events;
+static size_t nextEvent = 0;
+static int expectCount = 0;
+static std::vector<std::string> failures;
+
+// ---------- 腳位與燈光 ----------
+
+#define SIM_PINS 40
+#define SIM_LEDC_CHANNELS 16
+
+static int pinLevels[SIM_PINS];
+static bool pinOutput[SIM_PINS];
+static int pinChannel[SIM_PINS];
+static int ledcBits[SIM_LEDC_CHANNELS];
+static uint32_t ledcDuty[SIM_LEDC_CHANNELS];
+
+// WS2812 燈條：記錄第一顆 LED（整條同色時代表整條）
+static bool stripUsed = false;
+static int stripRgb[3];
+
+struct LedRow {
+  uint64_t us;
+  int rgb[3];
+};
+
+static std::vector<LedRow> ledTimeline;
+
+// ---------- 序列埠 ----------
+
+static std::string serialLine;
+static std::string serialText;        // 全部輸出（expect serial 從上次比對到的位置往後找）
+static size_t serialCheckPos = 0;
+static std::deque<uint8_t> serialInput;
+static FILE *serialLog = NULL;
+
+// --pty：序列埠接到虛擬終端機，時鐘跟著實際時間走（電腦端程式才來得及回應）
+static int ptyMaster = -1;
+static int ptySlave = -1;  // 模擬器自己也開著，電腦端程式關閉時 master 不會出錯
+static std::chrono::steady_clock::time_point ptyStart;
+
+// ---------- 藍牙與音訊 ----------
+
+static music_data_frames_cb_t audioCallback = NULL;
+static void (*stateCallback)(esp_a2d_connection_state_t, void *) = NULL;
+static void *stateCallbackObj = NULL;
+static bool (*ssidCallback)(const char *, esp_bd_addr_t, int) = NULL;
+static bool a2dpStarted = false;
+static bool speakerOn = true;
+static bool connected = false;
+static uint64_t searchAtUs = 0;       // 0 = 沒有在搜尋
+static uint64_t connectAtUs = 0;      // 0 = 沒有待完成的連線
+static uint64_t audioStartUs = 0;
+static uint64_t audioFrames = 0;
+
+static FILE *wavFile = NULL;
+static uint32_t wavBytes = 0;
+static uint64_t lastSoundUs = 0;
+static bool soundHeard = false;
+static std::vector<std::string> wavFiles;
+
+// ---------- esp_timer ----------
+
+struct esp_timer {
+  esp_timer_cb_t callback;
+  void *arg;
+  uint64_t periodUs;
+  uint64_t nextUs;
+  bool active;
+};
+
+static std::vector<esp_timer *> timers;
+
+// ========== 腳本解析 ==========
+
+// 時間：數字加單位 ms / s / m / h，可以連寫（1h30m、2m5.5s），不寫單位為秒
+bool simParseTime(const std::string &token, uint64_t &us) {
+  const char *p = token.c_str();
+  double total = 0;
+  bool any = false;
+  while (*p != '\0') {
+    char *end = NULL;
+    double value = strtod(p, &end);
+    if (end == p || value < 0) return false;
+    p = end;
+
+    double scale = 1e6;
+    if (strncmp(p, "ms", 2) == 0) {
+      scale = 1e3;
+      p += 2;
+    } else if (*p == 's') {
+      p++;
+    } else if (*p == 'm') {
+      scale = 60e6;
+      p++;
+    } else if (*p == 'h') {
+      scale = 3600e6;
+      p++;
+    } else if (*p != '\0') {
+      return false;
+    }
+    total += value * scale;
+    any = true;
+  }
+  us = (uint64_t)(total + 0.5);
+  return any;
+}
+
+static int buttonPin(const std::string &name) {
+  if (name == "yellow") return SIM_PIN_YELLOW;
+  if (name == "black") return SIM_PIN_BLACK;
+  if (name == "red") return SIM_PIN_RED;
+  if (name == "green") return SIM_PIN_GREEN;
+  if (name == "blue") return SIM_PIN_BLUE;
+  return -1;
+}
+
+static bool scriptError(int line, const std::string &message) {
+  fprintf(stderr, "%s:%d: %s\n", options.script.c_str(), line, message.c_str());
+  return false;
+}
+
+bool simLoadScript(const SimOptions &opts) {
+  options = opts;
+  std::ifstream in(options.script.c_str());
+  if (!in) {
+    fprintf(stderr, "無法開啟腳本 %s\n", options.script.c_str());
+    return false;
+  }
+
+  std::string text;
+  int lineNo = 0;
+  bool hasEnd = false;
+  while (std::getline(in, text)) {
+    lineNo++;
+    size_t hash = text.find('#');
+    if (hash != std::string::npos) text.erase(hash);
+
+    std::istringstream line(text);
+    std::string timeToken, command;
+    if (!(line >> timeToken)) continue;
+    if (!(line >> command)) return scriptError(lineNo, "缺少指令");
+
+    ScriptEvent ev = {};
+    ev.line = lineNo;
+    if (!simParseTime(timeToken, ev.us)) return scriptError(lineNo, "時間格式錯誤：" + timeToken);
+
+    std::string arg;
+    line >> arg;
+    std::string rest;
+    std::getline(line, rest);
+    size_t start = rest.find_first_not_of(" \t");
+    size_t stop = rest.find_last_not_of(" \t\r");
+    rest = start == std::string::npos ? "" : rest.substr(start, stop - start + 1);
+
+    if (command == "press") {
+      ev.kind = EV_PIN;
+      ev.pin = buttonPin(arg);
+      if (ev.pin < 0) return scriptError(lineNo, "未知的按鈕：" + arg);
+      ev.value = HIGH;
+      events.push_back(ev);
+      ev.us += SIM_PRESS_MS * 1000ULL;
+      ev.value = LOW;
+    } else if (command == "serial") {
+      ev.kind = EV_SERIAL;
+      ev.text = rest.empty() ? arg : arg + " " + rest;
+    } else if (command == "speaker") {
+      ev.kind = EV_SPEAKER;
+      if (arg != "on" && arg != "off") return scriptError(lineNo, "speaker 只能是 on 或 off");
+      ev.value = arg == "on";
+    } else if (command == "expect" && arg == "led") {
+      ev.kind = EV_EXPECT_LED;
+      if (sscanf(rest.c_str(), "%d %d %d", &ev.rgb[0], &ev.rgb[1], &ev.rgb[2]) != 3) {
+        return scriptError(lineNo, "expect led 需要 R G B");
+      }
+    } else if (command == "expect" && arg == "serial") {
+      ev.kind = EV_EXPECT_SERIAL;
+      ev.text = rest;
+      if (rest.empty()) return scriptError(lineNo, "expect serial 需要比對的文字");
+    } else if (command == "expect" && arg == "audio") {
+      ev.kind = EV_EXPECT_AUDIO;
+      if (rest != "on" && rest != "off") return scriptError(lineNo, "expect audio 只能是 on 或 off");
+      ev.value = rest == "on";
+    } else if (command == "end") {
+      ev.kind = EV_END;
+      hasEnd = true;
+    } else {
+      return scriptError(lineNo, "未知的指令：" + command);
+    }
+    events.push_back(ev);
+  }
+
+  std::stable_sort(events.begin(), events.end(),
+                   [](const ScriptEvent &a, const ScriptEvent &b) { return a.us < b.us; });
+
+  if (options.untilUs > 0) {
+    endUs = options.untilUs;
+  } else if (hasEnd) {
+    endUs = UINT64_MAX;
+  } else {
+    endUs = (events.empty() ? 0 : events.back().us) + 5000000ULL;
+  }
+  return true;
+}
+
+// ========== 檔案 ==========
+
+static std::string outPath(const std::string &name) {
+  return options.outDir + "/" + name;
+}
+
+static void writeWavHeader(FILE *f, uint32_t rate, uint16_t channels, uint32_t dataBytes) {
+  uint16_t bits = 16;
+  uint32_t byteRate = rate * channels * bits / 8;
+  uint16_t blockAlign = channels * bits / 8;
+  uint32_t riffSize = 36 + dataBytes;
+  uint32_t fmtSize = 16;
+  uint16_t format = 1;
+
+  fseek(f, 0, SEEK_SET);
+  fwrite("RIFF", 1, 4, f);
+  fwrite(&riffSize, 4, 1, f);
+  fwrite("WAVEfmt ", 1, 8, f);
+  fwrite(&fmtSize, 4, 1, f);
+  fwrite(&format, 2, 1, f);
+  fwrite(&channels, 2, 1, f);
+  fwrite(&rate, 4, 1, f);
+  fwrite(&byteRate, 4, 1, f);
+  fwrite(&blockAlign, 2, 1, f);
+  fwrite(&bits, 2, 1, f);
+  fwrite("data", 1, 4, f);
+  fwrite(&dataBytes, 4, 1, f);
+}
+
+// 合成測試音檔：8kHz 16-bit 單聲道，1 秒正弦波
+static void writeToneClip(const std::string &path, float freq) {
+  FILE *f = fopen(path.c_str(), "wb");
+  if (f == NULL) return;
+
+  const uint32_t rate = 8000;
+  writeWavHeader(f, rate, 1, rate * 2);
+  for (uint32_t i = 0; i < rate; i++) {
+    int16_t sample = (int16_t)(8000.0f * sinf(2.0f * (float)M_PI * freq * i / rate));
+    fwrite(&sample, 2, 1, f);
+  }
+  fclose(f);
+}
+
+// 清掉上次留下的 audio_*.wav，避免和這次的輸出混在一起
+static void removeOldAudio() {
+  DIR *dir = opendir(options.outDir.c_str());
+  if (dir == NULL) return;
+  while (struct dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.compare(0, 6, "audio_") == 0 && name.size() > 4 && name.compare(name.size() - 4, 4, ".wav") == 0) {
+      remove(outPath(name).c_str());
+    }
+  }
+  closedir(dir);
+}
+
+// 建立資料夾（含上層）
+static void makeDirs(const std::string &path) {
+  for (size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1)) {
+    mkdir(path.substr(0, pos).c_str(), 0755);
+  }
+  mkdir(path.c_str(), 0755);
+}
+
+// 建立虛擬終端機並設成 raw（不回顯、不轉換換行），電腦端程式開啟印出的路徑
+static void openPty() {
+  ptyMaster = posix_openpt(O_RDWR | O_NOCTTY);
+  if (ptyMaster < 0 || grantpt(ptyMaster) != 0 || unlockpt(ptyMaster) != 0) {
+    fprintf(stderr, "無法建立虛擬終端機\n");
+    exit(2);
+  }
+  const char *path = ptsname(ptyMaster);
+  ptySlave = open(path, O_RDWR | O_NOCTTY);
+  struct termios tio;
+  if (ptySlave >= 0 && tcgetattr(ptySlave, &tio) == 0) {
+    cfmakeraw(&tio);
+    tcsetattr(ptySlave, TCSANOW, &tio);
+  }
+  fcntl(ptyMaster, F_SETFL, fcntl(ptyMaster, F_GETFL) | O_NONBLOCK);
+
+  printf("PTY %s\n", path);
+  fflush(stdout);
+  ptyStart = std::chrono::steady_clock::now();
+}
+
+void simBegin() {
+  makeDirs(options.outDir);
+  removeOldAudio();
+
+  if (options.clipDir.empty()) {
+    options.clipDir = outPath("clips");
+    mkdir(options.clipDir.c_str(), 0755);
+    writeToneClip(options.clipDir + "/Dad_sim.wav", 440.0f);
+    writeToneClip(options.clipDir + "/Mom_sim.wav", 523.25f);
+    writeToneClip(options.clipDir + "/SX_sim.wav", 659.25f);
+  }
+
+  serialLog = fopen(outPath("serial.log").c_str(), "w");
+  if (options.pty) openPty();
+  if (!options.nvsFile.empty() && simNvsLoad(options.nvsFile)) {
+    printf("NVS ← %s\n", options.nvsFile.c_str());
+  }
+
+  for (int i = 0; i < SIM_PINS; i++) {
+    pinChannel[i] = -1;
+  }
+  LedRow first = {0, {0, 0, 0}};
+  ledTimeline.push_back(first);
+}
+
+const std::string &simClipDir() {
+  return options.clipDir;
+}
+
+uint32_t simSeed() {
+  return options.seed;
+}
+
+// ========== 燈光紀錄 ==========
+
+// 共陽極：duty 越小越亮，換算回 0-255 亮度
+static int ledLevel(int pin) {
+  int channel = pinChannel[pin];
+  if (channel >= 0) {
+    uint32_t max = (1u << ledcBits[channel]) - 1;
+    uint32_t duty = std::min(ledcDuty[channel], max);
+    return (int)(((max - duty) * 255 + max / 2) / max);
+  }
+  if (pinOutput[pin]) {
+    return pinLevels[pin] == LOW ? 255 : 0;
+  }
+  return 0;
+}
+
+static void currentLeds(int rgb[3]) {
+  if (stripUsed) {
+    memcpy(rgb, stripRgb, sizeof(stripRgb));
+    return;
+  }
+  rgb[0] = ledLevel(SIM_PIN_LED_R);
+  rgb[1] = ledLevel(SIM_PIN_LED_G);
+  rgb[2] = ledLevel(SIM_PIN_LED_B);
+}
+
+// 只記錄變化；同一個時間點的多次變化（例如休眠前切換成 GPIO）只留最後結果
+static void recordLeds() {
+  LedRow row;
+  row.us = nowUs;
+  currentLeds(row.rgb);
+
+  LedRow &last = ledTimeline.back();
+  if (memcmp(last.rgb, row.rgb, sizeof(row.rgb)) == 0) return;
+
+  if (last.us == nowUs && ledTimeline.size() > 1) {
+    ledTimeline.pop_back();
+    if (memcmp(ledTimeline.back().rgb, row.rgb, sizeof(row.rgb)) == 0) return;
+  }
+  ledTimeline.push_back(row);
+}
+
+int simPinLevel(int pin) {
+  return pin >= 0 && pin < SIM_PINS ? pinLevels[pin] : LOW;
+}
+
+void simPinWrite(int pin, int level) {
+  if (pin < 0 || pin >= SIM_PINS) return;
+  pinOutput[pin] = true;
+  pinLevels[pin] = level;
+  recordLeds();
+}
+
+void simLedcSetup(int channel, int bits) {
+  if (channel >= 0 && channel < SIM_LEDC_CHANNELS) ledcBits[channel] = bits;
+}
+
+void simLedcAttach(int pin, int channel) {
+  if (pin < 0 || pin >= SIM_PINS || channel < 0 || channel >= SIM_LEDC_CHANNELS) return;
+  pinChannel[pin] = channel;
+  recordLeds();
+}
+
+void simLedcDetach(int pin) {
+  if (pin < 0 || pin >= SIM_PINS) return;
+  pinChannel[pin] = -1;
+  pinOutput[pin] = false;
+  recordLeds();
+}
+
+void simLedcWrite(int channel, uint32_t duty) {
+  if (channel < 0 || channel >= SIM_LEDC_CHANNELS) return;
+  ledcDuty[channel] = duty;
+  recordLeds();
+}
+
+// 傳送緩衝區是 GRB 順序、已乘上 WS2812_BRIGHTNESS，還原成 0-255 方便和類比燈條用同一份腳本
+void simRmtWrite(const uint8_t *src, size_t size) {
+  if (size < 3) return;
+  const int order[3] = {1, 0, 2};
+  for (int i = 0; i < 3; i++) {
+    int level = (src[order[i]] * 256 + WS2812_BRIGHTNESS / 2) / WS2812_BRIGHTNESS;
+    stripRgb[i] = std::min(level, 255);
+  }
+  stripUsed = true;
+  recordLeds();
+}
+
+// ========== 序列埠 ==========
+
+void simSerialWrite(uint8_t c) {
+  if (ptyMaster >= 0 && write(ptyMaster, &c, 1) != 1) {
+    // 電腦端沒有在讀，緩衝區滿了就丟掉（與實機相同）
+  }
+  serialText.push_back((char)c);
+  if (c != '\n') {
+    serialLine.push_back((char)c);
+    return;
+  }
+
+  if (serialLog != NULL) {
+    fprintf(serialLog, "[%10.3f] %s\n", nowUs / 1e6, serialLine.c_str());
+  }
+  if (options.verbose) {
+    printf("[%10.3f] %s\n", nowUs / 1e6, serialLine.c_str());
+  }
+  serialLine.clear();
+}
+
+// 收下電腦端從虛擬終端機送來的資料，回傳是否有新資料
+static bool pollPty() {
+  if (ptyMaster < 0) return false;
+  uint8_t buf[256];
+  bool got = false;
+  ssize_t n;
+  while ((n = read(ptyMaster, buf, sizeof(buf))) > 0) {
+    serialInput.insert(serialInput.end(), buf, buf + n);
+    got = true;
+  }
+  return got;
+}
+
+int simSerialAvailable() {
+  pollPty();
+  return (int)serialInput.size();
+}
+
+int simSerialRead(bool consume) {
+  pollPty();
+  if (serialInput.empty()) return -1;
+  int c = serialInput.front();
+  if (consume) serialInput.pop_front();
+  return c;
+}
+
+// ========== 藍牙與音訊 ==========
+
+static void setConnected(bool up) {
+  if (connected == up) return;
+  connected = up;
+  if (up) {
+    audioStartUs = nowUs;
+    audioFrames = 0;
+  }
+  if (stateCallback != NULL) {
+    stateCallback(up ? ESP_A2D_CONNECTION_STATE_CONNECTED : ESP_A2D_CONNECTION_STATE_DISCONNECTED,
+                  stateCallbackObj);
+  }
+}
+
+void simA2dpStart(music_data_frames_cb_t callback) {
+  audioCallback = callback;
+  a2dpStarted = true;
+  if (speakerOn) searchAtUs = nowUs + SIM_BT_SEARCH_MS * 1000ULL;
+}
+
+void simA2dpStateCallback(void (*callback)(esp_a2d_connection_state_t, void *), void *obj) {
+  stateCallback = callback;
+  stateCallbackObj = obj;
+}
+
+void simA2dpSsidCallback(bool (*callback)(const char *, esp_bd_addr_t, int)) {
+  ssidCallback = callback;
+}
+
+// 搜尋到喇叭：ssid 回調接受就連線，拒絕則稍後再搜尋一次（與函式庫相同）
+static void speakerFound() {
+  if (connected || connectAtUs != 0) return;
+  esp_bd_addr_t address;
+  memcpy(address, SIM_SPEAKER_ADDRESS, sizeof(address));
+  if (ssidCallback == NULL || ssidCallback(SIM_SPEAKER_NAME, address, -60)) {
+    setConnected(true);
+  } else {
+    searchAtUs = nowUs + SIM_BT_SEARCH_MS * 1000ULL;
+  }
+}
+
+bool simA2dpConnectTo(const esp_bd_addr_t peer) {
+  bool known = memcmp(peer, SIM_SPEAKER_ADDRESS, sizeof(esp_bd_addr_t)) == 0;
+  if (known && speakerOn && !connected && connectAtUs == 0) {
+    connectAtUs = nowUs + SIM_BT_CONNECT_MS * 1000ULL;
+  }
+  return true;
+}
+
+void simA2dpDisconnect() {
+  connectAtUs = 0;
+  setConnected(false);
+}
+
+bool simA2dpConnected() {
+  return connected;
+}
+
+static void closeWav() {
+  if (wavFile == NULL) return;
+  writeWavHeader(wavFile, SIM_AUDIO_RATE, 2, wavBytes);
+  fclose(wavFile);
+  wavFile = NULL;
+}
+
+// 拉一個區塊；有聲音的部分寫進 WAV，靜音超過 SIM_AUDIO_GAP_MS 就結束這個片段
+static void pullAudio() {
+  static Frame block[SIM_AUDIO_BLOCK];
+  for (int i = 0; i < SIM_AUDIO_BLOCK; i++) {
+    block[i] = Frame(0);
+  }
+  audioCallback(block, SIM_AUDIO_BLOCK);
+  audioFrames += SIM_AUDIO_BLOCK;
+
+  bool silent = true;
+  for (int i = 0; i < SIM_AUDIO_BLOCK && silent; i++) {
+    silent = block[i].channel1 == 0 && block[i].channel2 == 0;
+  }
+
+  if (!silent) {
+    lastSoundUs = nowUs;
+    soundHeard = true;
+    if (wavFile == NULL) {
+      char name[32];
+      snprintf(name, sizeof(name), "audio_%03u.wav", (unsigned)wavFiles.size() + 1);
+      wavFile = fopen(outPath(name).c_str(), "wb");
+      if (wavFile == NULL) return;
+      wavBytes = 0;
+      writeWavHeader(wavFile, SIM_AUDIO_RATE, 2, 0);
+      char note[64];
+      snprintf(note, sizeof(note), "%s（%.3f s 開始）", name, nowUs / 1e6);
+      wavFiles.push_back(note);
+    }
+  } else if (wavFile != NULL && nowUs - lastSoundUs >= SIM_AUDIO_GAP_MS * 1000ULL) {
+    closeWav();
+    return;
+  }
+
+  if (wavFile != NULL) {
+    for (int i = 0; i < SIM_AUDIO_BLOCK; i++) {
+      fwrite(&block[i].channel1, 2, 1, wavFile);
+      fwrite(&block[i].channel2, 2, 1, wavFile);
+    }
+    wavBytes += SIM_AUDIO_BLOCK * 4;
+  }
+}
+
+static uint64_t nextAudioUs() {
+  return audioStartUs + (audioFrames + SIM_AUDIO_BLOCK) * 1000000ULL / SIM_AUDIO_RATE;
+}
+
+// ========== esp_timer ==========
+
+esp_timer_handle_t simTimerCreate(const esp_timer_create_args_t *args) {
+  esp_timer *timer = new esp_timer();
+  timer->callback = args->callback;
+  timer->arg = args->arg;
+  timers.push_back(timer);
+  return timer;
+}
+
+void simTimerStart(esp_timer_handle_t timer, uint64_t periodUs) {
+  timer->periodUs = periodUs > 0 ? periodUs : 1;
+  timer->nextUs = nowUs + timer->periodUs;
+  timer->active = true;
+}
+
+void simTimerStop(esp_timer_handle_t timer) {
+  timer->active = false;
+}
+
+// ========== 腳本事件 ==========
+
+static void fail(const ScriptEvent &ev, const std::string &message) {
+  char prefix[64];
+  snprintf(prefix, sizeof(prefix), "第 %d 行（%.3f s）：", ev.line, ev.us / 1e6);
+  failures.push_back(prefix + message);
+}
+
+static void runEvent(const ScriptEvent &ev) {
+  switch (ev.kind) {
+    case EV_PIN:
+      pinLevels[ev.pin] = ev.value;
+      break;
+
+    case EV_SERIAL:
+      for (size_t i = 0; i < ev.text.size(); i++) {
+        serialInput.push_back((uint8_t)ev.text[i]);
+      }
+      break;
+
+    case EV_SPEAKER:
+      speakerOn = ev.value;
+      if (!speakerOn) {
+        simA2dpDisconnect();
+      } else if (a2dpStarted && !connected) {
+        searchAtUs = nowUs + SIM_BT_SEARCH_MS * 1000ULL;
+      }
+      break;
+
+    case EV_EXPECT_LED: {
+      expectCount++;
+      int rgb[3];
+      currentLeds(rgb);
+      for (int i = 0; i < 3; i++) {
+        if (abs(rgb[i] - ev.rgb[i]) > 2) {
+          char message[96];
+          snprintf(message, sizeof(message), "燈光應為 %d %d %d，實際為 %d %d %d",
+                   ev.rgb[0], ev.rgb[1], ev.rgb[2], rgb[0], rgb[1], rgb[2]);
+          fail(ev, message);
+          break;
+        }
+      }
+      break;
+    }
+
+    case EV_EXPECT_SERIAL: {
+      expectCount++;
+      size_t pos = serialText.find(ev.text, serialCheckPos);
+      if (pos == std::string::npos) {
+        fail(ev, "序列埠沒有出現「" + ev.text + "」");
+      } else {
+        serialCheckPos = pos + ev.text.size();
+      }
+      break;
+    }
+
+    case EV_EXPECT_AUDIO: {
+      expectCount++;
+      bool audible = soundHeard && nowUs - lastSoundUs < 50000;
+      if (audible != (ev.value != 0)) {
+        fail(ev, ev.value ? "應該正在播放聲音" : "不應該有聲音");
+      }
+      break;
+    }
+
+    case EV_END:
+      throw SimFinished();
+  }
+}
+
+// ========== 時鐘推進 ==========
+
+static uint64_t nextDueUs() {
+  uint64_t next = UINT64_MAX;
+  if (nextEvent < events.size()) next = events[nextEvent].us;
+  if (searchAtUs != 0) next = std::min(next, searchAtUs);
+  if (connectAtUs != 0) next = std::min(next, connectAtUs);
+  if (connected && audioCallback != NULL) next = std::min(next, nextAudioUs());
+  for (size_t i = 0; i < timers.size(); i++) {
+    if (timers[i]->active) next = std::min(next, timers[i]->nextUs);
+  }
+  return next;
+}
+
+// 處理所有已到期的項目（腳本事件依腳本順序）
+static void runDue() {
+  while (nextEvent < events.size() && events[nextEvent].us <= nowUs) {
+    runEvent(events[nextEvent++]);
+  }
+  if (searchAtUs != 0 && searchAtUs <= nowUs) {
+    searchAtUs = 0;
+    if (speakerOn) speakerFound();
+  }
+  if (connectAtUs != 0 && connectAtUs <= nowUs) {
+    connectAtUs = 0;
+    if (speakerOn) setConnected(true);
+  }
+  while (connected && audioCallback != NULL && nextAudioUs() <= nowUs) {
+    pullAudio();
+  }
+  for (size_t i = 0; i < timers.size(); i++) {
+    esp_timer *timer = timers[i];
+    while (timer->active && timer->nextUs <= nowUs) {
+      timer->nextUs += timer->periodUs;
+      timer->callback(timer->arg);
+    }
+  }
+}
+
+uint64_t simNowUs() {
+  return nowUs;
+}
+
+void simAdvance(uint64_t us) {
+  uint64_t target = nowUs + us;
+  while (true) {
+    uint64_t next = nextDueUs();
+    uint64_t step = std::min(next, target);
+    if (step > endUs) {
+      nowUs = endUs;
+      throw SimFinished();
+    }
+    nowUs = std::max(nowUs, step);
+    if (next > target) break;
+    runDue();
+  }
+
+  if (ptyMaster >= 0) {
+    std::this_thread::sleep_until(ptyStart + std::chrono::microseconds(nowUs));
+  }
+}
+
+void simLoopDone() {
+  loopCount++;
+  simAdvance(SIM_LOOP_COST_US);
+}
+
+// light sleep：睡到計時器到期，或下一次按鈕按下 / 序列埠輸入
+//（實機上 UART 喚醒會丟掉前幾個字元，模擬器不模擬這點）
+void simLightSleep(uint64_t maxUs) {
+  uint64_t wakeUs = nowUs + maxUs;
+  wakeCause = ESP_SLEEP_WAKEUP_TIMER;
+  for (size_t i = nextEvent; i < events.size() && events[i].us < wakeUs; i++) {
+    const ScriptEvent &ev = events[i];
+    if (ev.kind == EV_PIN && ev.value == HIGH) {
+      wakeUs = ev.us;
+      wakeCause = ESP_SLEEP_WAKEUP_GPIO;
+      break;
+    }
+    if (ev.kind == EV_SERIAL) {
+      wakeUs = ev.us;
+      wakeCause = ESP_SLEEP_WAKEUP_UART;
+      break;
+    }
+  }
+  sleepCount++;
+
+  // 虛擬終端機的輸入不在腳本裡，睡眠中每 10ms 檢查一次
+  while (ptyMaster >= 0 && nowUs + 10000 < wakeUs) {
+    simAdvance(10000);
+    if (pollPty()) {
+      wakeCause = ESP_SLEEP_WAKEUP_UART;
+      return;
+    }
+  }
+  simAdvance(wakeUs > nowUs ? wakeUs - nowUs : 0);
+}
+
+esp_sleep_wakeup_cause_t simWakeCause() {
+  return wakeCause;
+}
+
+// ========== 結束 ==========
+
+int simFinish(double wallSeconds) {
+  closeWav();
+  if (!options.nvsFile.empty() && !simNvsSave(options.nvsFile)) {
+    failures.push_back("無法寫入 NVS 檔案 " + options.nvsFile);
+  }
+  if (!serialLine.empty()) simSerialWrite('\n');
+  if (serialLog != NULL) fclose(serialLog);
+  if (ptyMaster >= 0) {
+    close(ptySlave);
+    close(ptyMaster);
+  }
+
+  FILE *csv = fopen(outPath("led_timeline.csv").c_str(), "w");
+  if (csv != NULL) {
+    fprintf(csv, "time_ms,r,g,b\n");
+    for (size_t i = 0; i < ledTimeline.size(); i++) {
+      const LedRow &row = ledTimeline[i];
+      fprintf(csv, "%.3f,%d,%d,%d\n", row.us / 1e3, row.rgb[0], row.rgb[1], row.rgb[2]);
+    }
+    fclose(csv);
+  }
+
+  double simSeconds = nowUs / 1e6;
+  printf("========================================\n");
+  printf("模擬時間 %.1f 秒，實際 %.2f 秒（%.0f 倍速）\n", simSeconds, wallSeconds,
+         wallSeconds > 0 ? simSeconds / wallSeconds : 0.0);
+  printf("loop() %u 次，light sleep %u 次\n", (unsigned)loopCount, (unsigned)sleepCount);
+  printf("燈光變化 %u 筆 → %s\n", (unsigned)ledTimeline.size() - 1, outPath("led_timeline.csv").c_str());
+  printf("音訊片段 %u 個", (unsigned)wavFiles.size());
+  for (size_t i = 0; i < wavFiles.size(); i++) {
+    printf("%s%s", i == 0 ? "：" : "、", wavFiles[i].c_str());
+  }
+  printf("\n序列埠輸出 → %s\n", outPath("serial.log").c_str());
+
+  if (failures.empty()) {
+    printf("✅ 檢查 %d 項全部通過\n", expectCount);
+    return 0;
+  }
+  printf("❌ 檢查 %d 項，%u 項失敗：\n", expectCount, (unsigned)failures.size());
+  for (size_t i = 0; i < failures.size(); i++) {
+    printf("   %s\n", failures[i].c_str());
+  }
+  return 1;
+}
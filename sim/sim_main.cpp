@@ -0,0 +1,75 @@
+#include "sim.h"
+#include <chrono>
+
+// ========== 模擬器主程式 ==========
+// 用法：ftb_sim [選項] <腳本>
+//   --out DIR     輸出資料夾（預設 sim_out）
+//   --clips DIR   音檔資料夾（預設產生 Dad_/Mom_/SX_ 三個合成音檔）
+//   --seed N      亂數種子（抽籤結果可重現）
+//   --until TIME  模擬到指定時間（例如 3h），覆蓋腳本的結束時間
+//   -v            序列埠輸出同時印到終端機
+//   --pty         序列埠接到虛擬終端機（印出路徑），時鐘改為跟著實際時間走，
+//                 可以用電腦端程式連線，例如 test_upload.py
+//   --nvs FILE    NVS 從檔案讀入、結束時寫回，連續執行兩次就像重新開機（例如記住的喇叭）
+
+// 韌體（src/main.cpp）
+void setup();
+void loop();
+
+static void usage() {
+  fprintf(stderr, "用法：ftb_sim [--out DIR] [--clips DIR] [--seed N] [--until TIME] [-v] [--pty] [--nvs FILE] <腳本>\n");
+}
+
+int main(int argc, char **argv) {
+  SimOptions options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--out" && hasValue) {
+      options.outDir = argv[++i];
+    } else if (arg == "--clips" && hasValue) {
+      options.clipDir = argv[++i];
+    } else if (arg == "--seed" && hasValue) {
+      options.seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (arg == "--until" && hasValue) {
+      if (!simParseTime(argv[++i], options.untilUs) || options.untilUs == 0) {
+        usage();
+        return 2;
+      }
+    } else if (arg == "-v") {
+      options.verbose = true;
+    } else if (arg == "--pty") {
+      options.pty = true;
+    } else if (arg == "--nvs" && hasValue) {
+      options.nvsFile = argv[++i];
+    } else if (arg[0] != '-' && options.script.empty()) {
+      options.script = arg;
+    } else {
+      usage();
+      return 2;
+    }
+  }
+
+  if (options.script.empty()) {
+    usage();
+    return 2;
+  }
+  if (!simLoadScript(options)) {
+    return 2;
+  }
+
+  simBegin();
+  std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+  try {
+    setup();
+    while (true) {
+      loop();
+      simLoopDone();
+    }
+  } catch (const SimFinished &) {
+  }
+  double wallSeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+  return simFinish(wallSeconds);
+}
@@ -0,0 +1,466 @@
+#include "sim.h"
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <SPIFFS.h>
+#include <esp_heap_caps.h>
+#include <esp_partition.h>
+#include <esp_system.h>
+#include <dirent.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <map>
+#include <random>
+#include <vector>
+
+// ========== 假的 Arduino / ESP-IDF API ==========
+// 只實作韌體有用到的部分，時間與 I/O 都交給 sim_core.cpp。
+
+// ---------- 時間 ----------
+
+unsigned long millis() {
+  return (unsigned long)(simNowUs() / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)simNowUs();
+}
+
+void delay(unsigned long ms) {
+  simAdvance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned us) {
+  simAdvance(us);
+}
+
+void yield() {}
+
+int64_t esp_timer_get_time() {
+  return (int64_t)simNowUs();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out) {
+  *out = simTimerCreate(args);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+  simTimerStart(timer, periodUs);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  simTimerStop(timer);
+  return ESP_OK;
+}
+
+// ---------- 休眠 ----------
+
+static uint64_t timerWakeUs = 0;
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_uart_wakeup(int uartNum) {
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs) {
+  timerWakeUs = timeUs;
+  return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start() {
+  simLightSleep(timerWakeUs > 0 ? timerWakeUs : UINT32_MAX);
+  return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+  return simWakeCause();
+}
+
+// ---------- 系統 ----------
+
+esp_reset_reason_t esp_reset_reason() {
+  return ESP_RST_POWERON;
+}
+
+uint32_t esp_get_free_heap_size() {
+  return 200000;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+  return 200000;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+  return 180000;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  return 110592;
+}
+
+static uint32_t cpuMhz = 240;
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+  cpuMhz = mhz;
+  return true;
+}
+
+uint32_t getCpuFrequencyMhz() {
+  return cpuMhz;
+}
+
+// ---------- GPIO / LEDC ----------
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+
+int digitalRead(uint8_t pin) {
+  return simPinLevel(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  simPinWrite(pin, level);
+}
+
+// 亂數種子來源（randomSeed(analogRead(0))），由 --seed 決定，結果可重現
+int analogRead(uint8_t pin) {
+  return (int)(simSeed() & 0xFFF);
+}
+
+double ledcSetup(uint8_t channel, double freq, uint8_t bits) {
+  simLedcSetup(channel, bits);
+  return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+  simLedcAttach(pin, channel);
+}
+
+void ledcDetachPin(uint8_t pin) {
+  simLedcDetach(pin);
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+  simLedcWrite(channel, duty);
+}
+
+// ---------- 亂數 ----------
+
+static std::mt19937 rng(1);
+
+void randomSeed(unsigned long seed) {
+  rng.seed((uint32_t)seed);
+}
+
+long random(long high) {
+  return high <= 0 ? 0 : (long)(rng() % (uint32_t)high);
+}
+
+long random(long low, long high) {
+  return high <= low ? low : low + random(high - low);
+}
+
+// ---------- 序列埠 ----------
+
+HardwareSerial Serial(0);
+
+size_t Print::printf(const char *format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (len < 0) return 0;
+  return write((const uint8_t *)buf, std::min((size_t)len, sizeof(buf) - 1));
+}
+
+// 只有 Serial（UART0）接到序列埠紀錄與腳本；其他 UART（語音模組）送出的資料丟掉、沒有回應
+size_t HardwareSerial::write(uint8_t c) {
+  if (port == 0) simSerialWrite(c);
+  return 1;
+}
+
+int HardwareSerial::available() {
+  return port == 0 ? simSerialAvailable() : 0;
+}
+
+int HardwareSerial::read() {
+  return port == 0 ? simSerialRead(true) : -1;
+}
+
+int HardwareSerial::peek() {
+  return port == 0 ? simSerialRead(false) : -1;
+}
+
+// ---------- 藍牙 ----------
+
+void BluetoothA2DPSource::start(const char *name, music_data_frames_cb_t callback) {
+  simA2dpStart(callback);
+}
+
+void BluetoothA2DPSource::start(std::vector<const char *> names, music_data_frames_cb_t callback) {
+  simA2dpStart(callback);
+}
+
+void BluetoothA2DPSource::set_ssid_callback(bool (*callback)(const char *ssid, esp_bd_addr_t address, int rssi)) {
+  simA2dpSsidCallback(callback);
+}
+
+void BluetoothA2DPSource::set_on_connection_state_changed(void (*callback)(esp_a2d_connection_state_t, void *),
+                                                          void *obj) {
+  simA2dpStateCallback(callback, obj);
+}
+
+bool BluetoothA2DPSource::connect_to(esp_bd_addr_t peer) {
+  return simA2dpConnectTo(peer);
+}
+
+void BluetoothA2DPSource::disconnect() {
+  simA2dpDisconnect();
+}
+
+bool BluetoothA2DPSource::is_connected() {
+  return simA2dpConnected();
+}
+
+esp_bd_addr_t *BluetoothA2DPSource::get_current_peer_address() {
+  static esp_bd_addr_t speaker;
+  memcpy(speaker, SIM_SPEAKER_ADDRESS, sizeof(speaker));
+  return simA2dpConnected() ? &speaker : NULL;
+}
+
+// ---------- 檔案系統（對應到 --clips 資料夾，只有一層）----------
+
+namespace fs {
+
+struct FileImpl {
+  FILE *f = NULL;
+  std::string name;             // 不含路徑
+  size_t size = 0;
+  bool directory = false;
+  std::vector<std::string> entries;
+  size_t nextEntry = 0;
+};
+
+static std::string hostPath(const char *path) {
+  return simClipDir() + (path[0] == '/' ? "" : "/") + path;
+}
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buf, size_t n) {
+  if (!impl || impl->f == NULL) return 0;
+  size_t written = fwrite(buf, 1, n, impl->f);
+  impl->size = std::max(impl->size, (size_t)ftell(impl->f));
+  return written;
+}
+
+int File::available() {
+  return (int)(size() - position());
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t *buf, size_t n) {
+  if (!impl || impl->f == NULL) return 0;
+  return fread(buf, 1, n, impl->f);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!impl || impl->f == NULL) return false;
+  int whence = mode == SeekSet ? SEEK_SET : (mode == SeekCur ? SEEK_CUR : SEEK_END);
+  return fseek(impl->f, pos, whence) == 0;
+}
+
+size_t File::position() const {
+  return impl && impl->f != NULL ? (size_t)ftell(impl->f) : 0;
+}
+
+size_t File::size() const {
+  return impl ? impl->size : 0;
+}
+
+void File::close() {
+  if (impl && impl->f != NULL) {
+    fclose(impl->f);
+    impl->f = NULL;
+  }
+  impl.reset();
+}
+
+File::operator bool() const {
+  return (bool)impl;
+}
+
+const char *File::name() const {
+  return impl ? impl->name.c_str() : "";
+}
+
+bool File::isDirectory() const {
+  return impl && impl->directory;
+}
+
+File File::openNextFile(const char *mode) {
+  if (!impl || !impl->directory || impl->nextEntry >= impl->entries.size()) return File();
+  std::string path = "/" + impl->entries[impl->nextEntry++];
+  return FS().open(path.c_str(), mode);
+}
+
+File FS::open(const char *path, const char *mode, bool create) {
+  std::shared_ptr<FileImpl> impl(new FileImpl());
+  const char *slash = strrchr(path, '/');
+  impl->name = slash ? slash + 1 : path;
+
+  std::string host = hostPath(path);
+  struct stat info;
+  bool exists = stat(host.c_str(), &info) == 0;
+
+  if (exists && S_ISDIR(info.st_mode)) {
+    impl->directory = true;
+    DIR *dir = opendir(host.c_str());
+    if (dir == NULL) return File();
+    while (struct dirent *entry = readdir(dir)) {
+      if (entry->d_name[0] != '.') impl->entries.push_back(entry->d_name);
+    }
+    closedir(dir);
+    std::sort(impl->entries.begin(), impl->entries.end());
+    return File(impl);
+  }
+
+  bool writing = mode[0] == 'w' || mode[0] == 'a';
+  if (!exists && !writing) return File();
+
+  impl->f = fopen(host.c_str(), writing ? (mode[0] == 'w' ? "wb" : "ab") : "rb");
+  if (impl->f == NULL) return File();
+  impl->size = writing && mode[0] == 'w' ? 0 : (size_t)info.st_size;
+  return File(impl);
+}
+
+bool FS::exists(const char *path) {
+  struct stat info;
+  return stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char *path) {
+  return ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char *from, const char *to) {
+  return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+}  // namespace fs
+
+SPIFFSFS SPIFFS;
+LittleFSFS LittleFS;
+
+// ---------- 原始分區（模擬器沒有，raw 後端會回報初始化失敗）----------
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label) {
+  return NULL;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t offset, void *dst, size_t len) {
+  return ESP_FAIL;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t offset, const void *src, size_t len) {
+  return ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t len) {
+  return ESP_FAIL;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, size_t size,
+                             spi_flash_mmap_memory_t memory, const void **out, spi_flash_mmap_handle_t *handle) {
+  return ESP_FAIL;
+}
+
+void spi_flash_munmap(spi_flash_mmap_handle_t handle) {}
+
+// ---------- NVS（記憶體內）----------
+
+static std::map<std::string, std::map<std::string, std::vector<uint8_t> > > nvs;
+
+bool Preferences::begin(const char *name, bool readOnly) {
+  space = name;
+  return true;
+}
+
+bool Preferences::clear() {
+  nvs[space].clear();
+  return true;
+}
+
+bool Preferences::remove(const char *key) {
+  return nvs[space].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char *key) {
+  return nvs[space].count(key) > 0;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+  const uint8_t *bytes = (const uint8_t *)value;
+  nvs[space][key].assign(bytes, bytes + len);
+  return len;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+  std::map<std::string, std::vector<uint8_t> >::iterator it = nvs[space].find(key);
+  if (it == nvs[space].end() || it->second.size() > maxLen) return 0;
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+  std::map<std::string, std::vector<uint8_t> >::iterator it = nvs[space].find(key);
+  return it == nvs[space].end() ? 0 : it->second.size();
+}
+
+// 每行一個 key：namespace key 十六進位內容
+bool simNvsLoad(const std::string &path) {
+  FILE *file = fopen(path.c_str(), "r");
+  if (file == NULL) return false;
+  char space[64], key[64], hex[8192];
+  while (fscanf(file, "%63s %63s %8191s", space, key, hex) == 3) {
+    std::vector<uint8_t> &value = nvs[space][key];
+    value.clear();
+    for (size_t i = 0; hex[i] != '\0' && hex[i + 1] != '\0'; i += 2) {
+      unsigned byte;
+      if (sscanf(hex + i, "%2x", &byte) != 1) break;
+      value.push_back((uint8_t)byte);
+    }
+  }
+  fclose(file);
+  return true;
+}
+
+bool simNvsSave(const std::string &path) {
+  FILE *file = fopen(path.c_str(), "w");
+  if (file == NULL) return false;
+  std::map<std::string, std::map<std::string, std::vector<uint8_t> > >::iterator space;
+  for (space = nvs.begin(); space != nvs.end(); ++space) {
+    std::map<std::string, std::vector<uint8_t> >::iterator key;
+    for (key = space->second.begin(); key != space->second.end(); ++key) {
+      if (key->second.empty()) continue;
+      fprintf(file, "%s %s ", space->first.c_str(), key->first.c_str());
+      for (size_t i = 0; i < key->second.size(); i++) fprintf(file, "%02x", key->second[i]);
+      fprintf(file, "\n");
+    }
+  }
+  fclose(file);
+  return true;
+}
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""序列埠上傳的整合測試（make test 會執行）。
+
+ftb_sim --pty 把韌體的序列埠接到虛擬終端機，tools/upload_clips.py 透過它上傳音檔：
+  新增 Dad_upload.wav、取代 Mom_sim.wav，傳送途中故意弄壞部分封包、丟掉一個封包，
+  結束後比對音檔內容，並確認裝置重新掃描到新音檔。
+"""
+
+import importlib.util
+import os
+import struct
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+OUT = os.path.join("sim_out", "upload")
+
+spec = importlib.util.spec_from_file_location("upload_clips", os.path.join(HERE, "..", "tools", "upload_clips.py"))
+upload_clips = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(upload_clips)
+
+# 虛擬時鐘跟著實際時間走：開機約 2.5 秒，上傳不到 1 秒
+SCRIPT = """\
+# tools/upload_clips.py 透過 pty 上傳（test_upload.py 產生）
+6s expect serial 上傳結束（完成）：2 個檔案
+6s expect serial 發現音檔: Dad_upload.wav
+6s expect serial Dad 系列: 2 個
+6.1s end
+"""
+
+
+class FlakyPort:
+    """每 5 個封包弄壞一個 byte，第 8 個封包整個丟掉（測試重送）"""
+
+    def __init__(self, port):
+        self.port = port
+        self.frames = 0
+        self.corrupted = 0
+        self.dropped = 0
+
+    def write(self, data):
+        if data[:2] == upload_clips.SYNC:
+            self.frames += 1
+            if self.frames == 8:
+                self.dropped += 1
+                return
+            if self.frames % 5 == 0:
+                data = bytearray(data)
+                data[len(data) // 2] ^= 0x40
+                self.corrupted += 1
+        self.port.write(bytes(data))
+
+    def __getattr__(self, name):
+        return getattr(self.port, name)
+
+
+def tone_wav(freq, seconds, rate=8000):
+    count = int(seconds * rate)
+    samples = bytearray()
+    for i in range(count):
+        phase = (i * freq * 4 // rate) % 4  # 三角波，不需要 math
+        level = (phase if phase < 2 else 4 - phase) - 1
+        samples += struct.pack("<h", int(level * 8000))
+    header = struct.pack("<4sI4s4sIHHIIHH4sI", b"RIFF", 36 + len(samples), b"WAVE", b"fmt ", 16, 1, 1, rate,
+                         rate * 2, 2, 16, b"data", len(samples))
+    return header + bytes(samples)
+
+
+def main():
+    os.makedirs(OUT, exist_ok=True)
+    script = os.path.join(OUT, "upload.txt")
+    with open(script, "w") as f:
+        f.write(SCRIPT)
+
+    sim = subprocess.Popen(["./ftb_sim", "--pty", "--out", OUT, script], stdout=subprocess.PIPE,
+                           universal_newlines=True)
+    line = sim.stdout.readline()
+    if not line.startswith("PTY "):
+        sim.kill()
+        raise SystemExit("❌ 模擬器沒有建立虛擬終端機：%r" % line)
+
+    files = [("Dad_upload.wav", tone_wav(300, 1.5)), ("Mom_sim.wav", tone_wav(700, 0.8))]
+    port = FlakyPort(upload_clips.open_port(line.split()[1]))
+    uploader = upload_clips.Uploader(port)
+    try:
+        uploader.enter()
+        for name, data in files:
+            uploader.upload(name, data)
+        uploader.leave()
+    finally:
+        port.close()
+
+    print(sim.stdout.read(), end="")
+    ok = sim.wait() == 0
+
+    for name, data in files:
+        with open(os.path.join(OUT, "clips", name), "rb") as f:
+            if f.read() != data:
+                print("❌ %s 內容不符" % name)
+                ok = False
+    if os.path.exists(os.path.join(OUT, "clips", "upload.tmp")):
+        print("❌ 留下了暫存檔")
+        ok = False
+    if port.corrupted == 0 or uploader.resends < port.corrupted + port.dropped:
+        print("❌ 壞掉的封包沒有重送（壞 %d、丟 %d、重送 %d）" % (port.corrupted, port.dropped, uploader.resends))
+        ok = False
+
+    if ok:
+        print("✅ 上傳 %d 個檔案，封包壞 %d 個、丟 %d 個，重送 %d 次後內容正確" %
+              (len(files), port.corrupted, port.dropped, uploader.resends))
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,72 @@
+#ifndef AUDIO_EVENTS_H
+#define AUDIO_EVENTS_H
+
+#include <atomic>
+#include <stdint.h>
+#include "spsc_ring.h"
+
+// ========== A2DP 回調 → loop() 的播放事件 ==========
+// 音頻回調在藍牙 task 執行，不能等鎖、關檔或印序列埠；它只把事件放進固定大小的環形緩衝區
+// （spsc_ring.h，不需要鎖也不配置記憶體），關檔、燈光與訊息由 loop() 取出事件後處理。
+// 放不下時丟掉並計數（回調永遠不等待），loop() 每次都會取完，正常不會滿。
+
+#ifndef AUDIO_EVENT_QUEUE
+#define AUDIO_EVENT_QUEUE 32          // 2 的次方
+#endif
+#ifndef AUDIO_POSITION_INTERVAL_MS
+#define AUDIO_POSITION_INTERVAL_MS 250  // 播放中每隔多久送一次位置
+#endif
+
+enum AudioEventType : uint8_t {
+  AUDIO_EVENT_STARTED,   // 開始送出樣本，value = 來源取樣率
+  AUDIO_EVENT_FINISHED,  // 音源播完（回調已把 isPlaying 設為 false），value = 播放毫秒數
+  AUDIO_EVENT_UNDERRUN,  // 音源 task 來不及補，value = 這次回調重複上一個樣本的次數
+  AUDIO_EVENT_POSITION,  // 播放位置，value = 毫秒
+  AUDIO_EVENT_TYPES
+};
+
+struct AudioEvent {
+  uint8_t type;       // AudioEventType
+  bool clip;          // 音檔或測試音（合成音效為 false）
+  uint16_t playback;  // 播放編號（loop() 每次換音源遞增，分辨事件是否屬於目前的音源）
+  uint32_t value;
+};
+
+template <uint32_t N>
+class AudioEventChannel {
+ public:
+  // ---------- 音頻回調 ----------
+
+  // 放不下時丟掉，回傳 false
+  bool post(uint8_t type, bool clip, uint16_t playback, uint32_t value) {
+    AudioEvent event = {type, clip, playback, value};
+    if (ring_.push(&event, 1) == 0) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  // ---------- loop() ----------
+
+  bool poll(AudioEvent &event) {
+    uint32_t pending = ring_.available();
+    if (pending == 0) return false;
+    if (pending > maxPending_) maxPending_ = pending;
+    ring_.pop(&event, 1);
+    if (event.type < AUDIO_EVENT_TYPES) received_[event.type]++;
+    return true;
+  }
+
+  uint32_t received(uint8_t type) const { return type < AUDIO_EVENT_TYPES ? received_[type] : 0; }
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+  uint32_t maxPending() const { return maxPending_; }
+
+ private:
+  SpscRing<AudioEvent, N> ring_;
+  std::atomic<uint32_t> dropped_{0};
+  uint32_t received_[AUDIO_EVENT_TYPES] = {};
+  uint32_t maxPending_ = 0;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef AUDIO_PIPELINE_H
+#define AUDIO_PIPELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ========== 音頻回調的區塊處理 ==========
+// A2DP 回調每次要一段 Frame，分成幾個階段，每個階段一次處理一整段連續的緩衝區：
+//   取樣本  audioRingRead()：音源 task 已經讀檔、解碼（WAV 小端序直接複製）、套用音量（PlaybackSource）
+//   補齊    pad()：來不及補時重複最後一個樣本，播完時補 0
+//   重採樣  resample()：零階保持（重複來源樣本）轉成輸出取樣率
+//   寫入    writeMonoFrames()：單聲道複製到 Frame 的兩個聲道
+// 原本每個輸出樣本都要檢查緩衝區、EOF、比較浮點相位；現在每段只判斷一次，內層迴圈沒有分支。
+// 相位是整數（以 1/輸出取樣率 個來源樣本為單位），不會累積浮點誤差。
+
+#define AUDIO_RUN_MAX 8  // 重採樣一次寫入的輸出數（每個來源樣本重複不超過這麼多次時使用）
+
+template <size_t BLOCK>
+class AudioPipeline {
+ public:
+  explicit AudioPipeline(uint32_t dstRate) : one_(dstRate), phase_(dstRate) {
+    work_[0] = 0;
+    setSourceRate(dstRate);
+  }
+
+  // 新音源開始前（回調看到新的播放編號時）：下一個輸出先取新樣本，上一個樣本當作 0
+  void reset() {
+    phase_ = one_;
+    work_[0] = 0;
+  }
+
+  // 來源取樣率（不能高於輸出取樣率，每個輸出最多取一個新樣本）
+  void setSourceRate(uint32_t rate) {
+    if (rate > one_) rate = one_;
+    if (rate == step_ || rate == 0) return;
+    step_ = rate;
+    runBase_ = one_ / rate;
+    runRem_ = one_ % rate;
+    inc_ = (((uint64_t)rate << 32) + one_ - 1) / one_;
+  }
+
+  // 產生 n 個（≤ BLOCK）輸出需要的新樣本數（最多 n 個），取到 fetchBuffer()
+  uint32_t needed(size_t n) const { return n == 0 ? 0 : (phase_ + (uint32_t)(n - 1) * step_) / one_; }
+  int16_t *fetchBuffer() { return work_ + 1; }
+
+  // 只取到 got 個（少於 need）：音源播完時補 0，否則（來不及補）重複最後一個樣本
+  void pad(uint32_t got, uint32_t need, bool ended) {
+    int16_t fill = ended ? 0 : work_[got];  // got == 0 時是上一段的最後一個樣本
+    for (uint32_t i = got + 1; i <= need; i++) work_[i] = fill;
+  }
+
+  // 把取到的樣本重採樣成 n 個輸出（先呼叫 needed(n) 並取樣本），回傳輸出緩衝區
+  // 第 i 個輸出是 work_[(phase_ + i * step_) / one_]
+  const int16_t *resample(size_t n) {
+    if (n == 0) return out_;
+    const int16_t *out;
+    if (step_ == one_) {
+      out = work_ + 1;  // 相同取樣率：直接用取到的樣本，不用複製
+    } else if (runBase_ < AUDIO_RUN_MAX) {
+      out = resampleRuns(n);
+    } else {
+      out = resampleEach(n);
+    }
+    uint32_t last = needed(n);
+    phase_ = phase_ + (uint32_t)n * step_ - last * one_;
+    work_[0] = work_[last];  // 下一段的上一個樣本
+    return out;
+  }
+
+ private:
+  // 每個來源樣本一次寫入 AUDIO_RUN_MAX 個輸出，下一個樣本從它開始的位置覆蓋多寫的部分。
+  // 開始位置用整數的 Bresenham 累加（每個樣本重複 runBase_ 或 runBase_ + 1 次），迴圈次數是來源樣本數
+  const int16_t *resampleRuns(size_t n) {
+    uint32_t index = phase_ / one_;
+    uint32_t last = needed(n);
+    // 下一個來源樣本從第 start 個輸出開始：start = ceil(((index + 1) * one_ - phase_) / step_)
+    uint32_t distance = (index + 1) * one_ - phase_;
+    uint32_t start = (distance + step_ - 1) / step_;
+    uint32_t slack = start * step_ - distance;
+
+    fillRun(out_, work_[index]);
+    for (uint32_t k = index + 1; k <= last; k++) {
+      fillRun(out_ + start, work_[k]);
+      uint32_t carry = runRem_ > slack;
+      start += runBase_ + carry;
+      slack = slack + (step_ & (0u - carry)) - runRem_;
+    }
+    return out_;
+  }
+
+  // 通用做法：32.32 定點數的位置，每個輸出一次加法與位移，彼此沒有相依。
+  // 定點數無條件進位，誤差（< BLOCK / 2^32）遠小於相位的最小間隔 1 / one_，結果與整數除法相同
+  const int16_t *resampleEach(size_t n) {
+    uint64_t pos = (((uint64_t)phase_ << 32) + one_ - 1) / one_;
+    for (size_t i = 0; i < n; i++) {
+      out_[i] = work_[(uint32_t)(pos >> 32)];
+      pos += inc_;
+    }
+    return out_;
+  }
+
+  static inline void fillRun(int16_t *dst, int16_t value) {
+    for (int i = 0; i < AUDIO_RUN_MAX; i++) dst[i] = value;
+  }
+
+  int16_t work_[BLOCK + 1];             // [0] 上一個樣本，[1..] 這一段取到的新樣本
+  int16_t out_[BLOCK + AUDIO_RUN_MAX];  // 重採樣結果（多留一段讓最後一個樣本整段寫入）
+  uint32_t one_;                        // 一個來源樣本 = 輸出取樣率
+  uint32_t step_ = 0;                   // 每個輸出前進 = 來源取樣率
+  uint32_t phase_;                      // ≥ one_ 表示下一個輸出要先取新樣本
+  uint32_t runBase_ = 1;                // one_ / step_
+  uint32_t runRem_ = 0;                 // one_ % step_
+  uint64_t inc_ = 0;                    // step_ / one_（32.32 定點數）
+};
+
+// 寫入：單聲道複製到兩個聲道（FrameT 為 A2DP 的 Frame）
+template <typename FrameT>
+inline void writeMonoFrames(FrameT *frames, const int16_t *mono, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    frames[i].channel1 = mono[i];
+    frames[i].channel2 = mono[i];
+  }
+}
+
+template <typename FrameT>
+inline void writeSilentFrames(FrameT *frames, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    frames[i].channel1 = 0;
+    frames[i].channel2 = 0;
+  }
+}
+
+#endif
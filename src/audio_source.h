@@ -0,0 +1,179 @@
+#ifndef AUDIO_SOURCE_H
+#define AUDIO_SOURCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include "read_ahead.h"
+
+// ========== 音源（區塊式讀取）==========
+// 所有音源都提供 pull(dst, n)：一次填入最多 n 個 16-bit 單聲道樣本，
+// 回傳實際填入數量，0 表示播完。
+// 以 CRTP 在編譯期決定呼叫哪個實作，PlaybackSource 每個區塊只做一次 switch，
+// 樣本迴圈內沒有虛擬函式呼叫。
+
+template <typename Derived>
+class AudioSource {
+ public:
+  size_t pull(int16_t *dst, size_t n) { return static_cast<Derived *>(this)->pullBlock(dst, n); }
+};
+
+// ---------- 音量 ----------
+// 增益為 Q12 定點數（4096 = 原音量，最大 16 倍），超出範圍的樣本截斷
+#define AUDIO_GAIN_UNITY 4096
+
+inline void applyGain(int16_t *samples, size_t n, uint16_t gain) {
+  for (size_t i = 0; i < n; i++) {
+    int32_t value = ((int32_t)samples[i] * gain) >> 12;
+    if (value > 32767) value = 32767;
+    if (value < -32768) value = -32768;
+    samples[i] = (int16_t)value;
+  }
+}
+
+// ---------- RAM 中的 PCM ----------
+// 也用於 memory-mapped 分區：映射後就是一段唯讀記憶體
+class MemorySource : public AudioSource<MemorySource> {
+ public:
+  void begin(const int16_t *samples, size_t count) {
+    data = samples;
+    total = count;
+    pos = 0;
+  }
+
+  size_t pullBlock(int16_t *dst, size_t n) {
+    size_t left = total - pos;
+    if (n > left) n = left;
+    memcpy(dst, data + pos, n * sizeof(int16_t));
+    pos += n;
+    return n;
+  }
+
+  size_t remaining() const { return total - pos; }
+
+ private:
+  const int16_t *data = NULL;
+  size_t total = 0;
+  size_t pos = 0;
+};
+
+// ---------- 從檔案串流 ----------
+// Reader 需提供 size_t read(uint8_t *, size_t)、uint32_t position() 與 void close()
+// （裝置上是 ClipReader，效能測試用假的 reader）
+// 經過預讀緩衝區：每次讀取的大小由 ReadAheadPolicy 依量測到的讀取速度調整（見 read_ahead.h）
+// 從 reader 目前的位置播放到 endPos（檔案中的 byte 位置，預設播到檔尾）
+template <typename Reader>
+class StreamSource : public AudioSource<StreamSource<Reader> > {
+ public:
+  // bytesPerSec：播放速度；clock：量測讀取耗時（NULL = 固定讀取大小）
+  void begin(Reader *source, uint32_t bytesPerSec = 0, ReadAheadClock clock = NULL,
+             uint32_t endPos = UINT32_MAX) {
+    reader = source;
+    stopPos = endPos;
+    head = 0;
+    tail = 0;
+    policy.begin(bytesPerSec, clock);
+  }
+
+  void end() {
+    if (reader != NULL) {
+      reader->close();
+      reader = NULL;
+    }
+  }
+
+  size_t pullBlock(int16_t *dst, size_t n) {
+    if (reader == NULL) return 0;
+    // WAV 為 16-bit PCM 小端序，ESP32 同為小端序，直接複製進樣本陣列
+    uint8_t *out = (uint8_t *)dst;
+    size_t want = n * sizeof(int16_t);
+    size_t got = 0;
+    while (got < want) {
+      if (head == tail && !refill()) break;
+      size_t take = tail - head;
+      if (take > want - got) take = want - got;
+      memcpy(out + got, buffer + head, take);
+      head += take;
+      got += take;
+    }
+    return got / sizeof(int16_t);
+  }
+
+  const ReadAheadPolicy &readAhead() const { return policy; }
+  ReadAheadPolicy &readAhead() { return policy; }
+
+ private:
+  // 緩衝區讀完才補充；不滿一個樣本的零頭（奇數 byte）搬到開頭接著讀
+  bool refill() {
+    size_t keep = tail - head;
+    if (keep > 0) memmove(buffer, buffer + head, keep);
+    head = 0;
+    tail = keep;
+
+    uint32_t pos = reader->position();
+    if (pos >= stopPos) return false;
+    size_t size = policy.nextReadSize(pos);
+    if (size > sizeof(buffer) - tail) size = sizeof(buffer) - tail;
+    if (size > stopPos - pos) size = stopPos - pos;
+    uint32_t start = policy.startRead();
+    size_t bytes = reader->read(buffer + tail, size);
+    if (bytes == 0) return false;
+    policy.finishRead(start, bytes);
+    tail += bytes;
+    return true;
+  }
+
+  Reader *reader = NULL;
+  uint32_t stopPos = UINT32_MAX;  // 播到這個位置為止
+  ReadAheadPolicy policy;
+  uint8_t buffer[READ_AHEAD_MAX + 1];
+  size_t head = 0;
+  size_t tail = 0;
+};
+
+// ---------- 正弦波測試音 ----------
+#define TONE_TABLE_SIZE 256
+
+inline const int16_t *sineTable() {
+  static int16_t table[TONE_TABLE_SIZE];
+  static bool ready = false;
+  if (!ready) {
+    for (int i = 0; i < TONE_TABLE_SIZE; i++) {
+      table[i] = (int16_t)(32767.0 * sin(2.0 * M_PI * i / TONE_TABLE_SIZE));
+    }
+    ready = true;
+  }
+  return table;
+}
+
+class ToneSource : public AudioSource<ToneSource> {
+ public:
+  void begin(uint32_t frequency, uint32_t sampleRate, uint32_t durationMs, int16_t amplitude) {
+    table = sineTable();
+    phase = 0;
+    // 相位累加器：32-bit 對應一個週期，高 8 bits 為查表索引
+    step = (uint32_t)(((uint64_t)frequency << 32) / sampleRate);
+    left = (uint32_t)((uint64_t)sampleRate * durationMs / 1000);
+    gain = amplitude;
+  }
+
+  size_t pullBlock(int16_t *dst, size_t n) {
+    if (n > left) n = left;
+    for (size_t i = 0; i < n; i++) {
+      dst[i] = (int16_t)((table[phase >> 24] * gain) >> 15);
+      phase += step;
+    }
+    left -= n;
+    return n;
+  }
+
+ private:
+  const int16_t *table = NULL;
+  uint32_t phase = 0;
+  uint32_t step = 0;
+  uint32_t left = 0;
+  int32_t gain = 0;
+};
+
+#endif
@@ -0,0 +1,98 @@
+#include "boot_timeline.h"
+#include "heap_watch.h"
+#include <esp_timer.h>
+
+#define BOOT_TIMELINE_MAGIC 0x42544C31  // "BTL1"
+
+struct BootTimeline {
+  uint32_t magic;
+  uint8_t count;
+  uint8_t finished;   // 1 = setup() 有跑完
+  uint16_t reserved;
+  uint32_t endUs[BOOT_MAX_PHASES];
+  char names[BOOT_MAX_PHASES][BOOT_PHASE_NAME_LEN];
+};
+
+// RTC 記憶體：重置後不會清除（斷電才會）
+RTC_NOINIT_ATTR static BootTimeline rtcTimeline;
+
+static BootTimeline previousTimeline;
+static bool previousValid = false;
+
+static bool timelineValid(const BootTimeline &timeline) {
+  return timeline.magic == BOOT_TIMELINE_MAGIC && timeline.count <= BOOT_MAX_PHASES;
+}
+
+void bootTimelineBegin() {
+  previousValid = timelineValid(rtcTimeline);
+  if (previousValid) {
+    previousTimeline = rtcTimeline;
+  }
+
+  memset(&rtcTimeline, 0, sizeof(rtcTimeline));
+  rtcTimeline.magic = BOOT_TIMELINE_MAGIC;
+}
+
+void bootTimelineMark(const char *phase) {
+  if (rtcTimeline.count >= BOOT_MAX_PHASES) {
+    return;
+  }
+
+  uint8_t index = rtcTimeline.count;
+  rtcTimeline.endUs[index] = (uint32_t)esp_timer_get_time();
+  strncpy(rtcTimeline.names[index], phase, BOOT_PHASE_NAME_LEN - 1);
+  rtcTimeline.names[index][BOOT_PHASE_NAME_LEN - 1] = '\0';
+  rtcTimeline.count++;
+}
+
+static void printTimeline(Print &out, const BootTimeline &timeline) {
+  uint32_t total = timeline.count > 0 ? timeline.endUs[timeline.count - 1] : 0;
+  uint32_t previousEnd = 0;
+
+  out.println("  階段              結束(us)     耗時(us)   占比");
+  for (int i = 0; i < timeline.count; i++) {
+    uint32_t duration = timeline.endUs[i] - previousEnd;
+    previousEnd = timeline.endUs[i];
+
+    printfNoAlloc(out, "  %-16s %10lu %12lu %5lu%%\n", timeline.names[i],
+                       (unsigned long)timeline.endUs[i], (unsigned long)duration,
+                       total > 0 ? (unsigned long)((uint64_t)duration * 100 / total) : 0UL);
+  }
+  if (!timeline.finished) {
+    out.println("  （未完成：開機在下一個階段中斷）");
+  }
+}
+
+void bootTimelineFinish() {
+  bootTimelineMark("ready");
+  rtcTimeline.finished = 1;
+
+  uint32_t totalMs = rtcTimeline.endUs[rtcTimeline.count - 1] / 1000;
+
+  Serial.println("\n【開機時間軸】");
+  printTimeline(Serial, rtcTimeline);
+  Serial.print("  開機到就緒: ");
+  Serial.print(totalMs);
+  Serial.print(" ms（預算 ");
+  Serial.print(BOOT_READY_BUDGET_MS);
+  Serial.println(" ms）");
+
+  if (totalMs > BOOT_READY_BUDGET_MS) {
+    Serial.println("⚠️  開機時間超過預算！請檢查上表耗時最多的階段");
+  }
+
+  // 上一次開機沒跑完（當機或看門狗重置），一併印出供比對
+  if (previousValid && !previousTimeline.finished) {
+    Serial.println("\n⚠️  上一次開機未完成：");
+    printTimeline(Serial, previousTimeline);
+  }
+}
+
+void bootTimelinePrint(Print &out) {
+  out.println("【開機時間軸】本次：");
+  printTimeline(out, rtcTimeline);
+  if (previousValid) {
+    out.println("上一次：");
+    printTimeline(out, previousTimeline);
+  }
+}
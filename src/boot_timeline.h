@@ -0,0 +1,24 @@
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <Arduino.h>
+
+// ========== 開機時間軸 ==========
+// 記錄 setup() 各階段完成的時間（微秒，從 app 啟動起算），
+// 開機完成時印出一次表格。時間軸存在 RTC 記憶體，
+// 軟體重置或當機重啟後仍可看到上一次開機停在哪個階段。
+
+// 開機到就緒的時間預算（可用 build_flags -DBOOT_READY_BUDGET_MS=... 覆寫）
+#ifndef BOOT_READY_BUDGET_MS
+#define BOOT_READY_BUDGET_MS 8000
+#endif
+
+#define BOOT_MAX_PHASES 12
+#define BOOT_PHASE_NAME_LEN 16
+
+void bootTimelineBegin();                 // setup() 第一行呼叫
+void bootTimelineMark(const char *phase); // 某個階段結束時呼叫
+void bootTimelineFinish();                // setup() 結束時呼叫，印出表格並檢查預算
+void bootTimelinePrint(Print &out);       // 印出本次與上一次的時間軸
+
+#endif
@@ -0,0 +1,353 @@
+#include "bt_link.h"
+#include <Preferences.h>
+#include <vector>
+#include "event_log.h"
+
+// NVS 中記住的喇叭（namespace "btlink"，key "peer"），只在位址或名稱改變時寫入
+struct CachedSpeaker {
+  uint8_t address[6];
+  char name[BT_NAME_LEN];  // 搜尋時看到的名稱（用位址連上時沿用）
+};
+
+// BT_SPEAKERS 拆開後的一項
+struct AllowedSpeaker {
+  char name[BT_NAME_LEN];
+  bool byAddress;
+  esp_bd_addr_t address;
+};
+
+static BluetoothA2DPSource *linkSource = NULL;
+static LinkStateHook linkStateHook = NULL;
+static Preferences linkPrefs;
+static bool prefsReady = false;
+static CachedSpeaker cached;
+static bool cachedValid = false;
+static AllowedSpeaker allowed[BT_MAX_SPEAKERS];
+static int allowedCount = 0;
+
+// 由藍牙 task 寫入
+static volatile bool linkUp = false;
+static char foundName[BT_NAME_LEN];  // 搜尋時最後接受的喇叭名稱
+
+// 開機先用上次的位址連線，這段時間搜尋到的裝置一律不連（藍牙 task 讀取）
+static volatile bool preferCached = false;
+static unsigned long cachedUntil = 0;
+
+// 以下只在 loop() 中使用
+static bool lastLinkUp = false;
+static esp_bd_addr_t peerAddress;
+static bool peerKnown = false;
+
+static unsigned long connectedAt = 0;
+static unsigned long nextAttemptAt = 0;
+static unsigned long lastAttemptAt = 0;
+static bool attemptStarted = false;
+static unsigned long backoffMs = BT_RECONNECT_MIN_MS;
+static bool viaCached = false;  // 這次連線是開機時用上次的位址連上的
+
+// 開機到可以播放
+static bool readyReported = false;
+static unsigned long readyAtMs = 0;
+static bool readyViaCached = false;
+
+// 統計
+static uint32_t attemptCount = 0;
+static uint32_t reconnectCount = 0;
+static uint32_t disconnectCount = 0;
+static unsigned long totalUptimeMs = 0;
+static unsigned long longestSessionMs = 0;
+
+static void printAddress(Print &out, const esp_bd_addr_t address) {
+  for (int i = 0; i < 6; i++) {
+    if (address[i] < 0x10) out.print("0");
+    out.print(address[i], HEX);
+    if (i < 5) out.print(":");
+  }
+}
+
+static int hexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// "AA:BB:CC:DD:EE:FF"
+static bool parseAddress(const char *text, esp_bd_addr_t address) {
+  if (strlen(text) != 17) return false;
+  for (int i = 0; i < 6; i++) {
+    int high = hexDigit(text[i * 3]);
+    int low = hexDigit(text[i * 3 + 1]);
+    if (high < 0 || low < 0 || (i < 5 && text[i * 3 + 2] != ':')) return false;
+    address[i] = (uint8_t)(high << 4 | low);
+  }
+  return true;
+}
+
+// 拆開 BT_SPEAKERS（逗號分隔，去掉前後空白）
+static void parseSpeakers() {
+  const char *p = BT_SPEAKERS;
+  allowedCount = 0;
+  while (*p != '\0' && allowedCount < BT_MAX_SPEAKERS) {
+    while (*p == ' ') p++;
+    const char *end = strchr(p, ',');
+    if (end == NULL) end = p + strlen(p);
+    size_t len = end - p;
+    while (len > 0 && p[len - 1] == ' ') len--;
+    if (len > 0 && len < BT_NAME_LEN) {
+      AllowedSpeaker &speaker = allowed[allowedCount++];
+      memcpy(speaker.name, p, len);
+      speaker.name[len] = '\0';
+      speaker.byAddress = parseAddress(speaker.name, speaker.address);
+    }
+    p = *end == ',' ? end + 1 : end;
+  }
+}
+
+static bool speakerAllowed(const char *name, const esp_bd_addr_t address) {
+  for (int i = 0; i < allowedCount; i++) {
+    if (allowed[i].byAddress ? memcmp(allowed[i].address, address, sizeof(esp_bd_addr_t)) == 0
+                             : name != NULL && strcmp(allowed[i].name, name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// 搜尋到裝置時由函式庫呼叫（藍牙 task），回傳 true 就連線
+static bool acceptSpeaker(const char *name, esp_bd_addr_t address, int rssi) {
+  if (preferCached || !speakerAllowed(name, address)) return false;
+  snprintf(foundName, sizeof(foundName), "%s", name != NULL ? name : "");
+  return true;
+}
+
+static void printCached(Print &out) {
+  out.print(cached.name[0] != '\0' ? cached.name : "?");
+  out.print("（");
+  printAddress(out, cached.address);
+  out.print("）");
+}
+
+void btLinkBegin(BluetoothA2DPSource &source, LinkStateHook onChange) {
+  linkSource = &source;
+  linkStateHook = onChange;
+  parseSpeakers();
+
+  prefsReady = linkPrefs.begin("btlink", false);
+  cachedValid = prefsReady && linkPrefs.getBytes("peer", &cached, sizeof(cached)) == sizeof(cached);
+  if (cachedValid) {
+    cached.name[BT_NAME_LEN - 1] = '\0';
+    // 改了 BT_SPEAKERS 之後，不再連到清單以外的喇叭
+    if (!speakerAllowed(cached.name, cached.address)) {
+      Serial.print("⚠️  上次的喇叭 ");
+      printCached(Serial);
+      Serial.println("不在 BT_SPEAKERS 中，改用名稱搜尋");
+      memset(&cached, 0, sizeof(cached));
+      cachedValid = false;
+    }
+  }
+}
+
+void btLinkStart(music_data_frames_cb_t callback) {
+  std::vector<const char *> names;
+  for (int i = 0; i < allowedCount; i++) {
+    if (!allowed[i].byAddress) names.push_back(allowed[i].name);
+  }
+
+  // 函式庫自己的自動重連不檢查允許清單，改由這裡用 NVS 中的位址連線
+  linkSource->set_auto_reconnect(false);
+  linkSource->set_ssid_callback(acceptSpeaker);
+
+  unsigned long now = millis();
+  if (cachedValid) {
+    memcpy(peerAddress, cached.address, sizeof(esp_bd_addr_t));
+    peerKnown = true;
+    preferCached = true;
+    cachedUntil = now + BT_CACHED_CONNECT_MS;
+    nextAttemptAt = now + BT_STACK_READY_MS;
+    Serial.print("⚡ 先連上次的喇叭 ");
+    printCached(Serial);
+    Serial.println();
+  } else {
+    Serial.print("🔍 正在搜尋喇叭：");
+    Serial.println(BT_SPEAKERS);
+    Serial.println("   請確保喇叭已開啟並進入配對模式！");
+  }
+
+  linkSource->start(names, callback);
+}
+
+void btLinkNotify(bool connected) {
+  linkUp = connected;
+}
+
+// 記住連上的喇叭（位址與名稱都沒變就不寫入 flash）
+static void saveSpeaker(const esp_bd_addr_t address, const char *name) {
+  if (cachedValid && memcmp(cached.address, address, sizeof(esp_bd_addr_t)) == 0 &&
+      strcmp(cached.name, name) == 0) {
+    return;
+  }
+  memcpy(cached.address, address, sizeof(esp_bd_addr_t));
+  snprintf(cached.name, sizeof(cached.name), "%s", name);
+  cachedValid = true;
+  if (prefsReady) linkPrefs.putBytes("peer", &cached, sizeof(cached));
+
+  Serial.print("💾 記住喇叭 ");
+  printCached(Serial);
+  Serial.println("，下次開機直接連線");
+}
+
+static void onLinkUp(unsigned long now) {
+  if (linkStateHook != NULL) linkStateHook(true);
+  connectedAt = now;
+  eventLogRecord(LOG_BT_LINK, 1);
+  viaCached = preferCached;
+  preferCached = false;
+  if (peerKnown && !viaCached) {
+    reconnectCount++;
+  }
+
+  // 記住喇叭位址，斷線時與下次開機直接用位址連線（不必重新搜尋名稱）
+  esp_bd_addr_t *current = linkSource->get_current_peer_address();
+  if (current != NULL) {
+    memcpy(peerAddress, *current, sizeof(esp_bd_addr_t));
+    peerKnown = true;
+    saveSpeaker(peerAddress, viaCached || foundName[0] == '\0' ? cached.name : foundName);
+  }
+
+  backoffMs = BT_RECONNECT_MIN_MS;
+  attemptStarted = false;
+}
+
+static void onLinkDown(unsigned long now) {
+  if (linkStateHook != NULL) linkStateHook(false);
+  unsigned long session = now - connectedAt;
+  totalUptimeMs += session;
+  if (session > longestSessionMs) longestSessionMs = session;
+  disconnectCount++;
+  eventLogRecord(LOG_BT_LINK, 0);
+
+  backoffMs = BT_RECONNECT_MIN_MS;
+  nextAttemptAt = now + backoffMs;
+
+  Serial.print("🔁 藍牙斷線，");
+  Serial.print(backoffMs / 1000);
+  Serial.println(" 秒後重新連線");
+}
+
+void btLinkService(unsigned long now) {
+  if (linkSource == NULL) return;
+
+  bool up = linkUp;
+  if (up != lastLinkUp) {
+    lastLinkUp = up;
+    if (up) {
+      onLinkUp(now);
+    } else {
+      onLinkDown(now);
+    }
+  }
+
+  if (!readyReported && up && now - connectedAt >= BT_LINK_SETTLE_MS) {
+    readyReported = true;
+    readyAtMs = now;
+    readyViaCached = viaCached;
+    Serial.print("🔊 開機到可以播放：");
+    Serial.print(readyAtMs / 1000.0, 1);
+    Serial.println(readyViaCached ? " 秒（上次的喇叭位址）" : " 秒（名稱搜尋）");
+  }
+
+  // 尚未連線過：交給函式庫依名稱搜尋
+  if (up || !peerKnown) return;
+
+  if (preferCached && (long)(now - cachedUntil) >= 0) {
+    preferCached = false;
+    peerKnown = false;
+    attemptStarted = false;
+    Serial.print("⚠️  上次的喇叭沒有回應，改用名稱搜尋：");
+    Serial.println(BT_SPEAKERS);
+    return;
+  }
+  if ((long)(now - nextAttemptAt) < 0) return;
+
+  if (preferCached) {
+    // 開機時用上次的位址連線：只送一次，堆疊還沒準備好就稍後再送
+    if (!linkSource->connect_to(peerAddress)) {
+      nextAttemptAt = now + 100;
+      return;
+    }
+    lastAttemptAt = now;
+    attemptStarted = true;
+    nextAttemptAt = cachedUntil;
+    return;
+  }
+
+  attemptCount++;
+  lastAttemptAt = now;
+  attemptStarted = true;
+  Serial.print("🔁 嘗試重新連線 ");
+  printAddress(Serial, peerAddress);
+  Serial.print("（第 ");
+  Serial.print(attemptCount);
+  Serial.println(" 次）");
+  linkSource->connect_to(peerAddress);
+
+  // 指數退避，上限 BT_RECONNECT_MAX_MS
+  backoffMs = min(backoffMs * 2, (unsigned long)BT_RECONNECT_MAX_MS);
+  nextAttemptAt = now + backoffMs;
+}
+
+bool btLinkUsable(unsigned long now) {
+  return lastLinkUp && now - connectedAt >= BT_LINK_SETTLE_MS;
+}
+
+bool btLinkAttemptInFlight(unsigned long now) {
+  return attemptStarted && !lastLinkUp && now - lastAttemptAt < BT_CONNECT_ATTEMPT_MS;
+}
+
+void btLinkPrintStats(Print &out) {
+  unsigned long now = millis();
+  unsigned long uptime = totalUptimeMs + (lastLinkUp ? now - connectedAt : 0);
+
+  out.println("【藍牙連線統計】");
+  out.print("  狀態: ");
+  out.println(lastLinkUp ? "已連線" : "未連線");
+  out.print("  允許的喇叭: ");
+  out.println(BT_SPEAKERS);
+  if (cachedValid) {
+    out.print("  記住的喇叭: ");
+    printCached(out);
+    out.println();
+  }
+  out.print("  開機到可以播放: ");
+  if (readyReported) {
+    out.print(readyAtMs / 1000.0, 1);
+    out.println(readyViaCached ? " 秒（上次的喇叭位址）" : " 秒（名稱搜尋）");
+  } else {
+    out.println("尚未就緒");
+  }
+  if (lastLinkUp) {
+    out.print("  本次連線: ");
+    out.print((now - connectedAt) / 1000);
+    out.println(" 秒");
+  } else if (peerKnown) {
+    out.print("  下次重試: ");
+    out.print((long)(nextAttemptAt - now) > 0 ? (nextAttemptAt - now) / 1000 : 0);
+    out.println(" 秒後");
+  }
+  out.print("  累計連線: ");
+  out.print(uptime / 1000);
+  out.print(" 秒 / 開機 ");
+  out.print(now / 1000);
+  out.println(" 秒");
+  out.print("  最長連線: ");
+  out.print(max(longestSessionMs, lastLinkUp ? now - connectedAt : 0UL) / 1000);
+  out.println(" 秒");
+  out.print("  斷線 ");
+  out.print(disconnectCount);
+  out.print(" 次，重連嘗試 ");
+  out.print(attemptCount);
+  out.print(" 次，成功 ");
+  out.print(reconnectCount);
+  out.println(" 次");
+}
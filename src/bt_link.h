@@ -0,0 +1,42 @@
+#ifndef BT_LINK_H
+#define BT_LINK_H
+
+#include <Arduino.h>
+#include "BluetoothA2DPSource.h"
+
+// ========== 藍牙連線管理 ==========
+// 開機時先用 NVS 記住的上次喇叭位址直接連線（不必搜尋名稱），
+// 連不上才改用名稱搜尋；只會連到 BT_SPEAKERS 列出的喇叭。
+// 喇叭斷線後，在背景以指數退避（2 秒 → 4 秒 → ... → 最多 60 秒）
+// 重新連線到上一次的喇叭位址，並統計連線時間與開機到可以播放的時間。
+// 連線狀態回調在藍牙 task 中執行，只記錄旗標；實際動作都在 loop() 中進行。
+
+// 允許連線的喇叭：名稱或位址（AA:BB:CC:DD:EE:FF），以逗號分隔，可用 build_flags 覆寫：
+//   build_flags = '-DBT_SPEAKERS="Bose Mini II SoundLink,JBL Flip 5"'
+#ifndef BT_SPEAKERS
+#define BT_SPEAKERS "Bose Mini II SoundLink"
+#endif
+#define BT_MAX_SPEAKERS 4
+#define BT_NAME_LEN 32
+
+#define BT_RECONNECT_MIN_MS 2000    // 第一次重試的等待時間
+#define BT_RECONNECT_MAX_MS 60000   // 退避上限
+#define BT_CONNECT_ATTEMPT_MS 5000  // 單次連線嘗試視為進行中的時間
+#define BT_LINK_SETTLE_MS 1500      // 連線後等喇叭準備好再開始播放
+#ifndef BT_CACHED_CONNECT_MS
+#define BT_CACHED_CONNECT_MS 4000   // 開機時用上次的位址連線，等這麼久連不上就改用名稱搜尋
+#endif
+#define BT_STACK_READY_MS 300       // start() 後等藍牙堆疊初始化完成再用位址連線
+
+typedef void (*LinkStateHook)(bool connected);
+
+// 讀取 NVS 中上次的喇叭；onChange 在連線 / 斷線後由 btLinkService() 呼叫（loop() 的 context，可以印訊息、改燈光）
+void btLinkBegin(BluetoothA2DPSource &source, LinkStateHook onChange);
+void btLinkStart(music_data_frames_cb_t callback);  // 啟動 A2DP（取代 source.start()）
+void btLinkNotify(bool connected);        // 由連線狀態回調呼叫（藍牙 task，只記錄旗標）
+void btLinkService(unsigned long now);    // 在 loop() 中呼叫（setup() 等待連線時也要呼叫）
+bool btLinkUsable(unsigned long now);     // 已連線且穩定，可以開始播放
+bool btLinkAttemptInFlight(unsigned long now);  // 正在嘗試連線（不要休眠）
+void btLinkPrintStats(Print &out);
+
+#endif
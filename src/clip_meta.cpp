@@ -0,0 +1,59 @@
+#include "clip_meta.h"
+#include "crc32.h"
+
+static ClipMeta metas[CLIP_META_MAX];
+static uint16_t metaCount = 0;
+
+static const char *baseName(const char *name) {
+  return name[0] == '/' ? name + 1 : name;
+}
+
+// 確認範圍合理（至少跳過 WAV 標頭、樣本對齊、不超出檔案）
+static bool validMeta(const ClipMeta &meta) {
+  return meta.name[CLIP_NAME_LEN - 1] == '\0' && meta.start >= 44 && meta.start < meta.end &&
+         meta.end <= meta.size && (meta.start & 1) == 0 && (meta.end & 1) == 0 && meta.gain > 0;
+}
+
+int clipMetaLoad(ClipStorage &storage) {
+  metaCount = 0;
+  ClipReader *reader = storage.open(CLIP_META_FILE);
+  if (reader == NULL) return 0;
+
+  uint32_t header[2];
+  uint16_t count = 0;
+  bool ok = reader->read((uint8_t *)header, sizeof(header)) == sizeof(header) &&
+            header[0] == CLIP_META_MAGIC && (header[1] & 0xFFFF) == CLIP_META_VERSION;
+  if (ok) {
+    count = header[1] >> 16;
+    ok = count <= CLIP_META_MAX &&
+         reader->read((uint8_t *)metas, count * sizeof(ClipMeta)) == count * sizeof(ClipMeta);
+  }
+
+  uint32_t crc = 0;
+  if (ok) ok = reader->read((uint8_t *)&crc, sizeof(crc)) == sizeof(crc);
+  reader->close();
+
+  if (ok) {
+    uint32_t actual = crc32Update(0, (const uint8_t *)header, sizeof(header));
+    actual = crc32Update(actual, (const uint8_t *)metas, count * sizeof(ClipMeta));
+    ok = actual == crc;
+  }
+  if (!ok) {
+    Serial.println("⚠️  " CLIP_META_FILE " 格式錯誤，音檔照原樣播放");
+    return 0;
+  }
+
+  for (uint16_t i = 0; i < count; i++) {
+    if (validMeta(metas[i])) metas[metaCount++] = metas[i];
+  }
+  return metaCount;
+}
+
+const ClipMeta *clipMetaFind(const char *name, uint32_t size) {
+  for (uint16_t i = 0; i < metaCount; i++) {
+    if (strcmp(metas[i].name, baseName(name)) == 0) {
+      return metas[i].size == size ? &metas[i] : NULL;
+    }
+  }
+  return NULL;
+}
@@ -0,0 +1,40 @@
+#ifndef CLIP_META_H
+#define CLIP_META_H
+
+#include <Arduino.h>
+#include "clip_storage.h"
+
+// ========== 音檔播放資訊（tools/analyze_clips.py 產生）==========
+// 電腦端事先分析每個音檔：量測整合響度（ITU-R BS.1770）算出音量增益，
+// 找出開頭與結尾的靜音。播放時直接從有聲音的位置開始並套用增益，
+// 裝置上不做任何分析，也不會串流靜音。
+// /clips.meta 與音檔放在一起（uploadfs 上傳或 pack_clips.py 打包），
+// 沒有這個檔案或音檔換過（大小不符）時照原樣播放。
+//
+// 格式（小端序）：
+//   標頭：magic "FTBM"(4)、版本(2)、音檔數(2)
+//   每筆：name[32]、size(4)、start(4)、end(4)、gain(2)、loudness(2)
+//   結尾：CRC-32（標頭 + 所有資料）
+
+#define CLIP_META_FILE "clips.meta"
+#define CLIP_META_MAGIC 0x4D425446  // "FTBM"（小端序）
+#define CLIP_META_VERSION 1
+#define CLIP_META_MAX 32
+
+struct ClipMeta {
+  char name[CLIP_NAME_LEN];
+  uint32_t size;      // 分析時的檔案大小
+  uint32_t start;     // 第一個有聲音的樣本（檔案中的 byte 位置，含 WAV 標頭）
+  uint32_t end;       // 最後一個有聲音的樣本之後
+  uint16_t gain;      // 音量增益，Q12（AUDIO_GAIN_UNITY = 原音量）
+  int16_t loudness;   // 分析時的響度（0.1 LUFS，顯示用）
+};
+static_assert(sizeof(ClipMeta) == 48, "ClipMeta 必須與 tools/analyze_clips.py 的格式相同");
+
+// 從儲存後端載入，回傳筆數（沒有檔案或格式錯誤時回傳 0）
+int clipMetaLoad(ClipStorage &storage);
+
+// 音檔的播放資訊（檔名可有可無 / 前綴），size 為目前的檔案大小，不符時回傳 NULL
+const ClipMeta *clipMetaFind(const char *name, uint32_t size);
+
+#endif
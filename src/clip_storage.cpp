@@ -0,0 +1,212 @@
+#include "clip_storage.h"
+#include <SPIFFS.h>
+#include <LittleFS.h>
+
+// 去掉開頭的 "/"（SPIFFS 列出的檔名可能有也可能沒有）
+static const char *baseName(const char *name) {
+  return name[0] == '/' ? name + 1 : name;
+}
+
+// ---------- 檔案系統後端 ----------
+
+void FsClipStorage::end() {
+  reader.close();
+  listRoot.close();
+  unmount();
+}
+
+void FsClipStorage::rewindClips() {
+  listRoot.close();
+  listRoot = fs.open("/");
+}
+
+bool FsClipStorage::nextClip(ClipInfo &info) {
+  if (!listRoot) return false;
+
+  while (true) {
+    fs::File file = listRoot.openNextFile();
+    if (!file) return false;
+    if (file.isDirectory()) continue;
+
+    strncpy(info.name, file.name(), CLIP_NAME_LEN - 1);
+    info.name[CLIP_NAME_LEN - 1] = '\0';
+    info.size = file.size();
+    file.close();
+    return true;
+  }
+}
+
+ClipReader *FsClipStorage::open(const char *name) {
+  reader.close();
+
+  char path[CLIP_NAME_LEN + 1];
+  snprintf(path, sizeof(path), "/%s", baseName(name));
+  reader.file = fs.open(path, "r");
+  return reader.file ? &reader : NULL;
+}
+
+ClipWriter *FsClipStorage::create(const char *name) {
+  reader.close();
+  writer.abort();
+
+  snprintf(writer.path, sizeof(writer.path), "/%s", baseName(name));
+  writer.fs = &fs;
+  writer.file = fs.open(CLIP_UPLOAD_TEMP, "w");
+  return writer.file ? &writer : NULL;
+}
+
+bool FsClipWriter::commit() {
+  file.close();
+  if (fs->exists(path) && !fs->remove(path)) {
+    fs->remove(CLIP_UPLOAD_TEMP);
+    return false;
+  }
+  return fs->rename(CLIP_UPLOAD_TEMP, path);
+}
+
+void FsClipWriter::abort() {
+  if (!file) return;
+  file.close();
+  fs->remove(CLIP_UPLOAD_TEMP);
+}
+
+// ---------- 原始分區後端 ----------
+
+size_t RawClipReader::read(uint8_t *buf, size_t len) {
+  if (partition == NULL || pos >= clipSize) return 0;
+  if (len > clipSize - pos) len = clipSize - pos;
+
+  if (esp_partition_read(partition, clipOffset + pos, buf, len) != ESP_OK) {
+    return 0;
+  }
+  pos += len;
+  return len;
+}
+
+bool RawClipReader::seek(uint32_t newPos) {
+  if (newPos > clipSize) return false;
+  pos = newPos;
+  return true;
+}
+
+bool RawClipStorage::begin() {
+  partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                       CLIP_PARTITION_LABEL);
+  if (partition == NULL) {
+    Serial.println("❌ 找不到音檔分區 '" CLIP_PARTITION_LABEL "'");
+    return false;
+  }
+
+  uint32_t header[2];
+  if (esp_partition_read(partition, 0, header, sizeof(header)) != ESP_OK ||
+      header[0] != RAW_CLIP_MAGIC || (header[1] & 0xFFFF) != RAW_CLIP_VERSION) {
+    Serial.println("❌ 音檔分區不是 raw 格式（請用 tools/pack_clips.py 產生）");
+    partition = NULL;
+    return false;
+  }
+
+  clipCount = min((uint32_t)(header[1] >> 16), (uint32_t)RAW_CLIP_MAX);
+  if (esp_partition_read(partition, sizeof(header), entries, clipCount * sizeof(RawClipEntry)) != ESP_OK) {
+    partition = NULL;
+    return false;
+  }
+
+  // 去掉超出分區範圍的項目
+  uint16_t valid = 0;
+  for (uint16_t i = 0; i < clipCount; i++) {
+    entries[i].name[CLIP_NAME_LEN - 1] = '\0';
+    if (entries[i].offset + entries[i].size <= partition->size) {
+      entries[valid++] = entries[i];
+    }
+  }
+  clipCount = valid;
+  listIndex = 0;
+  return true;
+}
+
+bool RawClipStorage::nextClip(ClipInfo &info) {
+  if (listIndex >= clipCount) return false;
+
+  const RawClipEntry &entry = entries[listIndex++];
+  memcpy(info.name, entry.name, CLIP_NAME_LEN);
+  info.size = entry.size;
+  return true;
+}
+
+const RawClipEntry *RawClipStorage::findClip(const char *name) {
+  if (partition == NULL) return NULL;
+
+  for (uint16_t i = 0; i < clipCount; i++) {
+    if (strcmp(entries[i].name, baseName(name)) == 0) {
+      return &entries[i];
+    }
+  }
+  return NULL;
+}
+
+ClipReader *RawClipStorage::open(const char *name) {
+  reader.close();
+
+  const RawClipEntry *entry = findClip(name);
+  if (entry == NULL) return NULL;
+
+  reader.partition = partition;
+  reader.clipOffset = entry->offset;
+  reader.clipSize = entry->size;
+  reader.pos = 0;
+  return &reader;
+}
+
+const uint8_t *RawClipStorage::mapClip(const char *name, uint32_t &size) {
+  unmapClip();
+
+  const RawClipEntry *entry = findClip(name);
+  if (entry == NULL) return NULL;
+
+  const void *ptr = NULL;
+  if (esp_partition_mmap(partition, entry->offset, entry->size, SPI_FLASH_MMAP_DATA, &ptr, &mapHandle) != ESP_OK) {
+    return NULL;
+  }
+  mapped = true;
+  size = entry->size;
+  return (const uint8_t *)ptr;
+}
+
+void RawClipStorage::unmapClip() {
+  if (mapped) {
+    spi_flash_munmap(mapHandle);
+    mapped = false;
+  }
+}
+
+// ---------- 後端實例 ----------
+
+static bool mountSpiffs() { return SPIFFS.begin(true); }
+static void unmountSpiffs() { SPIFFS.end(); }
+static bool mountLittlefs() { return LittleFS.begin(true, "/littlefs", 10, CLIP_PARTITION_LABEL); }
+static void unmountLittlefs() { LittleFS.end(); }
+
+ClipStorage &spiffsClipStorage() {
+  static FsClipStorage storage("SPIFFS", SPIFFS, mountSpiffs, unmountSpiffs);
+  return storage;
+}
+
+ClipStorage &littlefsClipStorage() {
+  static FsClipStorage storage("LittleFS", LittleFS, mountLittlefs, unmountLittlefs);
+  return storage;
+}
+
+RawClipStorage &rawClipStorage() {
+  static RawClipStorage storage;
+  return storage;
+}
+
+ClipStorage &clipStorage() {
+#if CLIP_STORAGE == CLIP_STORAGE_LITTLEFS
+  return littlefsClipStorage();
+#elif CLIP_STORAGE == CLIP_STORAGE_RAW
+  return rawClipStorage();
+#else
+  return spiffsClipStorage();
+#endif
+}
@@ -0,0 +1,197 @@
+#ifndef CLIP_STORAGE_H
+#define CLIP_STORAGE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <esp_partition.h>
+
+// ========== 音檔儲存後端 ==========
+// 音檔可以放在 SPIFFS、LittleFS 或未格式化的原始分區（raw），
+// 用 build_flags -DCLIP_STORAGE=... 選擇，預設 SPIFFS。
+// 讀取以區塊為單位（每次數百 bytes 以上），虛擬函式呼叫的成本可忽略。
+
+#define CLIP_STORAGE_SPIFFS 0
+#define CLIP_STORAGE_LITTLEFS 1
+#define CLIP_STORAGE_RAW 2
+
+#ifndef CLIP_STORAGE
+#define CLIP_STORAGE CLIP_STORAGE_SPIFFS
+#endif
+
+// 音檔所在的分區標籤（SPIFFS / LittleFS / raw 共用）
+#define CLIP_PARTITION_LABEL "spiffs"
+
+#define CLIP_NAME_LEN 32
+
+struct ClipInfo {
+  char name[CLIP_NAME_LEN];
+  uint32_t size;
+};
+
+// 開啟中的音檔
+class ClipReader {
+ public:
+  virtual ~ClipReader() {}
+  virtual size_t read(uint8_t *buf, size_t len) = 0;
+  virtual bool seek(uint32_t pos) = 0;
+  virtual uint32_t position() = 0;
+  virtual uint32_t size() = 0;
+  virtual void close() = 0;
+
+  uint32_t available() { return size() - position(); }
+};
+
+// 寫入中的音檔（序列埠上傳，見 serial_upload.h）：先寫到暫存檔，commit() 才取代同名的舊檔
+class ClipWriter {
+ public:
+  virtual ~ClipWriter() {}
+  virtual size_t write(const uint8_t *buf, size_t len) = 0;
+  virtual bool commit() = 0;
+  virtual void abort() = 0;
+};
+
+// 儲存後端（同一時間只開啟一個音檔，讀取物件是後端的成員）
+// RawClipStorage::open() 只記下位置，不配置記憶體；SPIFFS/LittleFS 的 fs.open() 會配置檔案物件與緩衝區
+// （loop task 已知會用到 heap 的地方見 heap_watch.h）
+class ClipStorage {
+ public:
+  virtual ~ClipStorage() {}
+  virtual const char *name() = 0;
+  virtual bool begin() = 0;
+  virtual void end() = 0;
+
+  // 列出音檔：先呼叫 rewindClips()，再重複呼叫 nextClip() 直到回傳 false
+  virtual void rewindClips() = 0;
+  virtual bool nextClip(ClipInfo &info) = 0;
+
+  // 開啟音檔，失敗回傳 NULL；再次開啟會關閉前一個
+  virtual ClipReader *open(const char *name) = 0;
+
+  // 建立音檔（會關閉開啟中的音檔），不支援寫入或失敗時回傳 NULL；同一時間只寫一個
+  virtual bool writable() { return false; }
+  virtual ClipWriter *create(const char *name) { return NULL; }
+};
+
+// ---------- 檔案系統後端（SPIFFS / LittleFS）----------
+
+class FsClipReader : public ClipReader {
+ public:
+  size_t read(uint8_t *buf, size_t len) override { return file.read(buf, len); }
+  bool seek(uint32_t pos) override { return file.seek(pos); }
+  uint32_t position() override { return file.position(); }
+  uint32_t size() override { return file.size(); }
+  void close() override { file.close(); }
+
+  fs::File file;
+};
+
+// 寫到 CLIP_UPLOAD_TEMP，commit() 時刪除舊檔再改名（寫到一半中斷不會留下半個音檔）
+#define CLIP_UPLOAD_TEMP "/upload.tmp"
+
+class FsClipWriter : public ClipWriter {
+ public:
+  size_t write(const uint8_t *buf, size_t len) override { return file.write(buf, len); }
+  bool commit() override;
+  void abort() override;
+
+  fs::FS *fs = NULL;
+  fs::File file;
+  char path[CLIP_NAME_LEN + 1];
+};
+
+class FsClipStorage : public ClipStorage {
+ public:
+  typedef bool (*MountFunction)();
+  typedef void (*UnmountFunction)();
+
+  FsClipStorage(const char *name, fs::FS &fs, MountFunction mount, UnmountFunction unmount)
+      : storageName(name), fs(fs), mount(mount), unmount(unmount) {}
+
+  const char *name() override { return storageName; }
+  bool begin() override { return mount(); }
+  void end() override;
+  void rewindClips() override;
+  bool nextClip(ClipInfo &info) override;
+  ClipReader *open(const char *name) override;
+  bool writable() override { return true; }
+  ClipWriter *create(const char *name) override;
+
+ private:
+  const char *storageName;
+  fs::FS &fs;
+  MountFunction mount;
+  UnmountFunction unmount;
+  fs::File listRoot;
+  FsClipReader reader;
+  FsClipWriter writer;
+};
+
+// ---------- 原始分區後端 ----------
+// 分區格式（tools/pack_clips.py 產生）：
+//   標頭：magic "FTBC"(4)、版本(2)、音檔數(2)
+//   目錄：每筆 name[32]、offset(4)、size(4)，offset 從分區開頭算起
+//   資料：每個音檔從 4KB（flash sector）邊界開始
+// 沒有檔案系統的開檔與查表成本，讀取直接對應到 flash 位址。
+
+#define RAW_CLIP_MAGIC 0x43425446  // "FTBC"（小端序）
+#define RAW_CLIP_VERSION 1
+#define RAW_CLIP_MAX 32
+
+struct RawClipEntry {
+  char name[CLIP_NAME_LEN];
+  uint32_t offset;
+  uint32_t size;
+};
+
+class RawClipReader : public ClipReader {
+ public:
+  size_t read(uint8_t *buf, size_t len) override;
+  bool seek(uint32_t pos) override;
+  uint32_t position() override { return pos; }
+  uint32_t size() override { return clipSize; }
+  void close() override { partition = NULL; }
+
+  const esp_partition_t *partition = NULL;
+  uint32_t clipOffset = 0;
+  uint32_t clipSize = 0;
+  uint32_t pos = 0;
+};
+
+class RawClipStorage : public ClipStorage {
+ public:
+  const char *name() override { return "raw"; }
+  bool begin() override;
+  void end() override {
+    unmapClip();
+    partition = NULL;
+  }
+  void rewindClips() override { listIndex = 0; }
+  bool nextClip(ClipInfo &info) override;
+  ClipReader *open(const char *name) override;
+
+  // 將音檔映射到記憶體（經由 flash cache 直接讀取，不需複製），失敗回傳 NULL
+  // 同一時間只保留一個映射，再次呼叫會解除前一個
+  const uint8_t *mapClip(const char *name, uint32_t &size);
+  void unmapClip();
+
+ private:
+  const RawClipEntry *findClip(const char *name);
+
+  const esp_partition_t *partition = NULL;
+  spi_flash_mmap_handle_t mapHandle = 0;
+  bool mapped = false;
+  RawClipEntry entries[RAW_CLIP_MAX];
+  uint16_t clipCount = 0;
+  uint16_t listIndex = 0;
+  RawClipReader reader;
+};
+
+// 依 CLIP_STORAGE 選擇的後端
+ClipStorage &clipStorage();
+
+// 各後端（效能測試用）
+ClipStorage &spiffsClipStorage();
+ClipStorage &littlefsClipStorage();
+RawClipStorage &rawClipStorage();
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef COLOR16_H
+#define COLOR16_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include "pixel_kernels.h"
+
+// ========== 16-bit 線性色彩與時間抖動 ==========
+// 燈光效果先在 16-bit 線性亮度下計算（gamma 校正後再乘亮度），
+// 最後用時間抖動（每次輸出把捨去的位元累積到下一次）轉成 LEDC 的 12-14 位元。
+// 低亮度時 8-bit 只有少數幾階，呼吸燈淡出會看到明顯跳階；16-bit + 抖動可平滑過渡。
+
+#define COLOR16_GAMMA 2.2f
+
+struct PixelColor16 {
+  uint16_t r;
+  uint16_t g;
+  uint16_t b;
+};
+
+// 8-bit 感知亮度 → 16-bit 線性亮度（第一次呼叫時建表）
+inline const uint16_t *gammaTable() {
+  static uint16_t table[256];
+  static bool ready = false;
+  if (!ready) {
+    for (int i = 0; i < 256; i++) {
+      table[i] = (uint16_t)lroundf(powf(i / 255.0f, COLOR16_GAMMA) * 65535.0f);
+    }
+    ready = true;
+  }
+  return table;
+}
+
+inline uint16_t gamma16(uint8_t value) {
+  return gammaTable()[value];
+}
+
+// 16-bit 感知亮度 → 16-bit 線性亮度（查表 + 線性內插，低亮度不會卡在同一階）
+inline uint16_t gammaLevel16(uint16_t value) {
+  const uint16_t *table = gammaTable();
+  uint8_t index = value >> 8;
+  uint32_t frac = value & 0xFF;
+  uint32_t low = table[index];
+  uint32_t high = index == 255 ? 65535 : table[index + 1];
+  return (uint16_t)(low + (((high - low) * frac) >> 8));
+}
+
+// 16-bit 亮度相乘（65535 = 不變）
+inline uint16_t scale16(uint16_t value, uint16_t scale) {
+  return (uint16_t)(((uint32_t)value * (scale + 1u)) >> 16);
+}
+
+// 整批 gamma 展開：8-bit 顏色 → 16-bit 線性
+inline void pixelGammaExpand(PixelColor16 *dst, const PixelColor *src, size_t count) {
+  const uint16_t *table = gammaTable();
+  for (size_t i = 0; i < count; i++) {
+    dst[i].r = table[src[i].r];
+    dst[i].g = table[src[i].g];
+    dst[i].b = table[src[i].b];
+  }
+}
+
+// 整批乘上 16-bit 亮度
+inline void pixelScale16(PixelColor16 *pixels, size_t count, uint16_t scale) {
+  uint32_t s = scale + 1u;
+  for (size_t i = 0; i < count; i++) {
+    pixels[i].r = (pixels[i].r * s) >> 16;
+    pixels[i].g = (pixels[i].g * s) >> 16;
+    pixels[i].b = (pixels[i].b * s) >> 16;
+  }
+}
+
+// 時間抖動：16-bit 值輸出成 bits 位元，捨去的部分存在 residue 留給下一次
+// 連續呼叫的平均輸出等於 value / 2^(16 - bits)
+inline uint16_t ditherStep(uint16_t value, uint8_t bits, uint16_t &residue) {
+  uint8_t shift = 16 - bits;
+  uint32_t acc = (uint32_t)value + residue;
+  uint32_t out = acc >> shift;
+  residue = acc & ((1u << shift) - 1);
+  uint32_t max = (1u << bits) - 1;
+  return (uint16_t)(out > max ? max : out);
+}
+
+#endif
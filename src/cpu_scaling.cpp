@@ -0,0 +1,124 @@
+#include "cpu_scaling.h"
+#include <esp_timer.h>
+#include <esp_pm.h>
+
+// A2DP 輸出採樣率（用於計算回調的時間期限）
+#define CALLBACK_SAMPLE_RATE 44100
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t busyLock = NULL;
+#endif
+static bool busyActive = false;
+static uint32_t levelSwitches = 0;
+
+// 各頻率下的音頻回調統計
+struct CallbackStats {
+  uint32_t calls;
+  uint32_t misses;        // 執行時間超過期限的次數
+  uint32_t maxUs;
+  uint64_t sumUs;
+  uint32_t maxLoadPct;    // 執行時間 / 期限 的最大值（%）
+};
+
+// 0: 80MHz, 1: 160MHz, 2: 240MHz, 3: 其他
+static CallbackStats callbackStats[4];
+
+static int levelIndex(uint32_t mhz) {
+  switch (mhz) {
+    case 80: return 0;
+    case 160: return 1;
+    case 240: return 2;
+    default: return 3;
+  }
+}
+
+void cpuScalingBegin() {
+#if CONFIG_PM_ENABLE
+  esp_pm_config_esp32_t config = {};
+  config.max_freq_mhz = CPU_FREQ_BUSY_MHZ;
+  config.min_freq_mhz = CPU_FREQ_IDLE_MHZ;
+  config.light_sleep_enable = false;  // light sleep 由 power_idle 自行控制
+
+  if (esp_pm_configure(&config) == ESP_OK &&
+      esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "ftb_busy", &busyLock) == ESP_OK) {
+    esp_pm_lock_acquire(busyLock);
+    Serial.println("⚡ CPU 調頻：使用 PM lock（80~240MHz）");
+  } else {
+    busyLock = NULL;
+    Serial.println("⚠️  PM 設定失敗，改用 setCpuFrequencyMhz()");
+  }
+#endif
+
+  // 開機過程維持最高頻率，進入 loop() 後才依負載調整
+  busyActive = true;
+}
+
+void cpuScalingUpdate(bool busy) {
+  if (busy == busyActive) {
+    return;
+  }
+  busyActive = busy;
+  levelSwitches++;
+
+#if CONFIG_PM_ENABLE
+  if (busyLock != NULL) {
+    if (busy) {
+      esp_pm_lock_acquire(busyLock);
+    } else {
+      esp_pm_lock_release(busyLock);
+    }
+    return;
+  }
+#endif
+
+  setCpuFrequencyMhz(busy ? CPU_FREQ_BUSY_MHZ : CPU_FREQ_IDLE_MHZ);
+}
+
+int64_t audioCallbackBegin() {
+  return esp_timer_get_time();
+}
+
+void audioCallbackEnd(int64_t startUs, int32_t frameCount) {
+  uint32_t elapsed = (uint32_t)(esp_timer_get_time() - startUs);
+  uint32_t deadline = (uint32_t)((int64_t)frameCount * 1000000 / CALLBACK_SAMPLE_RATE);
+
+  CallbackStats &stats = callbackStats[levelIndex(getCpuFrequencyMhz())];
+  stats.calls++;
+  stats.sumUs += elapsed;
+  if (elapsed > stats.maxUs) stats.maxUs = elapsed;
+  if (deadline > 0) {
+    uint32_t load = elapsed * 100 / deadline;
+    if (load > stats.maxLoadPct) stats.maxLoadPct = load;
+  }
+  if (elapsed > deadline) stats.misses++;
+}
+
+void cpuScalingPrintStats(Print &out) {
+  static const char *levelNames[4] = {"80MHz", "160MHz", "240MHz", "其他"};
+
+  out.println("【CPU 調頻統計】");
+  out.print("  目前頻率: ");
+  out.print(getCpuFrequencyMhz());
+  out.print(" MHz，切換 ");
+  out.print(levelSwitches);
+  out.println(" 次");
+  out.println("  音頻回調（各頻率）：");
+
+  for (int i = 0; i < 4; i++) {
+    const CallbackStats &stats = callbackStats[i];
+    if (stats.calls == 0) continue;
+    out.print("    ");
+    out.print(levelNames[i]);
+    out.print(": ");
+    out.print(stats.calls);
+    out.print(" 次，平均 ");
+    out.print((unsigned long)(stats.sumUs / stats.calls));
+    out.print(" us，最大 ");
+    out.print(stats.maxUs);
+    out.print(" us（期限的 ");
+    out.print(stats.maxLoadPct);
+    out.print("%），逾時 ");
+    out.print(stats.misses);
+    out.println(" 次");
+  }
+}
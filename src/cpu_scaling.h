@@ -0,0 +1,25 @@
+#ifndef CPU_SCALING_H
+#define CPU_SCALING_H
+
+#include <Arduino.h>
+
+// ========== CPU 頻率調整 ==========
+// 播放音檔或抽籤燈光動畫時拉到最高頻率，其餘時間降頻省電。
+// 有 CONFIG_PM_ENABLE 時使用 ESP-IDF PM lock（由系統自動調頻），
+// 否則退回 setCpuFrequencyMhz() 直接切換。
+// 藍牙需要 APB 80MHz，所以最低只降到 80MHz。
+
+#define CPU_FREQ_BUSY_MHZ 240
+#define CPU_FREQ_IDLE_MHZ 80
+
+void cpuScalingBegin();
+void cpuScalingUpdate(bool busy);  // 在 loop() 中呼叫
+
+// 音頻回調計時（在 get_sound_data() 開頭與結尾呼叫）
+// 回傳值傳給 audioCallbackEnd()
+int64_t audioCallbackBegin();
+void audioCallbackEnd(int64_t startUs, int32_t frameCount);
+
+void cpuScalingPrintStats(Print &out);
+
+#endif
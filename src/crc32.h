@@ -0,0 +1,21 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// CRC-32（IEEE 802.3，與 zlib / Python binascii.crc32 相同）
+// 不使用查表，省下 1KB RAM；資料量小，速度足夠
+// 可分段計算：crc = crc32Update(crc, 第二段...)，初始值傳 0
+inline uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+#endif
@@ -0,0 +1,224 @@
+#include "event_log.h"
+#include <Preferences.h>
+#include <esp_system.h>
+#include "crc32.h"
+
+// NVS 中的區塊格式（key: "b00" ~ "b15"）
+struct LogBlock {
+  uint32_t seq;       // 區塊序號（從 1 開始，0 表示空）
+  uint8_t count;      // 已使用筆數
+  uint8_t reserved[3];
+  LogEvent events[EVLOG_EVENTS_PER_BLOCK];
+};
+
+// 二進位輸出格式版本
+#define EVLOG_DUMP_VERSION 1
+
+static Preferences logPrefs;
+static bool logReady = false;
+static uint16_t bootCount = 0;
+
+static LogBlock activeBlock;         // 正在累積的區塊
+static bool activeDirty = false;     // activeBlock 有尚未寫入的事件
+static unsigned long dirtySince = 0;
+
+static LogBlock fullBlock;           // 已寫滿、等待寫入的區塊
+static bool fullPending = false;
+
+static unsigned long lastWriteTime = 0;
+static bool everWritten = false;
+static uint16_t droppedEvents = 0;   // 寫入速度跟不上而丟棄的事件數
+
+static void blockKey(uint32_t seq, char *key) {
+  snprintf(key, 4, "b%02u", (unsigned)(seq % EVLOG_BLOCKS));
+}
+
+static bool readBlock(uint32_t seq, LogBlock &block) {
+  char key[4];
+  blockKey(seq, key);
+  if (logPrefs.getBytes(key, &block, sizeof(LogBlock)) != sizeof(LogBlock)) {
+    return false;
+  }
+  return block.seq == seq && block.count <= EVLOG_EVENTS_PER_BLOCK;
+}
+
+static void writeBlock(const LogBlock &block, unsigned long now) {
+  char key[4];
+  blockKey(block.seq, key);
+  logPrefs.putBytes(key, &block, sizeof(LogBlock));
+  lastWriteTime = now;
+  everWritten = true;
+}
+
+static void startBlock(LogBlock &block, uint32_t seq) {
+  memset(&block, 0, sizeof(LogBlock));
+  block.seq = seq;
+}
+
+void eventLogBegin() {
+  if (!logPrefs.begin("evlog", false)) {
+    Serial.println("⚠️  事件紀錄：NVS 開啟失敗，本次不保存紀錄");
+    return;
+  }
+
+  bootCount = logPrefs.getUShort("boot", 0) + 1;
+  logPrefs.putUShort("boot", bootCount);
+
+  // 找出序號最大的區塊，從它接著寫
+  LogBlock block;
+  uint32_t newestSeq = 0;
+  for (uint32_t slot = 0; slot < EVLOG_BLOCKS; slot++) {
+    char key[4];
+    blockKey(slot, key);
+    if (logPrefs.getBytes(key, &block, sizeof(LogBlock)) == sizeof(LogBlock) &&
+        block.seq > newestSeq && block.count <= EVLOG_EVENTS_PER_BLOCK) {
+      newestSeq = block.seq;
+    }
+  }
+
+  if (newestSeq == 0) {
+    startBlock(activeBlock, 1);
+  } else if (readBlock(newestSeq, activeBlock) && activeBlock.count < EVLOG_EVENTS_PER_BLOCK) {
+    // 上次未寫滿，繼續使用同一區塊
+  } else {
+    startBlock(activeBlock, newestSeq + 1);
+  }
+
+  logReady = true;
+  eventLogRecord(LOG_BOOT, (uint8_t)esp_reset_reason());
+
+  Serial.print("📒 事件紀錄：第 ");
+  Serial.print(bootCount);
+  Serial.print(" 次開機，目前區塊 #");
+  Serial.println(activeBlock.seq);
+}
+
+void eventLogRecord(LogEventType type, uint8_t arg) {
+  if (!logReady) return;
+
+  if (activeBlock.count >= EVLOG_EVENTS_PER_BLOCK) {
+    // 兩個區塊都滿了，寫入還在限流中
+    droppedEvents++;
+    return;
+  }
+
+  LogEvent &event = activeBlock.events[activeBlock.count++];
+  event.boot = bootCount;
+  event.type = type;
+  event.arg = arg;
+  event.ms = millis();
+
+  if (!activeDirty) {
+    activeDirty = true;
+    dirtySince = event.ms;
+  }
+
+  // 區塊寫滿：交給 fullBlock 等待寫入，開新區塊
+  if (activeBlock.count == EVLOG_EVENTS_PER_BLOCK && !fullPending) {
+    fullBlock = activeBlock;
+    fullPending = true;
+    startBlock(activeBlock, fullBlock.seq + 1);
+    activeDirty = false;
+  }
+}
+
+void eventLogService(unsigned long now) {
+  if (!logReady) return;
+  if (everWritten && now - lastWriteTime < EVLOG_MIN_WRITE_INTERVAL_MS) return;
+
+  // 每次最多寫一個區塊
+  if (fullPending) {
+    writeBlock(fullBlock, now);
+    fullPending = false;
+
+    // 寫入期間 activeBlock 也滿了，立即接手
+    if (activeBlock.count == EVLOG_EVENTS_PER_BLOCK) {
+      fullBlock = activeBlock;
+      fullPending = true;
+      startBlock(activeBlock, fullBlock.seq + 1);
+      activeDirty = false;
+    }
+    return;
+  }
+
+  if (activeDirty && now - dirtySince >= EVLOG_FLUSH_INTERVAL_MS) {
+    writeBlock(activeBlock, now);
+    activeDirty = false;
+  }
+}
+
+// 依序號取得區塊內容（RAM 中的版本優先於 NVS）
+static bool loadBlock(uint32_t seq, LogBlock &block) {
+  if (seq == activeBlock.seq) {
+    block = activeBlock;
+    return true;
+  }
+  if (fullPending && seq == fullBlock.seq) {
+    block = fullBlock;
+    return true;
+  }
+  return readBlock(seq, block);
+}
+
+// 輸出格式：
+//   "#EVLOG\n"
+//   標頭 12 bytes："FTBL"、版本(1)、單筆大小(1)、筆數(2)、開機次數(2)、丟棄數(2)
+//   事件 N × 8 bytes
+//   CRC-32(4)，涵蓋標頭與事件
+//   "\n"
+void eventLogDump(Print &out) {
+  if (!logReady) {
+    out.println("⚠️  事件紀錄未啟用");
+    return;
+  }
+
+  uint32_t newestSeq = activeBlock.seq;
+  uint32_t oldestSeq = newestSeq >= EVLOG_BLOCKS ? newestSeq - EVLOG_BLOCKS + 1 : 1;
+
+  // 第一輪：計算筆數
+  LogBlock block;
+  uint16_t total = 0;
+  for (uint32_t seq = oldestSeq; seq <= newestSeq; seq++) {
+    if (loadBlock(seq, block)) total += block.count;
+  }
+
+  uint8_t header[12] = {'F', 'T', 'B', 'L', EVLOG_DUMP_VERSION, sizeof(LogEvent)};
+  header[6] = total & 0xFF;
+  header[7] = total >> 8;
+  header[8] = bootCount & 0xFF;
+  header[9] = bootCount >> 8;
+  header[10] = droppedEvents & 0xFF;
+  header[11] = droppedEvents >> 8;
+
+  out.print("#EVLOG\n");
+  out.write(header, sizeof(header));
+  uint32_t crc = crc32Update(0, header, sizeof(header));
+
+  // 第二輪：依時間順序輸出事件
+  for (uint32_t seq = oldestSeq; seq <= newestSeq; seq++) {
+    if (!loadBlock(seq, block)) continue;
+    const uint8_t *bytes = (const uint8_t *)block.events;
+    size_t len = block.count * sizeof(LogEvent);
+    out.write(bytes, len);
+    crc = crc32Update(crc, bytes, len);
+  }
+
+  uint8_t trailer[4] = {(uint8_t)crc, (uint8_t)(crc >> 8), (uint8_t)(crc >> 16), (uint8_t)(crc >> 24)};
+  out.write(trailer, sizeof(trailer));
+  out.print("\n");
+}
+
+void eventLogClear() {
+  if (!logReady) return;
+  logPrefs.clear();
+  logPrefs.putUShort("boot", bootCount);
+  startBlock(activeBlock, 1);
+  activeDirty = false;
+  fullPending = false;
+  droppedEvents = 0;
+  Serial.println("🗑️  事件紀錄已清除");
+}
+
+uint16_t eventLogBootCount() {
+  return bootCount;
+}
@@ -0,0 +1,57 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <Arduino.h>
+
+// ========== 事件紀錄（NVS 持久化）==========
+// 任務完成、抽籤結果與播放的音檔會寫入 nvs 分區，重開機後仍保留。
+//
+// 寫入策略（控制快閃記憶體抹除次數）：
+//   - 事件先累積在 RAM 區塊（每區塊 EVLOG_EVENTS_PER_BLOCK 筆）
+//   - 區塊寫滿立即排入寫入；未滿的區塊最多等 EVLOG_FLUSH_INTERVAL_MS 才寫
+//   - 任兩次寫入至少間隔 EVLOG_MIN_WRITE_INTERVAL_MS，事件再多也不會更頻繁
+//   - 區塊以 seq % EVLOG_BLOCKS 輪流覆寫，最舊的紀錄自動淘汰
+//   - NVS 本身是 log 結構，寫入會分散到各頁，不會一直抹除同一個 sector
+// 最壞情況每 2 秒寫一次 136 bytes，約 50 秒才寫滿一頁（4KB）；
+// 一般使用一天只有數十筆事件，幾乎不會觸發抹除。
+
+#define EVLOG_EVENTS_PER_BLOCK 16
+#define EVLOG_BLOCKS 16                  // 共保留 256 筆事件（約 2.2KB）
+#define EVLOG_FLUSH_INTERVAL_MS 60000    // 未滿區塊最久 60 秒寫入一次
+#define EVLOG_MIN_WRITE_INTERVAL_MS 2000 // 兩次寫入的最短間隔
+
+// 事件類型（會寫入快閃記憶體，數值不可更改）
+enum LogEventType : uint8_t {
+  LOG_BOOT = 1,              // 開機（arg = 重置原因）
+  LOG_TASK_TOGGLE = 2,       // 任務按鈕切換（arg = 顏色 0紅/1綠/2藍，bit7 = 開啟）
+  LOG_LOTTERY_OPEN = 3,      // 三燈全亮，開放抽籤
+  LOG_LOTTERY_DRAW = 4,      // 黃色按鈕抽籤（arg = 類別 << 4 | 編號）
+  LOG_CLIP_PLAYED = 5,       // 開始播放音檔（arg 同上）
+  LOG_LOTTERY_TIMEOUT = 6,   // 抽籤逾時失效
+  LOG_PLAYBACK_SKIPPED = 7,  // 藍牙未連接或無音檔，跳過播放
+  LOG_CLIP_QUEUED = 8,       // 藍牙重新連線中，音檔排隊等待播放（arg 同 LOG_LOTTERY_DRAW）
+  LOG_BT_LINK = 9            // 藍牙連線變化（arg = 1 連線 / 0 斷線）
+};
+
+// 音檔類別（用於 LOG_LOTTERY_DRAW / LOG_CLIP_PLAYED 的 arg）
+#define LOG_CLIP_DAD 0
+#define LOG_CLIP_MOM 1
+#define LOG_CLIP_SX 2
+#define LOG_CLIP_UNKNOWN 0xFF
+
+// 單筆事件（8 bytes，小端序）
+struct __attribute__((packed)) LogEvent {
+  uint16_t boot;   // 第幾次開機
+  uint8_t type;    // LogEventType
+  uint8_t arg;     // 依類型而定
+  uint32_t ms;     // 該次開機後的毫秒數
+};
+
+void eventLogBegin();
+void eventLogRecord(LogEventType type, uint8_t arg = 0);
+void eventLogService(unsigned long now);  // 在 loop() 中呼叫，依批次策略寫入
+void eventLogDump(Print &out);            // 以二進位格式輸出（見 tools/decode_event_log.py）
+void eventLogClear();
+uint16_t eventLogBootCount();
+
+#endif
@@ -0,0 +1,150 @@
+#include "heap_watch.h"
+#include <esp_heap_caps.h>
+#include <stdarg.h>
+
+#define HEAP_CAPS MALLOC_CAP_8BIT  // 一般 malloc 使用的記憶體
+
+struct HeapSample {
+  uint32_t freeBytes;
+  uint32_t largestBlock;
+};
+
+static HeapSample baseline = {0, 0};      // setup() 結束時
+static HeapSample latest = {0, 0};
+static uint32_t lowestLargest = 0xFFFFFFFF;
+static unsigned long lowestLargestAt = 0;  // millis()
+static uint32_t samples = 0;
+static unsigned long lastSampleAt = 0;
+static bool lowBlockWarned = false;
+
+#if HEAP_STRICT
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// 只記錄 loop task 的配置，在 malloc 內不能印序列埠，留到 heapWatchSample() 再回報
+static TaskHandle_t watchedTask = NULL;
+static volatile uint32_t loopAllocs = 0;
+static volatile uint32_t lastAllocSize = 0;
+static void *volatile lastAllocCaller = NULL;
+static uint32_t reportedAllocs = 0;
+
+static inline void noteAlloc(size_t size, void *caller) {
+  if (watchedTask != NULL && xTaskGetCurrentTaskHandle() == watchedTask) {
+    loopAllocs++;
+    lastAllocSize = size;
+    lastAllocCaller = caller;
+  }
+}
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+  noteAlloc(size, __builtin_return_address(0));
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  noteAlloc(count * size, __builtin_return_address(0));
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  noteAlloc(size, __builtin_return_address(0));
+  return __real_realloc(ptr, size);
+}
+}
+#endif
+
+static HeapSample takeSample() {
+  HeapSample sample;
+  sample.freeBytes = heap_caps_get_free_size(HEAP_CAPS);
+  sample.largestBlock = heap_caps_get_largest_free_block(HEAP_CAPS);
+  return sample;
+}
+
+static void recordSample(unsigned long now) {
+  latest = takeSample();
+  samples++;
+  if (latest.largestBlock < lowestLargest) {
+    lowestLargest = latest.largestBlock;
+    lowestLargestAt = now;
+  }
+}
+
+void heapWatchBegin() {
+  unsigned long now = millis();
+  recordSample(now);
+  baseline = latest;
+  lastSampleAt = now;
+#if HEAP_STRICT
+  watchedTask = xTaskGetCurrentTaskHandle();
+#endif
+}
+
+void heapWatchSample(unsigned long now) {
+  if (samples == 0 || now - lastSampleAt < HEAP_SAMPLE_INTERVAL_MS) {
+    return;
+  }
+  lastSampleAt = now;
+  recordSample(now);
+
+  // 跌破門檻時警告一次，回升後才會再警告
+  if (latest.largestBlock < HEAP_LOW_BLOCK) {
+    if (!lowBlockWarned) {
+      printfNoAlloc(Serial, "⚠️  heap 最大連續區塊只剩 %lu bytes（可用 %lu bytes）\n",
+                            (unsigned long)latest.largestBlock, (unsigned long)latest.freeBytes);
+    }
+    lowBlockWarned = true;
+  } else {
+    lowBlockWarned = false;
+  }
+
+#if HEAP_STRICT
+  uint32_t allocs = loopAllocs;
+  if (allocs != reportedAllocs) {
+    printfNoAlloc(Serial, "⚠️  loop() 配置了記憶體 %lu 次（最後一次 %lu bytes，呼叫位置 %p）\n",
+                          (unsigned long)(allocs - reportedAllocs), (unsigned long)lastAllocSize, lastAllocCaller);
+    reportedAllocs = allocs;
+  }
+#endif
+}
+
+// 碎片化程度：可用空間中不屬於最大連續區塊的比例
+static unsigned fragmentPercent(const HeapSample &sample) {
+  if (sample.freeBytes == 0) return 0;
+  return 100 - (unsigned)((uint64_t)sample.largestBlock * 100 / sample.freeBytes);
+}
+
+void heapWatchPrintStats(Print &out) {
+  out.println("【記憶體】");
+  if (samples == 0) {
+    out.println("  還沒有資料");
+    return;
+  }
+
+  HeapSample now = takeSample();
+  printfNoAlloc(out, "  可用 %lu bytes，最大連續區塊 %lu bytes（碎片 %u%%）\n",
+                     (unsigned long)now.freeBytes, (unsigned long)now.largestBlock, fragmentPercent(now));
+  printfNoAlloc(out, "  開機後最低可用 %lu bytes\n", (unsigned long)heap_caps_get_minimum_free_size(HEAP_CAPS));
+  printfNoAlloc(out, "  最大連續區塊最小 %lu bytes（開機後 %lu 秒，共取樣 %lu 次）\n",
+                     (unsigned long)lowestLargest, lowestLargestAt / 1000, (unsigned long)samples);
+  printfNoAlloc(out, "  setup() 結束時：可用 %lu bytes，最大連續區塊 %lu bytes\n",
+                     (unsigned long)baseline.freeBytes, (unsigned long)baseline.largestBlock);
+#if HEAP_STRICT
+  printfNoAlloc(out, "  setup() 之後 loop() 配置記憶體 %lu 次\n", (unsigned long)loopAllocs);
+#endif
+}
+
+size_t printfNoAlloc(Print &out, const char *format, ...) {
+  static char buffer[HEAP_PRINT_BUFFER];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (len < 0) return 0;
+  if ((size_t)len >= sizeof(buffer)) len = sizeof(buffer) - 1;
+  return out.write((const uint8_t *)buffer, len);
+}
@@ -0,0 +1,41 @@
+#ifndef HEAP_WATCH_H
+#define HEAP_WATCH_H
+
+#include <Arduino.h>
+
+// ========== heap 使用量監測 ==========
+// 應用程式自己的資料只在 setup() 時配置（檔名等從固定配置區切出，見 static_arena.h），
+// 但 loop task 仍有幾個已知會使用 heap 的地方（嚴格模式的紀錄可以對照這份清單）：
+//   - SPIFFS/LittleFS 開啟音檔（抽籤、預讀、播放）：fs.open() 配置 FileImpl 與 newlib 的 FILE 緩衝區，
+//     關檔時釋放（raw 分區後端開檔不配置，但 mapClip() 映射時 ESP-IDF 會暫時配置頁面清單）
+//   - NVS 寫入：事件紀錄（eventLogService()）、記住喇叭（bt_link.cpp 的 saveSpeaker()）
+//   - 序列埠上傳音檔：寫入暫存檔、取代舊檔、結束後重新掃描音檔列表
+// 藍牙 A2DP 堆疊、WiFi/BT 驅動等其他 task 也會使用 heap。每 HEAP_SAMPLE_INTERVAL_MS 取樣一次：
+// 可用空間、開機後最低可用空間（ESP-IDF 記錄的真正最低值）、最大連續區塊。
+// 可用空間還夠、最大連續區塊卻一直變小，就是碎片化；長時間運作的機器用序列埠指令 M 檢查。
+//
+// 嚴格模式（env:esp32dev_heap_strict，-DHEAP_STRICT=1 並以 -Wl,--wrap 包住 malloc/calloc/realloc）：
+// 記錄 setup() 結束後 loop task 的每一次配置（次數、最後一次的大小與呼叫位置），
+// 呼叫位置可用 addr2line 對照 .elf 找出原始碼。藍牙等其他 task 的配置不計。
+
+#ifndef HEAP_STRICT
+#define HEAP_STRICT 0
+#endif
+
+#define HEAP_SAMPLE_INTERVAL_MS 10000  // 取樣間隔（最大連續區塊需要走訪 heap，不每次 loop() 都做）
+#define HEAP_LOW_BLOCK 8192            // 最大連續區塊低於這個值時警告（藍牙封包緩衝區需要連續空間）
+#define HEAP_PRINT_BUFFER 256          // printfNoAlloc() 的格式化緩衝區，超過的部分截掉
+
+// setup() 結束時呼叫：記錄基準值，嚴格模式從這裡開始計算 loop task 的配置
+void heapWatchBegin();
+
+// 每次 loop() 呼叫，內部依 HEAP_SAMPLE_INTERVAL_MS 取樣
+void heapWatchSample(unsigned long now);
+
+void heapWatchPrintStats(Print &out);
+
+// 不配置記憶體的 printf：Print::printf() 輸出超過 64 bytes 時會 malloc 暫存緩衝區，
+// 這裡改為格式化到固定緩衝區再 write()。緩衝區只有一個，只能在 loop task 使用。
+size_t printfNoAlloc(Print &out, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+#endif
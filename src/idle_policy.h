@@ -0,0 +1,40 @@
+#ifndef IDLE_POLICY_H
+#define IDLE_POLICY_H
+
+// ========== 閒置判斷（是否可以進入 light sleep）==========
+
+#define IDLE_QUIET_MS 5000  // 最後一次操作後，需安靜多久才休眠
+
+// 判斷所需的系統狀態（由 loop() 收集）
+struct IdleInputs {
+  unsigned long now;
+  unsigned long lastActivity;  // 最後一次按鈕操作或狀態變化的時間
+  bool normalState;            // 是否在 NORMAL 模式（LOTTERY 有燈光動畫）
+  bool playing;                // 是否正在播放音檔
+  bool buttonHeld;             // 是否有按鈕仍被按著（會立刻喚醒）
+  bool linkActive;             // 藍牙連線中（Classic BT 在 light sleep 期間無法維持連線）
+  bool ledsSteady;             // 燈光只有全亮/全暗，不需要 PWM 波形
+};
+
+// 判斷結果（非 IDLE_SLEEP 時表示被什麼擋住）
+enum IdleDecision {
+  IDLE_SLEEP,
+  IDLE_BUSY_STATE,
+  IDLE_BUSY_PLAYING,
+  IDLE_BUSY_BUTTON,
+  IDLE_BUSY_LINK,
+  IDLE_BUSY_PWM,
+  IDLE_BUSY_RECENT
+};
+
+inline IdleDecision idleDecide(const IdleInputs &in, unsigned long quietMs = IDLE_QUIET_MS) {
+  if (!in.normalState) return IDLE_BUSY_STATE;
+  if (in.playing) return IDLE_BUSY_PLAYING;
+  if (in.buttonHeld) return IDLE_BUSY_BUTTON;
+  if (in.linkActive) return IDLE_BUSY_LINK;
+  if (!in.ledsSteady) return IDLE_BUSY_PWM;
+  if (in.now - in.lastActivity < quietMs) return IDLE_BUSY_RECENT;
+  return IDLE_SLEEP;
+}
+
+#endif
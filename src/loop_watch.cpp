@@ -0,0 +1,118 @@
+#include "loop_watch.h"
+#include "heap_watch.h"
+
+#if LOOP_WATCH
+
+#include <esp_timer.h>
+
+static int64_t iterationStartUs = 0;
+
+static uint32_t histogram[LOOP_WATCH_BUCKETS];
+static uint32_t iterations = 0;
+static uint64_t totalUs = 0;
+
+static uint32_t maxStallUs = 0;
+static const char *maxStallState = "";
+static unsigned long maxStallAt = 0;     // millis()
+
+static uint32_t deadlineMisses = 0;
+static unsigned long lastAlarmAt = 0;
+static bool alarmed = false;
+
+static uint8_t bucketOf(uint32_t us) {
+  uint32_t scaled = us >> 8;
+  if (scaled == 0) return 0;
+  uint8_t bucket = 32 - __builtin_clz(scaled);
+  return bucket < LOOP_WATCH_BUCKETS ? bucket : LOOP_WATCH_BUCKETS - 1;
+}
+
+void loopWatchStart() {
+  iterationStartUs = esp_timer_get_time();
+}
+
+void loopWatchEnd(const char *state) {
+  if (iterationStartUs == 0) return;
+  uint32_t us = (uint32_t)(esp_timer_get_time() - iterationStartUs);
+  iterationStartUs = 0;
+
+  histogram[bucketOf(us)]++;
+  iterations++;
+  totalUs += us;
+
+  if (us > maxStallUs) {
+    maxStallUs = us;
+    maxStallState = state;
+    maxStallAt = millis();
+  }
+
+  if (us >= (uint32_t)LOOP_DEADLINE_MS * 1000) {
+    deadlineMisses++;
+    unsigned long now = millis();
+    if (!alarmed || now - lastAlarmAt >= LOOP_ALARM_INTERVAL_MS) {
+      alarmed = true;
+      lastAlarmAt = now;
+      printfNoAlloc(Serial, "⚠️  loop() 卡住 %lu ms（%s，期限 %d ms）\n", (unsigned long)(us / 1000), state,
+                            LOOP_DEADLINE_MS);
+    }
+  }
+}
+
+// 時間長度，例如 512us、16ms、2.1s
+static void printDuration(Print &out, uint32_t us) {
+  if (us < 1000) {
+    printfNoAlloc(out, "%luus", (unsigned long)us);
+  } else if (us < 1000000) {
+    printfNoAlloc(out, "%lums", (unsigned long)((us + 500) / 1000));
+  } else {
+    printfNoAlloc(out, "%.1fs", us / 1000000.0);
+  }
+}
+
+// 直方圖一格的範圍，例如「2ms-4ms」
+static void printBucketRange(Print &out, uint8_t bucket) {
+  uint32_t lowUs = bucket == 0 ? 0 : 256UL << (bucket - 1);
+  out.print("  ");
+  if (bucket == LOOP_WATCH_BUCKETS - 1) {
+    out.print("≥");
+    printDuration(out, lowUs);
+    return;
+  }
+  printDuration(out, lowUs);
+  out.print("-");
+  printDuration(out, 256UL << bucket);
+}
+
+void loopWatchPrintStats(Print &out) {
+  out.println("【loop() 延遲】");
+  if (iterations == 0) {
+    out.println("  還沒有資料");
+    return;
+  }
+
+  printfNoAlloc(out, "  %lu 次，平均 %lu us\n", (unsigned long)iterations, (unsigned long)(totalUs / iterations));
+  printfNoAlloc(out, "  最長 %lu ms（%s，開機後 %lu 秒）\n", (unsigned long)(maxStallUs / 1000), maxStallState,
+                     maxStallAt / 1000);
+  printfNoAlloc(out, "  超過期限 %d ms：%lu 次\n", LOOP_DEADLINE_MS, (unsigned long)deadlineMisses);
+
+  // 只印有資料的範圍，長條以最多的一格為 30 格
+  uint8_t first = LOOP_WATCH_BUCKETS;
+  uint8_t last = 0;
+  uint32_t peak = 0;
+  for (uint8_t i = 0; i < LOOP_WATCH_BUCKETS; i++) {
+    if (histogram[i] == 0) continue;
+    if (first == LOOP_WATCH_BUCKETS) first = i;
+    last = i;
+    if (histogram[i] > peak) peak = histogram[i];
+  }
+  for (uint8_t i = first; i <= last; i++) {
+    printBucketRange(out, i);
+    printfNoAlloc(out, "\t%8lu", (unsigned long)histogram[i]);
+    int bar = (int)((uint64_t)histogram[i] * 30 / peak);
+    if (bar == 0 && histogram[i] > 0) bar = 1;
+    if (bar > 0) out.print(' ');
+    for (int j = 0; j < bar; j++) out.print('#');
+    out.println();
+  }
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef LOOP_WATCH_H
+#define LOOP_WATCH_H
+
+#include <Arduino.h>
+
+// ========== loop() 延遲監測 ==========
+// 量測每次 loop() 實際做事的時間（不含結尾的 delay(10) 與 light sleep），
+// 記錄成對數分桶的直方圖、最長的一次卡住（與當時的狀態），
+// 超過軟期限 LOOP_DEADLINE_MS 時計數並在序列埠警告（最多每 LOOP_ALARM_INTERVAL_MS 一次）。
+// 序列埠指令 D 顯示統計。
+//
+// 正式版本用 -DLOOP_WATCH=0 編譯（env:esp32dev_release），所有呼叫都是空的 inline 函式，
+// 不佔記憶體也不耗時間。
+
+#ifndef LOOP_WATCH
+#define LOOP_WATCH 1
+#endif
+
+#ifndef LOOP_DEADLINE_MS
+#define LOOP_DEADLINE_MS 100         // 軟期限：超過就算卡住
+#endif
+#define LOOP_ALARM_INTERVAL_MS 5000  // 警告訊息的最短間隔（避免序列埠輸出本身拖慢 loop()）
+
+// 直方圖：第 0 格 < 256us，之後每格加倍（256-512us、512us-1ms、…），最後一格 ≥ 16.8 秒
+#define LOOP_WATCH_BUCKETS 18
+
+#if LOOP_WATCH
+
+void loopWatchStart();                 // loop() 開頭
+void loopWatchEnd(const char *state);  // 休眠 / delay() 之前，state 為目前的狀態名稱（字串常數）
+void loopWatchPrintStats(Print &out);
+
+#else
+
+inline void loopWatchStart() {}
+inline void loopWatchEnd(const char *state) {}
+inline void loopWatchPrintStats(Print &out) {
+  out.println("（這個版本沒有啟用 loop() 延遲監測，LOOP_WATCH=0）");
+}
+
+#endif
+
+#endif
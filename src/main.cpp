@@ -1,41 +1,91 @@
 #include <Arduino.h>
-#include <SPIFFS.h>
 #include "BluetoothA2DPSource.h"
+#include "event_log.h"
+#include "power_idle.h"
+#include "cpu_scaling.h"
+#include "bt_link.h"
+#include "boot_timeline.h"
+#include "clip_storage.h"
+#include "clip_meta.h"
+#include "playback_source.h"
+#include "ws2812_strip.h"
+#include "color16.h"
+#include "timer_wheel.h"
+#include "loop_watch.h"
+#include "heap_watch.h"
+#include "static_arena.h"
+#include "task_layout.h"
+#include "serial_upload.h"
+#include "voice_prompt.h"
+#include "audio_pipeline.h"
+#include "audio_events.h"
+#include <esp_timer.h>
 
 // 藍牙 A2DP Source
 BluetoothA2DPSource a2dp_source;
 
-// 音檔資訊
-File audioFile;
+// 音檔資訊（儲存後端見 clip_storage.h，音源見 playback_source.h）
+PlaybackSource<ClipReader> playbackSource;
 bool audioFileReady = false;
-bool isPlaying = false;
 
-// 音檔列表（依類別分類）
-String dadFiles[10];   // Dad 系列音檔
-String momFiles[10];   // Mom 系列音檔
-String sxFiles[10];    // SX 系列音檔
+// 播放狀態：loop() 開始播放、A2DP 回調播完時改變（兩個 task 同時存取）
+// playbackToken = 播放編號 << 1 | 是否為音檔，beginPlayback() 在 isPlaying 設為 true 之前寫入
+std::atomic<bool> isPlaying{false};
+std::atomic<uint32_t> playbackToken{0};
+uint16_t playbackId = 0;  // loop() 每次換音源遞增
+AudioEventChannel<AUDIO_EVENT_QUEUE> audioEvents;
+
+// 音檔列表（依類別分類），檔名（含 / 前綴）在 scanAudioFiles() 時從 appArena 切出
+#define CLIPS_PER_CATEGORY 10
+const char *dadFiles[CLIPS_PER_CATEGORY];   // Dad 系列音檔
+const char *momFiles[CLIPS_PER_CATEGORY];   // Mom 系列音檔
+const char *sxFiles[CLIPS_PER_CATEGORY];    // SX 系列音檔
 int dadCount = 0;
 int momCount = 0;
 int sxCount = 0;
 
+// 應用程式的配置區：setup() 結束後 seal()，loop() 不再從這裡配置（見 static_arena.h、heap_watch.h）
+#define APP_ARENA_SIZE (3 * CLIPS_PER_CATEGORY * (CLIP_NAME_LEN + 1))
+StaticArena<APP_ARENA_SIZE> appArena;
+
 // WAV 檔案標頭資訊（跳過前 44 bytes）
 const int WAV_HEADER_SIZE = 44;
 
-// 音頻緩衝區（用於提高讀取效能）
+// 音頻回調一次處理一段（取樣本、補齊、重採樣、寫入 Frame，見 audio_pipeline.h）；
+// 樣本由音源 task 讀檔補進環形緩衝區（見 task_layout.h），讀檔另有預讀緩衝區，大小自動調整（見 read_ahead.h）
 #define AUDIO_BUFFER_SIZE 512
-uint8_t audioBuffer[AUDIO_BUFFER_SIZE];
-int bufferIndex = 0;
-int bufferSize = 0;
+#define AUDIO_BLOCK_SAMPLES (AUDIO_BUFFER_SIZE / 2)
 
 // 重採樣參數（8kHz -> 44.1kHz）
 // 採樣率比例：44100 / 8000 = 5.5125
 #define SRC_SAMPLE_RATE 8000
 #define DST_SAMPLE_RATE 44100
-float resamplePosition = 0.0;
-int16_t lastSample = 0;
+AudioPipeline<AUDIO_BLOCK_SAMPLES> audioPipeline(DST_SAMPLE_RATE);
+
+// 合成音效（MML 格式見 synth.h，直接以 44.1kHz 合成，不佔 flash 空間）
+const char *FANFARE_MELODY = "T150 @2 V13 O5 L16 C E G >C8 R16 <G16 >C4.";
+const char *CHIME_ON_MELODY = "T240 @1 V10 O6 L32 C G";
+const char *CHIME_OFF_MELODY = "T240 @1 V8 O6 L32 G C";
+
+// 藍牙連接狀態（由藍牙 task 更新）
+volatile bool bluetoothConnected = false;
+
+// 預先抽好的獎勵音檔（見 warmRewardClip()）
+const char *rewardClip = NULL;  // NULL 表示還沒抽
+bool rewardReady = false;    // 已開檔並讀好開頭，等待播放
+
+// 按下黃色按鈕到第一個有聲音的樣本（音頻回調中量測）
+// rewardPressPending 由 loop() 以 release 設為 true（之前寫好 rewardPressUs），
+// 回調寫好 rewardLatencyUs 後以 release 清除，loop() 用 acquire 讀到 false 時一定看得到延遲
+#define AUDIBLE_LEVEL 64     // 超過這個振幅算有聲音（約 -54 dBFS）
+std::atomic<bool> rewardPressPending{false};
+uint32_t rewardPressUs = 0;
+uint32_t rewardLatencyUs = 0;
 
-// 藍牙連接狀態
-bool bluetoothConnected = false;
+// 重新連線期間抽中的音檔，連線後自動播放
+const char *pendingClip = NULL;
+unsigned long pendingClipTime = 0;
+#define PENDING_CLIP_TIMEOUT 300000  // 排隊最多 5 分鐘
 
 // 定義5個按鈕接腳（B側 - 輸入）
 #define BUTTON_1 13  // B5 - 黃色按鈕（直接觸發抽籤）
@@ -45,6 +95,7 @@ bool bluetoothConnected = false;
 #define BUTTON_5 32  // B13 - 藍色按鈕（控制藍燈）
 
 // 定義RGB燈條接腳（I側 - 輸出）
+// 改用 WS2812 燈條時見 ws2812_strip.h（LED_OUTPUT、WS2812_PIN、WS2812_COUNT）
 #define RGB_R_PIN 16  // I8 - 紅色
 #define RGB_G_PIN 17  // I9 - 綠色
 #define RGB_B_PIN 5   // I10 - 藍色
@@ -55,8 +106,18 @@ bool bluetoothConnected = false;
 #define PWM_CHANNEL_B 2
 
 // PWM設定
+// 高解析度模式：build_flags -DLED_PWM_BITS=13（12-14），燈光以 16-bit 計算後時間抖動輸出
+#ifndef LED_PWM_BITS
+#define LED_PWM_BITS 8
+#endif
+#define PWM_RESOLUTION LED_PWM_BITS  // 預設 8位元解析度 (0-255)
+#if PWM_RESOLUTION >= 14
+#define PWM_FREQ 4000      // 14位元時 LEDC 最高約 4.8kHz
+#else
 #define PWM_FREQ 5000      // PWM頻率 5kHz
-#define PWM_RESOLUTION 8   // 8位元解析度 (0-255)
+#endif
+#define PWM_HIRES (PWM_RESOLUTION > 8 && LED_OUTPUT != LED_OUTPUT_WS2812)
+#define LED_DITHER_HZ 1000  // 抖動更新頻率（每秒輸出次數）
 
 // 按鈕防彈跳時間（毫秒）
 #define DEBOUNCE_DELAY 50
@@ -72,31 +133,151 @@ bool lastButton3State = LOW;  // 紅色按鈕
 bool lastButton4State = LOW;  // 綠色按鈕
 bool lastButton5State = LOW;  // 藍色按鈕
 
-// 燈光秀狀態
-enum ShowState {
-  NORMAL,           // 正常模式
-  WAITING,          // 等待3秒
-  LIGHT_SHOW,       // 燈光秀進行中
-  LOTTERY           // 抽籤播放
+// ========== 狀態機 ==========
+// 狀態轉換寫在 transitions[] 表中（見 dispatchEvent()），
+// 逾時用計時輪（timer_wheel.h）觸發，不在每次 loop() 比較 millis()。
+// 新增狀態：加到 AppState、stateHandlers[]，再把進出的事件加到 transitions[]。
+enum AppState {
+  NORMAL,           // 正常模式：按鈕切換三燈
+  LOTTERY,          // 抽籤階段：燈光秀 + 等待黃色按鈕（限時1分鐘）
+  PLAYING,          // 播放抽中的音檔：播完（或逾時）才重置三燈
+  STATE_COUNT
 };
 
-ShowState currentState = NORMAL;
-unsigned long stateStartTime = 0;
+enum AppEvent {
+  EVENT_ALL_LIGHTS_ON,    // 三燈剛剛全亮
+  EVENT_DRAW,             // 抽籤階段按下黃色按鈕
+  EVENT_LOTTERY_TIMEOUT,  // 抽籤時間到
+  EVENT_PLAYBACK_DONE     // 抽中的音檔播完（或播放逾時）
+};
+
+AppState currentState = NORMAL;
+const char *const stateNames[STATE_COUNT] = {"NORMAL", "LOTTERY", "PLAYING"};
 bool allLightsWereOn = false;
 
 // 抽獎狀態追蹤
-unsigned long lotteryStartTime = 0;  // 抽獎開始時間（燈光秀結束）
-bool lotteryAvailable = false;       // 是否在抽獎時間內（1分鐘內）
-bool lotteryUsed = false;             // 是否已經抽過籤
+unsigned long lotteryStartTime = 0;  // 抽獎開始時間（燈光秀動畫的起點）
 
 // 抽獎限時（1分鐘 = 60000毫秒）
 #define LOTTERY_TIMEOUT 60000
+#define LOTTERY_COUNTDOWN_INTERVAL 10000  // 每10秒顯示剩餘時間
+#define PLAYBACK_TIMEOUT 30000            // 抽中的音檔最多等30秒（沒收到播完事件也回到正常模式）
+
+// 這次抽籤的播放（PLAYING 結束時印出延遲用）
+bool drawPlayed = false;    // 有播放抽中的音檔（排隊或跳過時為 false）
+bool drawPrepared = false;  // 播放的是預讀好的音檔
+
+// 計時輪：10ms 一格、64 格（一圈 640ms，較長的計時器多繞幾圈）
+TimerWheel<64, 10> appTimers;
+WheelTimer lotteryTimeoutTimer;
+WheelTimer lotteryCountdownTimer;
+WheelTimer playbackTimeoutTimer;
+void onLotteryTimeout(void *arg);    // 定義在 loop() 前的狀態機區段
+void onLotteryCountdown(void *arg);
+void onPlaybackTimeout(void *arg);
+void dispatchEvent(AppEvent event);
+
+// 閒置省電：最後一次操作時間
+unsigned long lastActivityTime = 0;
+
+// 目前燈光輸出（休眠前後還原用）
+int ledRed = 0;
+int ledGreen = 0;
+int ledBlue = 0;
+
+#if PWM_HIRES
+// 高解析度模式：目標亮度（16-bit 線性），由計時器以時間抖動寫入 LEDC
+volatile uint16_t ledLevels[3] = {0, 0, 0};
+esp_timer_handle_t ditherTimer = NULL;
+
+void ditherTimerCallback(void *arg) {
+  static const uint8_t channels[3] = {PWM_CHANNEL_R, PWM_CHANNEL_G, PWM_CHANNEL_B};
+  static uint16_t residues[3] = {0, 0, 0};
+  static int lastDuty[3] = {-1, -1, -1};
+  for (int i = 0; i < 3; i++) {
+    int duty = ditherStep(ledLevels[i], PWM_RESOLUTION, residues[i]);
+    if (duty != lastDuty[i]) {
+      ledcWrite(channels[i], (1 << PWM_RESOLUTION) - 1 - duty);  // 共陽極：數值反轉
+      lastDuty[i] = duty;
+    }
+  }
+}
+
+// 設定 16-bit 線性亮度（下一次抖動更新時輸出，最多延遲 1ms）
+void setLedLevels(uint16_t red, uint16_t green, uint16_t blue) {
+  ledLevels[0] = red;
+  ledLevels[1] = green;
+  ledLevels[2] = blue;
+}
+
+void startLedDither() {
+  esp_timer_create_args_t args = {};
+  args.callback = ditherTimerCallback;
+  args.name = "led_dither";
+  esp_timer_create(&args, &ditherTimer);
+  esp_timer_start_periodic(ditherTimer, 1000000 / LED_DITHER_HZ);
+}
+#endif
 
-// RGB燈條控制函數（共陽極設計，數值反轉）
+// RGB燈條控制函數（共陽極設計，數值反轉；WS2812 燈條則整條同色）
 void setRGB(int red, int green, int blue) {
+#if LED_OUTPUT == LED_OUTPUT_WS2812
+  ws2812Fill(red, green, blue);
+  ws2812Show();
+#elif PWM_HIRES
+  setLedLevels(gamma16(red), gamma16(green), gamma16(blue));
+#else
   ledcWrite(PWM_CHANNEL_R, 255 - red);
   ledcWrite(PWM_CHANNEL_G, 255 - green);
   ledcWrite(PWM_CHANNEL_B, 255 - blue);
+#endif
+  ledRed = red;
+  ledGreen = green;
+  ledBlue = blue;
+  idleNoteLedUpdate();
+}
+
+// 燈光是否只有全亮/全暗（休眠時不需要 PWM 波形）
+// WS2812 會自己保持顏色，只要沒有畫面正在傳送就可以休眠
+bool ledsSteady() {
+#if LED_OUTPUT == LED_OUTPUT_WS2812
+  return ws2812Idle();
+#else
+  return (ledRed == 0 || ledRed == 255) &&
+         (ledGreen == 0 || ledGreen == 255) &&
+         (ledBlue == 0 || ledBlue == 255);
+#endif
+}
+
+// 休眠前：LEDC 在 light sleep 時會停止，改用 GPIO 固定電位維持燈光
+// （WS2812 燈條自己會保持顏色，不需要處理）
+void holdLedsForSleep() {
+#if LED_OUTPUT != LED_OUTPUT_WS2812
+  const uint8_t pins[3] = {RGB_R_PIN, RGB_G_PIN, RGB_B_PIN};
+  const int levels[3] = {ledRed, ledGreen, ledBlue};
+  for (int i = 0; i < 3; i++) {
+    ledcDetachPin(pins[i]);
+    pinMode(pins[i], OUTPUT);
+    digitalWrite(pins[i], levels[i] == 255 ? LOW : HIGH);  // 共陽極：LOW = 亮
+  }
+#endif
+}
+
+// 喚醒後：接回 LEDC 並還原休眠前的輸出
+void restoreLedsAfterSleep() {
+#if PWM_HIRES
+  // 抖動計時器持續寫入 duty，接回腳位即可
+  ledcAttachPin(RGB_R_PIN, PWM_CHANNEL_R);
+  ledcAttachPin(RGB_G_PIN, PWM_CHANNEL_G);
+  ledcAttachPin(RGB_B_PIN, PWM_CHANNEL_B);
+#elif LED_OUTPUT != LED_OUTPUT_WS2812
+  ledcAttachPin(RGB_R_PIN, PWM_CHANNEL_R);
+  ledcAttachPin(RGB_G_PIN, PWM_CHANNEL_G);
+  ledcAttachPin(RGB_B_PIN, PWM_CHANNEL_B);
+  ledcWrite(PWM_CHANNEL_R, 255 - ledRed);
+  ledcWrite(PWM_CHANNEL_G, 255 - ledGreen);
+  ledcWrite(PWM_CHANNEL_B, 255 - ledBlue);
+#endif
 }
 
 // 彩虹色彩計算（輸入0-255，輸出RGB）
@@ -119,167 +300,227 @@ void getRainbowColor(int position, int &r, int &g, int &b) {
   }
 }
 
-// 燈光秀主函數
-void runLightShow(unsigned long elapsedTime) {
-  int r = 0, g = 0, b = 0;
-  
-  if (elapsedTime < 3000) {
-    // 階段1：彩虹循環（0-3秒）
-    int colorPos = (elapsedTime * 256 / 3000) % 256;
-    getRainbowColor(colorPos, r, g, b);
-    
-  } else if (elapsedTime < 6000) {
-    // 階段2：快速彩虹（3-6秒）
-    int colorPos = ((elapsedTime - 3000) * 512 / 3000) % 256;
-    getRainbowColor(colorPos, r, g, b);
-    
-  } else if (elapsedTime < 8000) {
-    // 階段3：頻閃派對模式（6-8秒）
-    if ((elapsedTime / 100) % 2 == 0) {
-      int colorPos = (elapsedTime / 50) % 256;
-      getRainbowColor(colorPos, r, g, b);
-    } else {
-      r = g = b = 0;
-    }
-    
-  } else if (elapsedTime < 10000) {
-    // 階段4：呼吸燈淡出（8-10秒）
-    int fadeTime = elapsedTime - 8000;
-    int brightness = 255 - (fadeTime * 255 / 2000);
-    brightness = max(0, brightness);
-    
-    int colorPos = (elapsedTime / 10) % 256;
-    getRainbowColor(colorPos, r, g, b);
-    r = (r * brightness) / 255;
-    g = (g * brightness) / 255;
-    b = (b * brightness) / 255;
+// 彩虹效果（WS2812 燈條上每顆 LED 依位置錯開色相，整條是一道彩虹；類比燈條整條同色）
+// brightness 為 16-bit（65535 = 全亮），高解析度模式下全程以 16-bit 計算
+void showRainbow(int colorPos, uint16_t brightness) {
+#if LED_OUTPUT == LED_OUTPUT_WS2812
+  PixelColor *pixels = ws2812Pixels();
+  for (int i = 0; i < WS2812_COUNT; i++) {
+    int r, g, b;
+    getRainbowColor(colorPos + i * 256 / WS2812_COUNT, r, g, b);
+    pixels[i].r = r;
+    pixels[i].g = g;
+    pixels[i].b = b;
   }
-  
-  setRGB(r, g, b);
+  pixelScale(pixels, WS2812_COUNT, brightness >> 8);
+  ws2812Show();
+  idleNoteLedUpdate();
+#else
+  int r, g, b;
+  getRainbowColor(colorPos, r, g, b);
+  PixelColor color = {(uint8_t)r, (uint8_t)g, (uint8_t)b};
+#if PWM_HIRES
+  // gamma 展開到線性亮度後再乘亮度，低亮度仍有足夠階數
+  PixelColor16 level;
+  pixelGammaExpand(&level, &color, 1);
+  pixelScale16(&level, 1, gammaLevel16(brightness));
+  setLedLevels(level.r, level.g, level.b);
+  color = pixelScaled(color, brightness >> 8);
+  ledRed = color.r;
+  ledGreen = color.g;
+  ledBlue = color.b;
+  idleNoteLedUpdate();
+#else
+  color = pixelScaled(color, brightness >> 8);
+  setRGB(color.r, color.g, color.b);
+#endif
+#endif
 }
 
-// 從緩衝區讀取一個樣本
-int16_t readSample() {
-  // 如果緩衝區空了，從檔案讀取新資料
-  if (bufferIndex >= bufferSize) {
-    if (audioFile.available()) {
-      bufferSize = audioFile.read(audioBuffer, AUDIO_BUFFER_SIZE);
-      bufferIndex = 0;
-    } else {
-      return 0;  // 檔案結束
-    }
-  }
-  
-  // 從緩衝區讀取 16-bit PCM 資料（小端序）
-  if (bufferIndex + 1 < bufferSize) {
-    uint8_t low = audioBuffer[bufferIndex++];
-    uint8_t high = audioBuffer[bufferIndex++];
-    return (int16_t)((high << 8) | low);
+// 呼吸彩虹（WS2812 燈條上亮度波沿燈條流動，最暗為 brightness 的一半；類比燈條同 showRainbow）
+void showBreathingRainbow(int colorPos, uint16_t brightness, unsigned long time) {
+#if LED_OUTPUT == LED_OUTPUT_WS2812
+  PixelColor *pixels = ws2812Pixels();
+  for (int i = 0; i < WS2812_COUNT; i++) {
+    int r, g, b;
+    getRainbowColor(colorPos + i * 256 / WS2812_COUNT, r, g, b);
+    // 三角波，約 2 秒流過整條燈條
+    int wave = (time / 4 + i * 512 / WS2812_COUNT) % 512;
+    if (wave >= 256) wave = 511 - wave;
+    PixelColor color = {(uint8_t)r, (uint8_t)g, (uint8_t)b};
+    pixels[i] = pixelScaled(color, ((brightness >> 8) * (256 + wave)) >> 9);
   }
-  
-  return 0;
+  ws2812Show();
+  idleNoteLedUpdate();
+#else
+  showRainbow(colorPos, brightness);
+#endif
 }
 
-// 藍牙音頻資料回調函數（使用重採樣）
-int32_t get_sound_data(Frame *frame, int32_t frame_count) {
-  if (!audioFileReady || !audioFile || !isPlaying) {
-    // 沒有音檔或不在播放狀態，返回靜音
-    for (int i = 0; i < frame_count; i++) {
-      frame[i].channel1 = 0;
-      frame[i].channel2 = 0;
+// 獎勵按下後第一個聽得到的樣本：換算成送出的時間（offset 為它在這次回調中的第幾個 frame）
+void checkRewardLatency(const int16_t *samples, int32_t count, int32_t offset) {
+  for (int32_t i = 0; i < count; i++) {
+    if (samples[i] > AUDIBLE_LEVEL || samples[i] < -AUDIBLE_LEVEL) {
+      rewardLatencyUs = (uint32_t)esp_timer_get_time() - rewardPressUs +
+                        (uint32_t)(offset + i) * 1000000 / DST_SAMPLE_RATE;
+      rewardPressPending.store(false, std::memory_order_release);
+      return;
     }
+  }
+}
+
+// 產生音頻資料：每段 AUDIO_BLOCK_SAMPLES 個 frame 依序經過各個階段
+int32_t fillSoundFrames(Frame *frame, int32_t frame_count) {
+  if (!isPlaying.load(std::memory_order_acquire)) {
+    // 不在播放狀態，返回靜音（同時讓預讀的音源補滿緩衝區）
+    audioRingIdle();
+    writeSilentFrames(frame, frame_count);
     return frame_count;
   }
 
-  // 重採樣比例：源樣本速度相對於輸出的比例
-  // 16000 / 44100 = 0.3628，表示每個輸出樣本前進 0.3628 個源樣本
-  float ratio = (float)SRC_SAMPLE_RATE / (float)DST_SAMPLE_RATE;
-  
-  // 生成輸出樣本
-  for (int i = 0; i < frame_count; i++) {
-    // 檢查是否需要讀取新的源樣本
-    if (resamplePosition >= 1.0) {
-      // 讀取新樣本
-      int16_t sample = readSample();
-      
-      // 檢查是否檔案結束
-      if (sample == 0 && !audioFile.available() && bufferIndex >= bufferSize) {
-        // 檔案結束，停止播放
-        isPlaying = false;
-        audioFile.close();
-        Serial.println("✅ 播放完成");
-        setRGB(0, 255, 0);  // 綠色表示藍牙連接但未播放
-        
-        // 填充剩餘 frame 為靜音
-        for (int j = i; j < frame_count; j++) {
-          frame[j].channel1 = 0;
-          frame[j].channel2 = 0;
-        }
-        return frame_count;
-      }
-      
-      lastSample = sample;
-      resamplePosition -= 1.0;
+  // 新的播放：清空重採樣狀態（只在回調中做，loop() 改寫會與正在跑的回調衝突），通知 loop()，位置從 0 開始算
+  static uint32_t token = 0;
+  static uint32_t framesSent = 0;
+  static uint32_t nextPosition = 0;
+  uint32_t current = playbackToken.load(std::memory_order_relaxed);
+  if (current != token) {
+    token = current;
+    audioPipeline.reset();
+    framesSent = 0;
+    nextPosition = AUDIO_POSITION_INTERVAL_MS * DST_SAMPLE_RATE / 1000;
+    audioEvents.post(AUDIO_EVENT_STARTED, token & 1, token >> 1, playbackSource.sampleRate);
+  }
+
+  // 8kHz 音檔每個輸出前進 8000/44100 個源樣本；44.1kHz 合成音效一比一
+  audioPipeline.setSourceRate(playbackSource.sampleRate);
+
+  uint32_t held = 0;
+  for (int32_t done = 0; done < frame_count;) {
+    int32_t n = frame_count - done;
+    if (n > AUDIO_BLOCK_SAMPLES) n = AUDIO_BLOCK_SAMPLES;
+
+    // 取樣本：不夠時音源播完補 0，來不及補（計入 K 指令的統計）維持上一個樣本
+    uint32_t need = audioPipeline.needed(n);
+    uint32_t got = audioRingRead(audioPipeline.fetchBuffer(), need);
+    bool ended = false;
+    if (got < need) {
+      ended = audioSourceEnded();
+      audioPipeline.pad(got, need, ended);
+      if (!ended) held += need - got;
+    }
+
+    const int16_t *mono = audioPipeline.resample(n);
+    if (rewardPressPending.load(std::memory_order_acquire)) checkRewardLatency(mono, n, done);
+    writeMonoFrames(frame + done, mono, n);  // 單聲道音檔，兩個聲道播放相同內容
+    done += n;
+    framesSent += n;
+
+    if (ended) {
+      // 先清除 isPlaying 再送出事件：loop() 收到 FINISHED 時一定看得到 isPlaying == false
+      // 關檔、訊息與燈光由 loop() 處理（serviceAudioEvents()）
+      isPlaying.store(false, std::memory_order_release);
+      audioEvents.post(AUDIO_EVENT_FINISHED, token & 1, token >> 1,
+                       (uint32_t)((uint64_t)framesSent * 1000 / DST_SAMPLE_RATE));
+      writeSilentFrames(frame + done, frame_count - done);
+      return frame_count;
     }
-    
-    // 使用當前樣本（重複使用以達到降速效果）
-    // 單聲道音檔，兩個聲道播放相同內容
-    frame[i].channel1 = lastSample;
-    frame[i].channel2 = lastSample;
-    
-    // 更新重採樣位置
-    resamplePosition += ratio;
   }
-  
+
+  if (held > 0) {
+    audioEvents.post(AUDIO_EVENT_UNDERRUN, token & 1, token >> 1, held);
+  }
+  if (framesSent >= nextPosition) {
+    nextPosition += AUDIO_POSITION_INTERVAL_MS * DST_SAMPLE_RATE / 1000;
+    audioEvents.post(AUDIO_EVENT_POSITION, token & 1, token >> 1,
+                     (uint32_t)((uint64_t)framesSent * 1000 / DST_SAMPLE_RATE));
+  }
   return frame_count;
 }
 
-// 藍牙連接狀態回調
+// 藍牙音頻資料回調函數（記錄執行時間，檢查是否趕得上期限）
+int32_t get_sound_data(Frame *frame, int32_t frame_count) {
+  int64_t startUs = audioCallbackBegin();
+  int32_t result = fillSoundFrames(frame, frame_count);
+  audioCallbackEnd(startUs, frame_count);
+  return result;
+}
+
+// 藍牙連接狀態回調（藍牙 task）：只記錄旗標，訊息與燈光由 showLinkState() 在 loop() 中處理
 void connection_state_changed(esp_a2d_connection_state_t state, void *ptr) {
   if (state == ESP_A2D_CONNECTION_STATE_CONNECTED) {
     bluetoothConnected = true;
-    Serial.println("✅ 藍牙已連接到 Bose 喇叭");
-    setRGB(0, 255, 0);  // 綠色表示藍牙連接成功
+    btLinkNotify(true);
   } else if (state == ESP_A2D_CONNECTION_STATE_DISCONNECTED) {
     bluetoothConnected = false;
+    btLinkNotify(false);
+  }
+}
+
+// 連線 / 斷線後由 btLinkService() 呼叫（loop() 的 context）
+void showLinkState(bool connected) {
+  if (connected) {
+    Serial.println("✅ 藍牙已連接到喇叭");
+    setRGB(0, 255, 0);  // 綠色表示藍牙連接成功
+  } else {
     Serial.println("❌ 藍牙已斷開");
     setRGB(255, 0, 0);  // 紅色表示藍牙斷開
   }
 }
 
-// 掃描 SPIFFS 並分類音檔
+// 掃描音檔分區並分類音檔
 void scanAudioFiles() {
   Serial.println("\n【掃描音檔】");
   
-  File root = SPIFFS.open("/");
-  File file = root.openNextFile();
+  ClipStorage &storage = clipStorage();
+  ClipInfo info;
+  storage.rewindClips();
   
   dadCount = 0;
   momCount = 0;
   sxCount = 0;
+  audioFileReady = false;
   
-  while (file) {
-    String fileName = String(file.name());
+  while (storage.nextClip(info)) {
+    // 檔名可能有或沒有 / 前綴，保存時一律補上
+    const char *baseName = info.name[0] == '/' ? info.name + 1 : info.name;
+    size_t nameLen = strlen(baseName);
     
     // 只處理 .wav 檔案
-    if (fileName.endsWith(".wav")) {
+    if (nameLen > 4 && strcmp(baseName + nameLen - 4, ".wav") == 0) {
       Serial.print("  發現音檔: ");
-      Serial.println(fileName);
+      Serial.println(info.name);
       
-      // 根據檔名前綴分類（檔名可能有或沒有 / 前綴）
-      if ((fileName.startsWith("/Dad_") || fileName.startsWith("Dad_")) && dadCount < 10) {
-        dadFiles[dadCount++] = fileName;
-        Serial.println("    → 歸類為 Dad 系列");
-      } else if ((fileName.startsWith("/Mom_") || fileName.startsWith("Mom_")) && momCount < 10) {
-        momFiles[momCount++] = fileName;
-        Serial.println("    → 歸類為 Mom 系列");
-      } else if ((fileName.startsWith("/SX_") || fileName.startsWith("SX_")) && sxCount < 10) {
-        sxFiles[sxCount++] = fileName;
-        Serial.println("    → 歸類為 SX 系列");
+      // 根據檔名前綴分類
+      const char **list = NULL;
+      int *count = NULL;
+      const char *category = NULL;
+      if (strncmp(baseName, "Dad_", 4) == 0) {
+        list = dadFiles;
+        count = &dadCount;
+        category = "Dad";
+      } else if (strncmp(baseName, "Mom_", 4) == 0) {
+        list = momFiles;
+        count = &momCount;
+        category = "Mom";
+      } else if (strncmp(baseName, "SX_", 3) == 0) {
+        list = sxFiles;
+        count = &sxCount;
+        category = "SX";
       }
+      if (list == NULL || *count >= CLIPS_PER_CATEGORY) {
+        continue;
+      }
+      
+      const char *path = appArena.copyString(baseName, "/");
+      if (path == NULL) {
+        Serial.println("    ⚠️  檔名配置區已滿，略過");
+        continue;
+      }
+      list[(*count)++] = path;
+      Serial.print("    → 歸類為 ");
+      Serial.print(category);
+      Serial.println(" 系列");
     }
-    
-    file = root.openNextFile();
   }
   
   // 顯示統計
@@ -303,36 +544,112 @@ void scanAudioFiles() {
   }
 }
 
+// 取得音檔在事件紀錄中的代碼（類別 << 4 | 編號）
+uint8_t clipLogCode(const char *fileName) {
+  if (fileName == NULL) return LOG_CLIP_UNKNOWN;
+  for (int i = 0; i < dadCount; i++) {
+    if (strcmp(dadFiles[i], fileName) == 0) return (LOG_CLIP_DAD << 4) | i;
+  }
+  for (int i = 0; i < momCount; i++) {
+    if (strcmp(momFiles[i], fileName) == 0) return (LOG_CLIP_MOM << 4) | i;
+  }
+  for (int i = 0; i < sxCount; i++) {
+    if (strcmp(sxFiles[i], fileName) == 0) return (LOG_CLIP_SX << 4) | i;
+  }
+  return LOG_CLIP_UNKNOWN;
+}
+
+// 是否正在播放音檔或測試音（合成音效可以被打斷）
+bool isPlayingClip() {
+  return isPlaying && playbackSource.kind != playbackSource.SOURCE_SYNTH;
+}
+
+// loop() 改變 playbackSource（開檔、換音效、停止）前後呼叫：
+// 換上新的播放編號，舊音源之後送來的事件不再關檔、改燈光
+void beginSourceChange() {
+  audioSourceLock();
+  playbackId++;
+}
+
+void endSourceChange() {
+  audioSourceUnlock();
+}
+
+// 開始送出目前的音源：先寫入播放編號，回調看到 isPlaying 時一定看得到新的編號
+void beginPlayback() {
+  bool clip = playbackSource.kind != playbackSource.SOURCE_SYNTH;
+  playbackToken.store((uint32_t)playbackId << 1 | clip, std::memory_order_relaxed);
+  isPlaying.store(true, std::memory_order_release);
+}
+
+// 開啟音檔並設定播放範圍與音量（還不開始送出），失敗回傳 false
+// 檔名來自音檔列表，已經有 / 前綴（見 scanAudioFiles()）
+bool openClip(const char *fileName) {
+  beginSourceChange();
+  
+  // 開啟音檔（有分析資料時跳過頭尾的靜音並調整音量，見 clip_meta.h）
+  bool opened = false;
+  const ClipMeta *meta = NULL;
+#if CLIP_STORAGE == CLIP_STORAGE_RAW
+  // raw 分區：映射到記憶體直接讀取，不經過檔案 API
+  uint32_t clipSize = 0;
+  const uint8_t *mapped = rawClipStorage().mapClip(fileName, clipSize);
+  if (mapped != NULL && clipSize > WAV_HEADER_SIZE) {
+    meta = clipMetaFind(fileName, clipSize);
+    uint32_t start = meta ? meta->start : WAV_HEADER_SIZE;
+    uint32_t end = meta ? meta->end : clipSize;
+    playbackSource.playMemory((const int16_t *)(mapped + start), (end - start) / sizeof(int16_t),
+                              SRC_SAMPLE_RATE, meta ? meta->gain : AUDIO_GAIN_UNITY);
+    opened = true;
+  }
+#endif
+  if (!opened) {
+    ClipReader *reader = clipStorage().open(fileName);
+    if (reader) {
+      meta = clipMetaFind(fileName, reader->size());
+      if (meta) {
+        reader->seek(meta->start);
+        playbackSource.playStream(reader, SRC_SAMPLE_RATE, meta->gain, meta->end);
+      } else {
+        // 跳過 WAV 標頭（44 bytes）
+        reader->seek(WAV_HEADER_SIZE);
+        playbackSource.playStream(reader, SRC_SAMPLE_RATE);
+      }
+      opened = true;
+    }
+  }
+  endSourceChange();
+  
+  if (opened && meta) {
+    printfNoAlloc(Serial, "✂️  跳過開頭靜音 %lu ms，音量 %+.1f dB\n",
+                          (unsigned long)((meta->start - WAV_HEADER_SIZE) / sizeof(int16_t) * 1000 / SRC_SAMPLE_RATE),
+                          20.0 * log10((double)meta->gain / AUDIO_GAIN_UNITY));
+  }
+  
+  return opened;
+}
+
+// 開始送出已開啟的音檔
+void startClip(const char *fileName) {
+  beginPlayback();
+  setRGB(0, 0, 255);  // 藍色表示正在播放
+  eventLogRecord(LOG_CLIP_PLAYED, clipLogCode(fileName));
+}
+
 // 播放指定音檔
-void playAudioFile(String fileName) {
-  if (isPlaying) {
+void playAudioFile(const char *fileName) {
+  if (isPlayingClip()) {
     Serial.println("⚠️  正在播放中，請稍後再試");
     return;
   }
+  isPlaying = false;  // 打斷播放中的合成音效
+  rewardReady = false;
   
   Serial.print("🎵 開始播放: ");
   Serial.println(fileName);
   
-  // 確保檔案路徑有 / 前綴
-  if (!fileName.startsWith("/")) {
-    fileName = "/" + fileName;
-  }
-  
-  // 開啟音檔
-  audioFile = SPIFFS.open(fileName, "r");
-  if (audioFile) {
-    // 跳過 WAV 標頭（44 bytes）
-    audioFile.seek(WAV_HEADER_SIZE);
-    
-    // 初始化緩衝區和重採樣參數
-    bufferIndex = 0;
-    bufferSize = 0;
-    resamplePosition = 1.0;
-    lastSample = 0;
-    
-    isPlaying = true;
-    setRGB(0, 0, 255);  // 藍色表示正在播放
-    
+  if (openClip(fileName)) {
+    startClip(fileName);
     Serial.println("✅ 音檔已開啟，開始串流（16kHz -> 44.1kHz）...");
   } else {
     Serial.print("❌ 無法開啟音檔: ");
@@ -340,60 +657,230 @@ void playAudioFile(String fileName) {
   }
 }
 
-// 抽籤選擇音檔（不立即播放）
-String selectAudioFile() {
+// 播放合成音效（藍牙未連接或正在播放音檔時略過）
+void playJingle(const char *melody) {
+  if (!bluetoothConnected || isPlayingClip()) {
+    return;
+  }
+  
+  isPlaying = false;  // 新的音效取代播放中的音效
+  rewardReady = false;
+  beginSourceChange();
+  playbackSource.playSynth(melody, DST_SAMPLE_RATE);
+  endSourceChange();
+  beginPlayback();
+}
+
+// 量測讀檔耗時用的時鐘（預讀大小依讀取速度調整，見 read_ahead.h）
+uint32_t readClockUs() {
+  return (uint32_t)esp_timer_get_time();
+}
+
+// 音檔讀取統計（預讀效果）
+void printReadStats() {
+  const ReadAheadPolicy &policy = playbackSource.readAhead();
+  const ReadAheadStats &stats = policy.readStats();
+  Serial.println("【音檔讀取】");
+  if (stats.reads == 0) {
+    Serial.println("  還沒有播放過音檔");
+    return;
+  }
+  
+  // 以播放速度換算：每秒音檔需要讀幾次
+  uint32_t bytesPerSec = SRC_SAMPLE_RATE * sizeof(int16_t);
+  printfNoAlloc(Serial, "  讀取 %u 次，平均 %u bytes/次\n",
+                        (unsigned)stats.reads, (unsigned)(stats.bytes / stats.reads));
+  printfNoAlloc(Serial, "  每秒音檔讀取 %.1f 次（固定 %d bytes 時為 %.1f 次）\n",
+                        (double)stats.reads * bytesPerSec / stats.bytes,
+                        READ_AHEAD_MIN, (double)bytesPerSec / READ_AHEAD_MIN);
+  printfNoAlloc(Serial, "  讀取耗時：平均 %u us，最長 %u us（預算 %d us）\n",
+                        (unsigned)(stats.readUs / stats.reads), (unsigned)stats.maxReadUs, READ_AHEAD_BUDGET_US);
+  printfNoAlloc(Serial, "  目前讀取大小 %u bytes（上限 %d，放大 %u 次、縮小 %u 次）\n",
+                        (unsigned)policy.chunkSize(), READ_AHEAD_MAX,
+                        (unsigned)stats.grows, (unsigned)stats.shrinks);
+}
+
+// 播放測試音（不需要音檔，用來確認藍牙喇叭有聲音）
+void playTestTone() {
+  if (isPlaying) {
+    Serial.println("⚠️  正在播放中，請稍後再試");
+    return;
+  }
+  
+  rewardReady = false;
+  beginSourceChange();
+  playbackSource.playTone(440, SRC_SAMPLE_RATE, 1000, 8000);
+  endSourceChange();
+  beginPlayback();
+  Serial.println("🔔 播放測試音 440Hz");
+}
+
+// 抽籤選擇音檔（不立即播放，也不顯示結果，見 announceClip()）
+// 回傳音檔列表中的檔名（不複製），沒有音檔時回傳 NULL
+const char *selectAudioFile() {
   if (!audioFileReady) {
     Serial.println("⚠️  沒有可用的音檔");
-    return "";
+    return NULL;
   }
   
-  Serial.println("\n🎲 開始抽籤...");
-  
-  // 隨機選擇類別（0=Dad, 1=Mom, 2=SX）
+  // 隨機選擇類別（0=Dad, 1=Mom, 2=SX），該類別沒有音檔時依序改選有音檔的類別
   int category = random(0, 3);
-  String selectedFile = "";
-  
-  if (category == 0 && dadCount > 0) {
-    // Dad 系列
-    int index = random(0, dadCount);
-    selectedFile = dadFiles[index];
-    Serial.println("🎯 抽中 Dad 系列");
-  } else if (category == 1 && momCount > 0) {
-    // Mom 系列
-    int index = random(0, momCount);
-    selectedFile = momFiles[index];
-    Serial.println("🎯 抽中 Mom 系列");
-  } else if (category == 2 && sxCount > 0) {
-    // SX 系列
-    int index = random(0, sxCount);
-    selectedFile = sxFiles[index];
-    Serial.println("🎯 抽中 SX 系列");
-  } else {
-    // 如果選中的類別沒有音檔，隨便選一個有音檔的類別
-    Serial.println("⚠️  該類別無音檔，重新選擇...");
-    
-    if (dadCount > 0) {
-      int index = random(0, dadCount);
-      selectedFile = dadFiles[index];
-      Serial.println("🎯 抽中 Dad 系列（備選）");
-    } else if (momCount > 0) {
-      int index = random(0, momCount);
-      selectedFile = momFiles[index];
-      Serial.println("🎯 抽中 Mom 系列（備選）");
-    } else if (sxCount > 0) {
-      int index = random(0, sxCount);
-      selectedFile = sxFiles[index];
-      Serial.println("🎯 抽中 SX 系列（備選）");
+  if (category == 0 && dadCount > 0) return dadFiles[random(0, dadCount)];
+  if (category == 1 && momCount > 0) return momFiles[random(0, momCount)];
+  if (category == 2 && sxCount > 0) return sxFiles[random(0, sxCount)];
+  if (dadCount > 0) return dadFiles[random(0, dadCount)];
+  if (momCount > 0) return momFiles[random(0, momCount)];
+  if (sxCount > 0) return sxFiles[random(0, sxCount)];
+  return NULL;
+}
+
+// 顯示抽籤結果
+void announceClip(const char *fileName) {
+  static const char *categories[3] = {"Dad", "Mom", "SX"};
+  Serial.println("\n🎲 開始抽籤...");
+  uint8_t code = clipLogCode(fileName);
+  if (code != 0xFF && (code >> 4) < 3) {
+    Serial.print("🎯 抽中 ");
+    Serial.print(categories[code >> 4]);
+    Serial.println(" 系列");
+  }
+}
+
+// 停止音源並關檔（不在播放時）
+void stopSource() {
+  beginSourceChange();
+  playbackSource.stop();
+  endSourceChange();
+}
+
+// ========== 播放事件（A2DP 回調送來，見 audio_events.h）==========
+bool underrunWarned = false;    // 這次播放已經提醒過來不及補
+uint32_t playbackPositionMs = 0;
+
+// 關檔、訊息與燈光在 loop() 處理，A2DP 回調只送出事件
+void serviceAudioEvents() {
+  AudioEvent event = {};
+  while (audioEvents.poll(event)) {
+    bool current = event.playback == playbackId;  // loop() 還沒換掉這個音源
+    switch (event.type) {
+      case AUDIO_EVENT_STARTED:
+        underrunWarned = false;
+        playbackPositionMs = 0;
+        break;
+      case AUDIO_EVENT_POSITION:
+        if (current) playbackPositionMs = event.value;
+        break;
+      case AUDIO_EVENT_UNDERRUN:
+        if (event.clip && !underrunWarned) {
+          underrunWarned = true;
+          printfNoAlloc(Serial, "⚠️  音源來不及補，重複上一個樣本 %lu 次（K 指令看緩衝區水位）\n", (unsigned long)event.value);
+        }
+        break;
+      case AUDIO_EVENT_FINISHED:
+        playbackPositionMs = event.value;
+        if (current && !isPlaying) {
+          stopSource();  // 關檔（換音源時已經關掉舊的）
+        }
+        if (event.clip) {
+          printfNoAlloc(Serial, "✅ 播放完成（%lu.%lu 秒）\n", (unsigned long)(event.value / 1000),
+                                (unsigned long)(event.value % 1000 / 100));
+          if (current) setRGB(0, 255, 0);  // 綠色表示藍牙連接但未播放（合成音效結束不改燈光）
+          if (current) dispatchEvent(EVENT_PLAYBACK_DONE);  // 抽中的音檔播完（其他狀態會忽略）
+        }
+        break;
     }
   }
+}
+
+void printAudioEvents() {
+  printfNoAlloc(Serial, "【播放事件】開始 %lu、結束 %lu、來不及補 %lu、位置 %lu，丟掉 %lu，最多同時 %lu 筆（上限 %d）\n",
+                        (unsigned long)audioEvents.received(AUDIO_EVENT_STARTED),
+                        (unsigned long)audioEvents.received(AUDIO_EVENT_FINISHED),
+                        (unsigned long)audioEvents.received(AUDIO_EVENT_UNDERRUN),
+                        (unsigned long)audioEvents.received(AUDIO_EVENT_POSITION), (unsigned long)audioEvents.dropped(),
+                        (unsigned long)audioEvents.maxPending(), AUDIO_EVENT_QUEUE);
+  if (isPlaying) {
+    printfNoAlloc(Serial, "  播放中，位置 %lu.%lu 秒\n", (unsigned long)(playbackPositionMs / 1000),
+                          (unsigned long)(playbackPositionMs % 1000 / 100));
+  }
+}
+
+// 掃描音檔並載入播放資訊（開機時，以及序列埠上傳音檔之後）
+void loadClipCatalog() {
+  scanAudioFiles();
+  int metaCount = clipMetaLoad(clipStorage());
+  if (metaCount > 0) {
+    printfNoAlloc(Serial, "✅ 載入 %d 個音檔的播放資訊（音量、頭尾靜音）\n", metaCount);
+  }
+}
+
+// ========== 預先抽籤與預讀 ==========
+// 進入抽籤階段時就選好獎勵音檔；慶祝音效播完後開檔、seek，音源 task 把開頭讀進環形緩衝區，
+// 按下黃色按鈕時只要把 isPlaying 設為 true，下一次音頻回調就直接送出樣本。
+// 其他音效或音檔取代了音源時 rewardReady 會被清除，閒置時再重新預讀。
+
+// 還沒預讀好（或音源被取代）時才在 loop() 中開檔，避免打斷慶祝音效
+void warmRewardClip() {
+  if (rewardClip == NULL || rewardReady || isPlaying || serialUploadActive()) {
+    return;
+  }
   
-  return selectedFile;
+  if (!openClip(rewardClip)) {
+    rewardClip = NULL;  // 按下時再重新抽
+    return;
+  }
+  rewardReady = true;
 }
 
+// 放棄預讀的音檔（關檔）
+void releaseRewardClip() {
+  if (rewardReady && !isPlaying) {
+    stopSource();
+  }
+  rewardClip = NULL;
+  rewardReady = false;
+}
+
+// 從按下黃色按鈕到第一個有聲音的樣本送進藍牙堆疊
+void printRewardLatency(bool prepared) {
+  if (rewardPressPending.exchange(false, std::memory_order_acq_rel)) {
+    return;  // 整個音檔都沒有超過門檻的樣本
+  }
+  printfNoAlloc(Serial, "⏱️  按下到第一個有聲音的樣本：%lu.%lu ms（%s）\n",
+                        (unsigned long)(rewardLatencyUs / 1000), (unsigned long)(rewardLatencyUs % 1000 / 100),
+                        prepared ? "已預讀" : "按下後才開檔");
+}
+
+// 序列埠上傳音檔：第一次寫入前停止播放並關檔（上傳中不播放，也不會讀到寫到一半的檔案）
+void stopForUpload() {
+  isPlaying = false;
+  pendingClip = NULL;
+  releaseRewardClip();
+  stopSource();
+}
+
+// 上傳完成後重新建立音檔列表，檔名重新從配置區切出（不需要重新開機）
+void reloadClipCatalog() {
+  releaseRewardClip();  // 預先抽好與排隊中的檔名都在配置區裡，重建前先清掉
+  pendingClip = NULL;
+  appArena.reset();
+  loadClipCatalog();
+  appArena.seal();
+  printfNoAlloc(Serial, "🧮 配置區使用 %u / %u bytes\n", (unsigned)appArena.used(), (unsigned)appArena.capacity());
+}
+
+#ifdef PERF_BENCH
+void perfBenchRun();  // test/test_perf_benchmark.cpp
+#endif
+
 void setup() {
+  bootTimelineBegin();
+  
   // 初始化序列埠
-  Serial.begin(115200);
+  Serial.setRxBufferSize(UPLOAD_RX_BUFFER);  // 上傳音檔時放得下一個封包（見 serial_upload.h）
+  Serial.begin(SERIAL_BAUD);
   delay(1000);
+  bootTimelineMark("serial");
   
   Serial.println("========================================");
   Serial.println("ESP32 家庭任務提醒機");
@@ -406,7 +893,10 @@ void setup() {
   pinMode(BUTTON_4, INPUT);
   pinMode(BUTTON_5, INPUT);
   
-  // 設定 LED PWM
+  // 設定 LED 輸出
+#if LED_OUTPUT == LED_OUTPUT_WS2812
+  ws2812Begin();
+#else
   ledcSetup(PWM_CHANNEL_R, PWM_FREQ, PWM_RESOLUTION);
   ledcSetup(PWM_CHANNEL_G, PWM_FREQ, PWM_RESOLUTION);
   ledcSetup(PWM_CHANNEL_B, PWM_FREQ, PWM_RESOLUTION);
@@ -414,25 +904,60 @@ void setup() {
   ledcAttachPin(RGB_R_PIN, PWM_CHANNEL_R);
   ledcAttachPin(RGB_G_PIN, PWM_CHANNEL_G);
   ledcAttachPin(RGB_B_PIN, PWM_CHANNEL_B);
+#if PWM_HIRES
+  startLedDither();
+#endif
+#endif
   
   setRGB(0, 0, 0);  // 初始全暗
   
+  // 閒置休眠：任一按鈕可喚醒
+  const uint8_t wakePins[5] = {BUTTON_1, BUTTON_2, BUTTON_3, BUTTON_4, BUTTON_5};
+  idleBegin(wakePins, 5);
+  voiceBegin();  // SU-03T 語音模組（選用，見 voice_prompt.h）
+  bootTimelineMark("gpio_pwm");
+  
   // 初始化隨機數種子
   randomSeed(analogRead(0));
   
-  // ========== 階段 1：初始化 SPIFFS ==========
-  Serial.println("\n【階段 1】初始化 SPIFFS...");
+  // 載入事件紀錄（NVS）
+  eventLogBegin();
   
-  if (!SPIFFS.begin(true)) {
-    Serial.println("❌ SPIFFS 初始化失敗！");
+  // CPU 調頻（開機期間維持最高頻率）
+  cpuScalingBegin();
+  playbackSource.readClock = readClockUs;
+  bootTimelineMark("nvs_log");
+  
+  // ========== 階段 1：初始化音檔儲存（預設 SPIFFS）==========
+  Serial.print("\n【階段 1】初始化 ");
+  Serial.print(clipStorage().name());
+  Serial.println("...");
+  
+  if (!clipStorage().begin()) {
+    Serial.print("❌ ");
+    Serial.print(clipStorage().name());
+    Serial.println(" 初始化失敗！");
     setRGB(255, 0, 0);  // 紅色表示錯誤
     while (1) { delay(1000); }
   }
   
-  Serial.println("✅ SPIFFS 初始化成功");
+  Serial.print("✅ ");
+  Serial.print(clipStorage().name());
+  Serial.println(" 初始化成功");
+  bootTimelineMark("storage_mount");
   
   // 掃描並分類音檔
-  scanAudioFiles();
+  loadClipCatalog();
+  serialUploadBegin(stopForUpload, reloadClipCatalog);
+  bootTimelineMark("scan_audio");
+  
+  // 音源 task（讀檔與 A2DP 回調分開，見 task_layout.h）
+  audioTaskBegin(playbackSource);
+  
+#ifdef PERF_BENCH
+  // 效能測試韌體（env:perf_bench）：不啟動藍牙，測完停在這裡
+  perfBenchRun();
+#endif
   
   if (!audioFileReady) {
     Serial.println("❌ 沒有找到任何音檔");
@@ -446,26 +971,33 @@ void setup() {
   
   // 設定連接狀態回調
   a2dp_source.set_on_connection_state_changed(connection_state_changed);
+#if TASK_LAYOUT == TASK_LAYOUT_PINNED
+  // A2DP 函式庫的事件 task 預設在 core 1，移到藍牙所在的核心，不和 loop() 搶
+  a2dp_source.set_task_core(BT_CORE);
+  a2dp_source.set_task_priority(BT_APP_TASK_PRIORITY);
+#endif
+  btLinkBegin(a2dp_source, showLinkState);
   
-  // 開始藍牙，嘗試連接到 Bose 喇叭
-  Serial.println("🔍 正在搜尋 'Bose Mini II SoundLink'...");
-  Serial.println("   請確保喇叭已開啟並進入配對模式！");
-  
-  a2dp_source.start("Bose Mini II SoundLink", get_sound_data);
+  // 開始藍牙：有上次的喇叭位址就直接連線，否則依 BT_SPEAKERS 的名稱搜尋
+  btLinkStart(get_sound_data);
   
   Serial.println("✅ 藍牙 A2DP 已啟動");
+  bootTimelineMark("a2dp_start");
   Serial.println("   等待連接中...");
   
   // 等待連接（最多 10 秒）
   int waitCount = 0;
   while (!bluetoothConnected && waitCount < 100) {
     delay(100);
+    btLinkService(millis());  // 用上次的位址連線、連不上改用名稱搜尋
     waitCount++;
     if (waitCount % 10 == 0) {
       Serial.print(".");
     }
   }
   
+  bootTimelineMark("bt_connect");
+  
   if (bluetoothConnected) {
     Serial.println("\n✅ 藍牙連接成功！");
     setRGB(0, 255, 0);  // 綠色表示藍牙連接成功
@@ -488,184 +1020,468 @@ void setup() {
   Serial.println("   1. 按紅/綠/藍按鈕亮三燈");
   Serial.println("   2. 三燈全亮後，1分鐘內按黃色按鈕抽籤");
   Serial.println("   3. 按一次後失效，需重新完成流程");
+  Serial.println("");
+  Serial.println("序列埠指令：輸入 h 顯示說明");
   Serial.println("========================================\n");
+  
+  // 狀態機計時器（從這裡開始計時）
+  appTimers.begin(millis());
+  wheelTimerInit(lotteryTimeoutTimer, onLotteryTimeout);
+  wheelTimerInit(lotteryCountdownTimer, onLotteryCountdown);
+  wheelTimerInit(playbackTimeoutTimer, onPlaybackTimeout);
+  
+  // 之後應用程式自己的資料不再配置（loop task 已知會用到 heap 的地方見 heap_watch.h，使用量見序列埠指令 M）
+  appArena.seal();
+  heapWatchBegin();
+  printfNoAlloc(Serial, "🧮 配置區使用 %u / %u bytes\n", (unsigned)appArena.used(), (unsigned)appArena.capacity());
+  
+  bootTimelineFinish();
 }
 
-void loop() {
-  unsigned long currentTime = millis();
+// 序列埠指令（除錯用，單一字元）
+void handleSerialCommand() {
+  if (!Serial.available()) {
+    return;
+  }
   
-  // 根據當前狀態執行不同邏輯
-  if (currentState == NORMAL) {
-    // ========== 正常模式：處理按鈕輸入 ==========
-    
-    // 讀取按鈕狀態（黃色按鈕在 NORMAL 模式下不處理）
-    bool button3Current = (digitalRead(BUTTON_3) == HIGH);  // 紅色按鈕
-    bool button4Current = (digitalRead(BUTTON_4) == HIGH);  // 綠色按鈕
-    bool button5Current = (digitalRead(BUTTON_5) == HIGH);  // 藍色按鈕
-    
-    // 偵測紅色按鈕按下瞬間
-    if (button3Current == HIGH && lastButton3State == LOW) {
-      redLedState = !redLedState;
-      Serial.print("[紅色按鈕] 紅燈 -> ");
-      Serial.println(redLedState ? "開啟" : "關閉");
-      delay(DEBOUNCE_DELAY);
-    }
-    lastButton3State = button3Current;
-    
-    // 偵測綠色按鈕按下瞬間
-    if (button4Current == HIGH && lastButton4State == LOW) {
-      greenLedState = !greenLedState;
-      Serial.print("[綠色按鈕] 綠燈 -> ");
-      Serial.println(greenLedState ? "開啟" : "關閉");
-      delay(DEBOUNCE_DELAY);
-    }
-    lastButton4State = button4Current;
-    
-    // 偵測藍色按鈕按下瞬間
-    if (button5Current == HIGH && lastButton5State == LOW) {
-      blueLedState = !blueLedState;
-      Serial.print("[藍色按鈕] 藍燈 -> ");
-      Serial.println(blueLedState ? "開啟" : "關閉");
-      delay(DEBOUNCE_DELAY);
-    }
-    lastButton5State = button5Current;
-    
-    // 根據燈光狀態設定RGB（只在不播放時）
-    if (!isPlaying) {
-      int red = redLedState ? 255 : 0;
-      int green = greenLedState ? 255 : 0;
-      int blue = blueLedState ? 255 : 0;
-      setRGB(red, green, blue);
-    }
-    
-    // 檢查是否三燈全亮
-    bool allLightsOn = redLedState && greenLedState && blueLedState;
-    if (allLightsOn && !allLightsWereOn) {
-      // 三燈剛剛全亮，直接進入抽籤階段
-      currentState = LOTTERY;
-      lotteryStartTime = currentTime;  // 記錄抽籤開始時間
-      lotteryAvailable = true;          // 開啟抽籤
-      lotteryUsed = false;              // 重置使用狀態
-      allLightsWereOn = true;
-      
-      Serial.println("========================================");
-      Serial.println("🎉 三燈全亮！");
-      Serial.println("⏰ 請在 1 分鐘內按下黃色按鈕抽籤");
-      Serial.println("========================================");
+  char cmd = Serial.read();
+  lastActivityTime = millis();
+  switch (cmd) {
+    case 'L':
+      eventLogDump(Serial);
+      break;
+    case 'X':
+      eventLogClear();
+      break;
+    case 'B':
+      btLinkPrintStats(Serial);
+      break;
+    case 'W':
+      playTestTone();
+      break;
+    case 'J':
+      Serial.println("🎺 播放慶祝音效");
+      playJingle(FANFARE_MELODY);
+      break;
+    case 'T':
+      bootTimelinePrint(Serial);
+      break;
+    case 'R':
+      printReadStats();
+      break;
+    case 'P':
+      idlePrintStats(Serial);
+      cpuScalingPrintStats(Serial);
+#if LED_OUTPUT == LED_OUTPUT_WS2812
+      ws2812PrintStats(Serial);
+#endif
+      break;
+    case 'D':
+      loopWatchPrintStats(Serial);
+      break;
+    case 'M':
+      heapWatchPrintStats(Serial);
+      break;
+    case 'K':
+      taskLayoutPrintStats(Serial);
+      printAudioEvents();
+      break;
+    case 'U':
+      serialUploadStart();
+      break;
+    case 'V':
+      voicePrintStats(Serial);
+      voiceSay(VOICE_PROMPT_TEST);
+      break;
+    case 'h':
+    case '?':
+      Serial.println("序列埠指令：");
+      Serial.println("  L -> 輸出事件紀錄（二進位，用 tools/decode_event_log.py 解析）");
+      Serial.println("  X -> 清除事件紀錄");
+      Serial.println("  B -> 顯示藍牙連線統計");
+      Serial.println("  W -> 播放 1 秒測試音（440Hz）");
+      Serial.println("  J -> 播放三燈全亮的慶祝音效");
+      Serial.println("  T -> 顯示開機時間軸");
+      Serial.println("  P -> 顯示省電統計（休眠、CPU 頻率、音頻回調耗時）");
+      Serial.println("  R -> 顯示音檔讀取統計（每秒讀取次數、每次讀取大小）");
+      Serial.println("  D -> 顯示 loop() 延遲（直方圖、最長卡住時間）");
+      Serial.println("  M -> 顯示記憶體（heap 可用空間、最低值、最大連續區塊）");
+      Serial.println("  K -> 顯示 task 配置（各 task CPU 使用率、音源緩衝區最低水位、播放事件）");
+      Serial.println("  U -> 上傳音檔（切換到高速鮑率，用 tools/upload_clips.py 傳送）");
+      Serial.println("  V -> 顯示語音模組統計並播放測試語音（SU-03T，VOICE_MODULE=1）");
+      break;
+    default:
+      break;
+  }
+}
+
+// 閒置時進入 light sleep（按鈕喚醒），回傳是否有休眠
+bool enterIdleSleepIfQuiet(unsigned long currentTime) {
+  IdleInputs in;
+  in.now = currentTime;
+  in.lastActivity = lastActivityTime;
+  in.normalState = (currentState == NORMAL);
+  in.playing = isPlaying;
+  in.buttonHeld = digitalRead(BUTTON_1) == HIGH || digitalRead(BUTTON_2) == HIGH ||
+                  digitalRead(BUTTON_3) == HIGH || digitalRead(BUTTON_4) == HIGH ||
+                  digitalRead(BUTTON_5) == HIGH;
+  in.linkActive = bluetoothConnected || btLinkAttemptInFlight(currentTime) || pendingClip != NULL;
+  in.ledsSteady = ledsSteady();
+  
+  if (idleDecide(in) != IDLE_SLEEP) {
+    return false;
+  }
+  
+  holdLedsForSleep();
+  idleLightSleep();
+  restoreLedsAfterSleep();
+  return true;
+}
+
+// 播放排隊中的音檔（重新連線成功後）
+void servicePendingClip(unsigned long currentTime) {
+  if (pendingClip == NULL || serialUploadActive()) {
+    return;
+  }
+  
+  if (currentTime - pendingClipTime >= PENDING_CLIP_TIMEOUT) {
+    Serial.println("⚠️  藍牙一直沒有連上，取消排隊中的音檔");
+    eventLogRecord(LOG_PLAYBACK_SKIPPED);
+    pendingClip = NULL;
+    return;
+  }
+  
+  if (btLinkUsable(currentTime) && !isPlaying) {
+    Serial.println("🔗 藍牙已恢復，播放排隊中的音檔");
+    playAudioFile(pendingClip);
+    pendingClip = NULL;
+  }
+}
+
+// ========== 狀態機：事件與轉換 ==========
+
+// 抽籤結束（抽完或逾時）：重置三燈與狀態
+void resetTasks() {
+  appTimers.cancel(lotteryTimeoutTimer);
+  appTimers.cancel(lotteryCountdownTimer);
+  
+  setRGB(0, 0, 0);
+  redLedState = false;
+  greenLedState = false;
+  blueLedState = false;
+  allLightsWereOn = false;
+  lastActivityTime = millis();
+}
+
+void printLotteryRemaining() {
+  unsigned long remaining = LOTTERY_TIMEOUT - (millis() - lotteryStartTime);
+  Serial.print("⏰ 抽籤剩餘時間：");
+  Serial.print((remaining + 500) / 1000);
+  Serial.println(" 秒");
+}
+
+// 三燈剛剛全亮：直接進入抽籤階段
+void enterLottery() {
+  lotteryStartTime = millis();  // 記錄抽籤開始時間
+  eventLogRecord(LOG_LOTTERY_OPEN);
+  
+  Serial.println("========================================");
+  Serial.println("🎉 三燈全亮！");
+  Serial.println("⏰ 請在 1 分鐘內按下黃色按鈕抽籤");
+  Serial.println("========================================");
+  voiceSay(VOICE_PROMPT_LOTTERY_OPEN);
+  if (!serialUploadActive()) {  // 上傳中不播放，也不抽（音檔列表結束上傳時會重新建立）
+    playJingle(FANFARE_MELODY);
+    rewardClip = selectAudioFile();  // 慶祝音效播完後預讀（updateLottery()）
+  }
+  
+  printLotteryRemaining();
+  appTimers.start(lotteryTimeoutTimer, LOTTERY_TIMEOUT, lotteryStartTime);
+  appTimers.start(lotteryCountdownTimer, LOTTERY_COUNTDOWN_INTERVAL, lotteryStartTime);
+}
+
+// 黃色按鈕：開始播放進入抽籤階段時抽好的音檔（或排隊等藍牙恢復），不等播完
+void drawLottery() {
+  rewardPressUs = (uint32_t)esp_timer_get_time();
+  
+  Serial.println("\n========================================");
+  Serial.println("🎲 黃色按鈕按下，開始抽籤！");
+  Serial.println("========================================");
+  
+  // 預先抽好的音檔（沒有的話現在才抽）
+  const char *selectedFile = rewardClip;
+  bool prepared = rewardReady && !isPlaying;
+  rewardClip = NULL;
+  rewardReady = false;
+  drawPlayed = false;
+  drawPrepared = prepared;
+  
+  if (serialUploadActive()) {
+    if (prepared) stopSource();  // 還沒開始寫入的話預讀的檔案還開著
+    Serial.println("⚠️  上傳音檔中，跳過播放");
+    eventLogRecord(LOG_PLAYBACK_SKIPPED);
+  } else if (bluetoothConnected && audioFileReady) {
+    if (selectedFile == NULL) selectedFile = selectAudioFile();
+    eventLogRecord(LOG_LOTTERY_DRAW, clipLogCode(selectedFile));
+    if (selectedFile != NULL) {
+      announceClip(selectedFile);
+      rewardPressPending.store(true, std::memory_order_release);
+      if (prepared) {
+        Serial.print("🎵 開始播放（已預讀）: ");
+        Serial.println(selectedFile);
+        startClip(selectedFile);
+      } else {
+        playAudioFile(selectedFile);
+      }
+      drawPlayed = true;
     }
-    if (!allLightsOn) {
-      allLightsWereOn = false;
+  } else if (audioFileReady) {
+    // 藍牙重新連線中：先抽籤，連線後再播放
+    if (prepared) stopSource();  // 關檔，連線後重新開啟
+    if (selectedFile == NULL) selectedFile = selectAudioFile();
+    if (selectedFile != NULL) {
+      announceClip(selectedFile);
+      pendingClip = selectedFile;
+      pendingClipTime = millis();
+      eventLogRecord(LOG_CLIP_QUEUED, clipLogCode(selectedFile));
+      Serial.println("🔁 藍牙重新連線中，音檔已排隊，連線後自動播放");
     }
-    
-  } else if (currentState == LOTTERY) {
-    // ========== 抽籤階段：等待黃色按鈕按下（1分鐘限時）==========
-    
-    unsigned long elapsed = currentTime - lotteryStartTime;
-    unsigned long remaining = LOTTERY_TIMEOUT - elapsed;
-    
-    // 檢查是否超時
-    if (elapsed >= LOTTERY_TIMEOUT) {
-      Serial.println("========================================");
-      Serial.println("⏰ 抽籤時間已過，機會失效！");
-      Serial.println("========================================");
-      
-      // 重置所有狀態，回到正常模式
-      setRGB(0, 0, 0);
-      redLedState = false;
-      greenLedState = false;
-      blueLedState = false;
-      allLightsWereOn = false;
-      lotteryAvailable = false;
-      lotteryUsed = false;
-      currentState = NORMAL;
-      
-      Serial.println("🌙 所有燈已重置，回到正常模式\n");
+  } else {
+    Serial.println("⚠️  藍牙未連接或無音檔，跳過播放");
+    eventLogRecord(LOG_PLAYBACK_SKIPPED);
+  }
+  
+  // 播放中：留在 PLAYING，播完（serviceAudioEvents()）或逾時才重置；沒有播放（或開檔失敗）就直接結束
+  if (drawPlayed && isPlaying) {
+    appTimers.start(playbackTimeoutTimer, PLAYBACK_TIMEOUT, millis());
+  } else {
+    dispatchEvent(EVENT_PLAYBACK_DONE);
+  }
+}
+
+// 抽中的音檔播完（或逾時、沒有播放）：重置三燈回到正常模式
+void finishDraw() {
+  appTimers.cancel(playbackTimeoutTimer);
+  if (drawPlayed) {
+    printRewardLatency(drawPrepared);
+    drawPlayed = false;
+  }
+  
+  Serial.println("\n========================================");
+  Serial.println("🌙 抽籤完成，所有燈已重置");
+  Serial.println("========================================\n");
+  resetTasks();
+}
+
+// 抽籤時間到：機會失效
+void expireLottery() {
+  Serial.println("========================================");
+  Serial.println("⏰ 抽籤時間已過，機會失效！");
+  Serial.println("========================================");
+  eventLogRecord(LOG_LOTTERY_TIMEOUT);
+  voiceSay(VOICE_PROMPT_LOTTERY_EXPIRED);
+  
+  releaseRewardClip();
+  resetTasks();
+  Serial.println("🌙 所有燈已重置，回到正常模式\n");
+}
+
+struct Transition {
+  AppState from;
+  AppEvent event;
+  AppState to;
+  void (*action)();
+};
+
+// 狀態轉換表（沒有列出的 狀態 + 事件 組合會被忽略）
+const Transition transitions[] = {
+  {NORMAL,  EVENT_ALL_LIGHTS_ON,   LOTTERY, enterLottery},
+  {LOTTERY, EVENT_DRAW,            PLAYING, drawLottery},
+  {LOTTERY, EVENT_LOTTERY_TIMEOUT, NORMAL,  expireLottery},
+  {PLAYING, EVENT_PLAYBACK_DONE,   NORMAL,  finishDraw},
+};
+
+// 先切換狀態再執行動作，動作中產生的事件以新狀態處理
+void dispatchEvent(AppEvent event) {
+  for (size_t i = 0; i < sizeof(transitions) / sizeof(transitions[0]); i++) {
+    const Transition &t = transitions[i];
+    if (t.from == currentState && t.event == event) {
+      currentState = t.to;
+      t.action();
       return;
     }
+  }
+}
+
+// 計時輪 callback（在 loop() 中由 appTimers.advance() 呼叫）
+void onLotteryTimeout(void *arg) {
+  dispatchEvent(EVENT_LOTTERY_TIMEOUT);
+}
+
+void onPlaybackTimeout(void *arg) {
+  Serial.println("⚠️  播放超過 30 秒，不再等待");
+  dispatchEvent(EVENT_PLAYBACK_DONE);
+}
+
+void onLotteryCountdown(void *arg) {
+  printLotteryRemaining();
+  // 最後一次顯示 10 秒，時間到由逾時計時器處理（多留半格，計時器晚幾毫秒也不會多顯示 0 秒）
+  unsigned long remaining = LOTTERY_TIMEOUT - (millis() - lotteryStartTime);
+  if (remaining > LOTTERY_COUNTDOWN_INTERVAL + LOTTERY_COUNTDOWN_INTERVAL / 2) {
+    appTimers.start(lotteryCountdownTimer, LOTTERY_COUNTDOWN_INTERVAL, millis());
+  }
+}
+
+// ========== 狀態機：每個狀態在 loop() 中要做的事 ==========
+
+// 正常模式：處理按鈕輸入
+void updateNormal(unsigned long currentTime) {
+  // 讀取按鈕狀態（黃色按鈕在 NORMAL 模式下不處理）
+  bool button3Current = (digitalRead(BUTTON_3) == HIGH);  // 紅色按鈕
+  bool button4Current = (digitalRead(BUTTON_4) == HIGH);  // 綠色按鈕
+  bool button5Current = (digitalRead(BUTTON_5) == HIGH);  // 藍色按鈕
+  
+  // 偵測紅色按鈕按下瞬間
+  if (button3Current == HIGH && lastButton3State == LOW) {
+    redLedState = !redLedState;
+    Serial.print("[紅色按鈕] 紅燈 -> ");
+    Serial.println(redLedState ? "開啟" : "關閉");
+    eventLogRecord(LOG_TASK_TOGGLE, 0 | (redLedState ? 0x80 : 0));
+    playJingle(redLedState ? CHIME_ON_MELODY : CHIME_OFF_MELODY);
+    lastActivityTime = currentTime;
+    delay(DEBOUNCE_DELAY);
+  }
+  lastButton3State = button3Current;
+  
+  // 偵測綠色按鈕按下瞬間
+  if (button4Current == HIGH && lastButton4State == LOW) {
+    greenLedState = !greenLedState;
+    Serial.print("[綠色按鈕] 綠燈 -> ");
+    Serial.println(greenLedState ? "開啟" : "關閉");
+    eventLogRecord(LOG_TASK_TOGGLE, 1 | (greenLedState ? 0x80 : 0));
+    playJingle(greenLedState ? CHIME_ON_MELODY : CHIME_OFF_MELODY);
+    lastActivityTime = currentTime;
+    delay(DEBOUNCE_DELAY);
+  }
+  lastButton4State = button4Current;
+  
+  // 偵測藍色按鈕按下瞬間
+  if (button5Current == HIGH && lastButton5State == LOW) {
+    blueLedState = !blueLedState;
+    Serial.print("[藍色按鈕] 藍燈 -> ");
+    Serial.println(blueLedState ? "開啟" : "關閉");
+    eventLogRecord(LOG_TASK_TOGGLE, 2 | (blueLedState ? 0x80 : 0));
+    playJingle(blueLedState ? CHIME_ON_MELODY : CHIME_OFF_MELODY);
+    lastActivityTime = currentTime;
+    delay(DEBOUNCE_DELAY);
+  }
+  lastButton5State = button5Current;
+  
+  // 根據燈光狀態設定RGB（播放音檔時保持藍燈）
+  if (!isPlayingClip()) {
+    int red = redLedState ? 255 : 0;
+    int green = greenLedState ? 255 : 0;
+    int blue = blueLedState ? 255 : 0;
+    setRGB(red, green, blue);
+  }
+  
+  // 檢查是否三燈全亮
+  bool allLightsOn = redLedState && greenLedState && blueLedState;
+  if (allLightsOn && !allLightsWereOn) {
+    allLightsWereOn = true;
+    dispatchEvent(EVENT_ALL_LIGHTS_ON);
+  }
+  if (!allLightsOn) {
+    allLightsWereOn = false;
+  }
+}
+
+// 抽籤階段：燈光秀 + 等待黃色按鈕（逾時由計時器觸發）
+void updateLottery(unsigned long currentTime) {
+  unsigned long elapsed = currentTime - lotteryStartTime;
+  warmRewardClip();
+  
+  // 華麗的燈光秀效果（8秒循環，重複播放）
+  // 移除頻閃，保留彩虹循環 + 快速彩虹 + 呼吸淡出
+  unsigned long cycleTime = elapsed % 8000;  // 8秒循環
+  
+  if (cycleTime < 3000) {
+    // 階段1：彩虹循環（0-3秒）
+    int colorPos = (cycleTime * 256 / 3000) % 256;
+    showRainbow(colorPos, 65535);
     
-    // 顯示剩餘時間（每10秒更新一次）
-    static unsigned long lastCountdown = 0;
-    if (currentTime - lastCountdown >= 10000) {
-      int remainingSeconds = remaining / 1000;
-      Serial.print("⏰ 抽籤剩餘時間：");
-      Serial.print(remainingSeconds);
-      Serial.println(" 秒");
-      lastCountdown = currentTime;
-    }
-    
-    // 華麗的燈光秀效果（8秒循環，重複播放）
-    // 移除頻閃，保留彩虹循環 + 快速彩虹 + 呼吸淡出
-    unsigned long cycleTime = elapsed % 8000;  // 8秒循環
-    int r = 0, g = 0, b = 0;
-    
-    if (cycleTime < 3000) {
-      // 階段1：彩虹循環（0-3秒）
-      int colorPos = (cycleTime * 256 / 3000) % 256;
-      getRainbowColor(colorPos, r, g, b);
-      
-    } else if (cycleTime < 6000) {
-      // 階段2：快速彩虹（3-6秒）
-      int colorPos = ((cycleTime - 3000) * 512 / 3000) % 256;
-      getRainbowColor(colorPos, r, g, b);
-      
-    } else {
-      // 階段3：呼吸燈彩虹（6-8秒）
-      int fadeTime = cycleTime - 6000;
-      int brightness = 255 - (fadeTime * 128 / 2000);  // 淡到50%而非全暗
-      brightness = max(128, brightness);
-      
-      int colorPos = (cycleTime / 10) % 256;
-      getRainbowColor(colorPos, r, g, b);
-      r = (r * brightness) / 255;
-      g = (g * brightness) / 255;
-      b = (b * brightness) / 255;
-    }
-    
-    setRGB(r, g, b);
-    
-    // 檢查黃色按鈕
-    bool button1Current = (digitalRead(BUTTON_1) == HIGH);
+  } else if (cycleTime < 6000) {
+    // 階段2：快速彩虹（3-6秒）
+    int colorPos = ((cycleTime - 3000) * 512 / 3000) % 256;
+    showRainbow(colorPos, 65535);
     
-    if (button1Current == HIGH && lastButton1State == LOW && !lotteryUsed) {
-      // 黃色按鈕按下且尚未使用
-      Serial.println("\n========================================");
-      Serial.println("🎲 黃色按鈕按下，開始抽籤！");
-      Serial.println("========================================");
-      
-      lotteryUsed = true;  // 標記已使用
-      
-      if (bluetoothConnected && audioFileReady) {
-        String selectedFile = selectAudioFile();
-        if (selectedFile != "") {
-          playAudioFile(selectedFile);
-          
-          // 等待播放完成（最多等30秒）
-          unsigned long playStartTime = millis();
-          while (isPlaying && (millis() - playStartTime < 30000)) {
-            delay(100);
-          }
-        }
-      } else {
-        Serial.println("⚠️  藍牙未連接或無音檔，跳過播放");
-      }
-      
-      // 播放完成後重置
-      Serial.println("\n========================================");
-      Serial.println("🌙 抽籤完成，所有燈已重置");
-      Serial.println("========================================\n");
-      
-      setRGB(0, 0, 0);
-      redLedState = false;
-      greenLedState = false;
-      blueLedState = false;
-      allLightsWereOn = false;
-      lotteryAvailable = false;
-      lotteryUsed = false;
-      currentState = NORMAL;
-    }
+  } else {
+    // 階段3：呼吸燈彩虹（6-8秒）
+    int fadeTime = cycleTime - 6000;
+    long brightness = 65535 - (fadeTime * 32768L / 2000);  // 淡到50%而非全暗
+    brightness = max(32768L, brightness);
     
-    lastButton1State = button1Current;
+    int colorPos = (cycleTime / 10) % 256;
+    showBreathingRainbow(colorPos, brightness, cycleTime);
   }
   
-  delay(10);  // 短暫延遲，避免CPU空轉
+  // 檢查黃色按鈕（抽完立即回到 NORMAL，每次抽籤階段只能抽一次）
+  bool button1Current = (digitalRead(BUTTON_1) == HIGH);
+  if (button1Current == HIGH && lastButton1State == LOW) {
+    dispatchEvent(EVENT_DRAW);
+  }
+  lastButton1State = button1Current;
+}
+
+// 播放抽中的音檔：按鈕不處理，loop() 其他工作照常（播完由 serviceAudioEvents() 送出事件）
+void updatePlaying(unsigned long currentTime) {
+}
+
+typedef void (*StateHandler)(unsigned long currentTime);
+const StateHandler stateHandlers[STATE_COUNT] = {
+  updateNormal,   // NORMAL
+  updateLottery,  // LOTTERY
+  updatePlaying   // PLAYING
+};
+
+void loop() {
+  unsigned long currentTime = millis();
+  AppState loopState = currentState;  // 動作中會切換狀態，卡住時記錄進入時的狀態
+  loopWatchStart();
+  
+  // 上傳音檔時序列埠只收封包，也不進入休眠
+  bool uploading = serialUploadService(currentTime);
+  if (uploading) {
+    lastActivityTime = currentTime;
+  } else {
+    handleSerialCommand();
+  }
+  serviceAudioEvents();
+  eventLogService(currentTime);
+  heapWatchSample(currentTime);
+  voiceService(currentTime);
+  
+  // 播放音檔或抽籤燈光動畫時使用最高頻率
+  cpuScalingUpdate(isPlaying || currentState == LOTTERY);
+  
+  // 藍牙斷線時在背景重新連線，連上後播放排隊中的音檔
+  btLinkService(currentTime);
+  servicePendingClip(currentTime);
+  
+#if LED_OUTPUT == LED_OUTPUT_WS2812
+  // 送出上一幀傳送中被延後的燈條畫面
+  ws2812Service();
+#endif
+  
+  // 到期的計時器（抽籤逾時、倒數顯示）
+  appTimers.advance(currentTime);
+  
+  // 根據當前狀態執行不同邏輯
+  stateHandlers[currentState](currentTime);
+  
+  // 閒置時休眠；否則短暫延遲，避免CPU空轉（都不算在 loop() 延遲內）
+  loopWatchEnd(stateNames[loopState]);
+  if (!enterIdleSleepIfQuiet(currentTime)) {
+    delay(uploading ? 1 : 10);  // 上傳中縮短，每個封包的回覆不用多等 10ms
+  }
 }
@@ -0,0 +1,94 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+// ========== 像素運算（整批處理）==========
+// 多顆 LED 的燈光效果每幀要處理整條燈條，逐色 (c * brightness) / 255 每顆就要三次除法。
+// 這裡的函式一次處理整個緩衝區，全部用「乘法 + 右移」取代除法：
+//   c * (scale + 1) >> 8   scale = 255 時結果不變、0 時為 0，其餘與 /255 最多差 1
+
+struct PixelColor {
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+};
+
+// 單一顏色乘上亮度（0-255）
+inline PixelColor pixelScaled(PixelColor c, uint8_t scale) {
+  uint16_t s = scale + 1;
+  PixelColor out = {(uint8_t)((c.r * s) >> 8), (uint8_t)((c.g * s) >> 8), (uint8_t)((c.b * s) >> 8)};
+  return out;
+}
+
+// 整批乘上亮度（0-255，255 = 不變）
+inline void pixelScale(PixelColor *pixels, size_t count, uint8_t scale) {
+  uint16_t s = scale + 1;
+  for (size_t i = 0; i < count; i++) {
+    pixels[i].r = (pixels[i].r * s) >> 8;
+    pixels[i].g = (pixels[i].g * s) >> 8;
+    pixels[i].b = (pixels[i].b * s) >> 8;
+  }
+}
+
+// 淡出：每次呼叫減少 amount/256 的亮度，amount > 0 時最後一定會到全暗
+//（pixelScale(255) 不會改變顏色，不能用來做逐幀淡出）
+inline void pixelFadeToBlack(PixelColor *pixels, size_t count, uint8_t amount) {
+  uint16_t keep = 256 - amount;
+  for (size_t i = 0; i < count; i++) {
+    pixels[i].r = (pixels[i].r * keep) >> 8;
+    pixels[i].g = (pixels[i].g * keep) >> 8;
+    pixels[i].b = (pixels[i].b * keep) >> 8;
+  }
+}
+
+// 疊加：dst += src，超過 255 時停在 255
+inline void pixelAddSat(PixelColor *dst, const PixelColor *src, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    uint16_t r = dst[i].r + src[i].r;
+    uint16_t g = dst[i].g + src[i].g;
+    uint16_t b = dst[i].b + src[i].b;
+    dst[i].r = r > 255 ? 255 : r;
+    dst[i].g = g > 255 ? 255 : g;
+    dst[i].b = b > 255 ? 255 : b;
+  }
+}
+
+// 混色：dst = a 與 b 之間，t = 0 為 a、255 為 b（dst 可以等於 a 或 b）
+inline void pixelLerp(PixelColor *dst, const PixelColor *a, const PixelColor *b, size_t count, uint8_t t) {
+  uint16_t wb = t + (t >> 7);  // 0-255 對應到 0-256
+  uint16_t wa = 256 - wb;
+  for (size_t i = 0; i < count; i++) {
+    dst[i].r = (a[i].r * wa + b[i].r * wb) >> 8;
+    dst[i].g = (a[i].g * wa + b[i].g * wb) >> 8;
+    dst[i].b = (a[i].b * wa + b[i].b * wb) >> 8;
+  }
+}
+
+// 色相旋轉：繞灰階軸旋轉 shift/256 圈（亮度大致不變）
+// 旋轉矩陣每次呼叫只算一次（Q12），每顆 LED 只有整數乘加
+inline void pixelHueRotate(PixelColor *pixels, size_t count, uint8_t shift) {
+  float angle = shift * (2.0f * (float)M_PI / 256.0f);
+  float c = cosf(angle);
+  float s = sinf(angle) * 0.57735027f;  // sin / sqrt(3)
+  float third = (1.0f - c) / 3.0f;
+  int32_t m0 = (int32_t)lroundf((c + third) * 4096.0f);
+  int32_t m1 = (int32_t)lroundf((third - s) * 4096.0f);
+  int32_t m2 = (int32_t)lroundf((third + s) * 4096.0f);
+
+  for (size_t i = 0; i < count; i++) {
+    int32_t r = pixels[i].r;
+    int32_t g = pixels[i].g;
+    int32_t b = pixels[i].b;
+    int32_t nr = (r * m0 + g * m1 + b * m2 + 2048) >> 12;
+    int32_t ng = (r * m2 + g * m0 + b * m1 + 2048) >> 12;
+    int32_t nb = (r * m1 + g * m2 + b * m0 + 2048) >> 12;
+    pixels[i].r = nr < 0 ? 0 : (nr > 255 ? 255 : nr);
+    pixels[i].g = ng < 0 ? 0 : (ng > 255 ? 255 : ng);
+    pixels[i].b = nb < 0 ? 0 : (nb > 255 ? 255 : nb);
+  }
+}
+
+#endif
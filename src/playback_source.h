@@ -0,0 +1,84 @@
+#ifndef PLAYBACK_SOURCE_H
+#define PLAYBACK_SOURCE_H
+
+#include "audio_source.h"
+#include "synth.h"
+
+// ========== 目前播放的音源 ==========
+// 音檔（串流 / 記憶體）、測試音與合成旋律共用同一個播放入口，
+// 音頻回調每個區塊只做一次 switch。
+template <typename Reader>
+class PlaybackSource {
+ public:
+  enum Kind { SOURCE_NONE, SOURCE_STREAM, SOURCE_MEMORY, SOURCE_TONE, SOURCE_SYNTH };
+
+  // 串流播放 16-bit 單聲道音檔（預讀大小依 readClock 量測的讀取速度調整，見 read_ahead.h）
+  // 從 reader 目前的位置播放到 endPos，樣本乘上 gain（Q12）
+  void playStream(Reader *reader, uint32_t rate, uint16_t gain = AUDIO_GAIN_UNITY,
+                  uint32_t endPos = UINT32_MAX) {
+    stop();
+    stream.begin(reader, rate * sizeof(int16_t), readClock, endPos);
+    start(SOURCE_STREAM, rate, gain);
+  }
+
+  void playMemory(const int16_t *samples, size_t count, uint32_t rate, uint16_t gain = AUDIO_GAIN_UNITY) {
+    stop();
+    memory.begin(samples, count);
+    start(SOURCE_MEMORY, rate, gain);
+  }
+
+  void playTone(uint32_t frequency, uint32_t rate, uint32_t durationMs, int16_t amplitude) {
+    stop();
+    tone.begin(frequency, rate, durationMs, amplitude);
+    start(SOURCE_TONE, rate);
+  }
+
+  // 合成旋律（格式見 synth.h），melody 必須在播放期間保持有效
+  void playSynth(const char *melody, uint32_t rate) {
+    stop();
+    synth.begin(melody, rate);
+    start(SOURCE_SYNTH, rate);
+  }
+
+  // 停止並釋放音源（檔案串流會關檔）
+  void stop() {
+    if (kind == SOURCE_STREAM) stream.end();
+    kind = SOURCE_NONE;
+  }
+
+  size_t pull(int16_t *dst, size_t n) {
+    size_t got;
+    switch (kind) {
+      case SOURCE_STREAM: got = stream.pull(dst, n); break;
+      case SOURCE_MEMORY: got = memory.pull(dst, n); break;
+      case SOURCE_TONE: return tone.pull(dst, n);
+      case SOURCE_SYNTH: return synth.pull(dst, n);
+      default: return 0;
+    }
+    if (gain != AUDIO_GAIN_UNITY) applyGain(dst, got, gain);
+    return got;
+  }
+
+  // 串流讀取統計（跨音檔累計）
+  const ReadAheadPolicy &readAhead() const { return stream.readAhead(); }
+  void resetReadStats() { stream.readAhead().resetStats(); }
+
+  Kind kind = SOURCE_NONE;
+  uint32_t sampleRate = 0;
+  ReadAheadClock readClock = NULL;  // 量測讀檔耗時用的時鐘（微秒）
+
+ private:
+  void start(Kind newKind, uint32_t rate, uint16_t newGain = AUDIO_GAIN_UNITY) {
+    sampleRate = rate;
+    gain = newGain;
+    kind = newKind;
+  }
+
+  uint16_t gain = AUDIO_GAIN_UNITY;
+  StreamSource<Reader> stream;
+  MemorySource memory;
+  ToneSource tone;
+  SynthSource synth;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include "power_idle.h"
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include <driver/uart.h>
+
+// 休眠統計
+static uint32_t sleepCount = 0;
+static uint32_t buttonWakeCount = 0;
+static uint64_t totalSleepUs = 0;
+
+// 喚醒延遲（按鈕喚醒 → 第一次 setRGB）
+static int64_t buttonWakeTime = 0;   // 0 表示沒有待量測的喚醒
+static uint32_t latencyCount = 0;
+static uint32_t latencyMinUs = UINT32_MAX;
+static uint32_t latencyMaxUs = 0;
+static uint64_t latencySumUs = 0;
+
+void idleBegin(const uint8_t *wakePins, int count) {
+  // 按鈕模組按下時輸出高電位
+  for (int i = 0; i < count; i++) {
+    gpio_wakeup_enable((gpio_num_t)wakePins[i], GPIO_INTR_HIGH_LEVEL);
+  }
+  esp_sleep_enable_gpio_wakeup();
+
+  // 序列埠收到字元也喚醒（前幾個字元會遺失，指令可能需要多送一次）
+  uart_set_wakeup_threshold(UART_NUM_0, 3);
+  esp_sleep_enable_uart_wakeup(UART_NUM_0);
+
+  esp_sleep_enable_timer_wakeup((uint64_t)IDLE_SLEEP_MAX_MS * 1000);
+}
+
+void idleLightSleep() {
+  Serial.flush();  // 避免休眠時 UART 輸出被截斷
+
+  int64_t sleepStart = esp_timer_get_time();
+  esp_light_sleep_start();
+  int64_t wakeTime = esp_timer_get_time();
+
+  sleepCount++;
+  totalSleepUs += wakeTime - sleepStart;
+
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) {
+    buttonWakeCount++;
+    buttonWakeTime = wakeTime;
+  }
+}
+
+void idleNoteLedUpdate() {
+  if (buttonWakeTime == 0) {
+    return;
+  }
+
+  uint32_t latency = (uint32_t)(esp_timer_get_time() - buttonWakeTime);
+  buttonWakeTime = 0;
+
+  latencyCount++;
+  latencySumUs += latency;
+  if (latency < latencyMinUs) latencyMinUs = latency;
+  if (latency > latencyMaxUs) latencyMaxUs = latency;
+}
+
+void idlePrintStats(Print &out) {
+  out.println("【閒置休眠統計】");
+  out.print("  休眠次數: ");
+  out.print(sleepCount);
+  out.print("（按鈕喚醒 ");
+  out.print(buttonWakeCount);
+  out.println(" 次）");
+  out.print("  累計休眠: ");
+  out.print((unsigned long)(totalSleepUs / 1000000));
+  out.print(" 秒 / 開機 ");
+  out.print(millis() / 1000);
+  out.println(" 秒");
+
+  if (latencyCount > 0) {
+    out.print("  喚醒→燈光更新: 最小 ");
+    out.print(latencyMinUs);
+    out.print(" us，平均 ");
+    out.print((unsigned long)(latencySumUs / latencyCount));
+    out.print(" us，最大 ");
+    out.print(latencyMaxUs);
+    out.println(" us");
+  } else {
+    out.println("  喚醒→燈光更新: 尚無資料");
+  }
+}
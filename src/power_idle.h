@@ -0,0 +1,18 @@
+#ifndef POWER_IDLE_H
+#define POWER_IDLE_H
+
+#include <Arduino.h>
+#include "idle_policy.h"
+
+// ========== 閒置省電（light sleep）==========
+// 按鈕（高電位）、序列埠輸入或計時器都會喚醒。
+// 計時器確保 loop() 仍會定期執行（例如事件紀錄寫入）。
+
+#define IDLE_SLEEP_MAX_MS 1000  // 單次休眠上限
+
+void idleBegin(const uint8_t *wakePins, int count);
+void idleLightSleep();         // 進入 light sleep，直到被喚醒才返回
+void idleNoteLedUpdate();      // 由 setRGB() 呼叫，量測「喚醒 → 第一次更新燈光」延遲
+void idlePrintStats(Print &out);
+
+#endif
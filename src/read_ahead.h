@@ -0,0 +1,93 @@
+#ifndef READ_AHEAD_H
+#define READ_AHEAD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ========== 音檔預讀（自動調整每次讀取大小）==========
+// 每次讀檔都有固定的檔案系統成本，讀得越少次越省；但讀取在音源 task 中進行（見 task_layout.h），
+// 一次讀太多會拖慢環形緩衝區的補充（TASK_LAYOUT_INLINE 時在音頻回調中讀，還會讓回調超時，
+// 44.1kHz 每 512 frames 約 11.6ms）。
+// 每次讀取後量測耗時：夠快就加倍、太慢就減半，範圍在 READ_AHEAD_MIN ~ 記憶體上限之間，
+// 也不超過 READ_AHEAD_HORIZON_MS 的播放量（低取樣率的音檔不需要一次讀很多）。
+// 每次讀取都結束在檔案位置為讀取大小（2 的次方）整數倍的地方，讀取大小固定時每次都是完整的一塊。
+// 這是檔案中的位置，SPIFFS / LittleFS 不保證對應到 flash sector 的邊界。
+
+#define READ_AHEAD_CEILING 4096      // 讀取大小的絕對上限（4KB）
+#define READ_AHEAD_MIN 512           // 最小讀取大小（原本固定的緩衝區大小）
+#ifndef READ_AHEAD_MAX
+#define READ_AHEAD_MAX 4096          // 預讀緩衝區大小（記憶體上限，2 的次方，最大 READ_AHEAD_CEILING）
+#endif
+static_assert((READ_AHEAD_MAX & (READ_AHEAD_MAX - 1)) == 0 && READ_AHEAD_MAX >= READ_AHEAD_MIN &&
+                  READ_AHEAD_MAX <= READ_AHEAD_CEILING,
+              "READ_AHEAD_MAX 必須是 2 的次方，介於 READ_AHEAD_MIN 與 READ_AHEAD_CEILING 之間");
+
+#define READ_AHEAD_BUDGET_US 2000    // 單次讀取的時間預算
+#define READ_AHEAD_HORIZON_MS 500    // 一次最多讀這麼久的播放量
+
+// 量測讀取耗時用的時鐘（微秒），NULL 表示不量測、固定最小讀取大小
+typedef uint32_t (*ReadAheadClock)();
+
+// 讀取統計（跨音檔累計）
+struct ReadAheadStats {
+  uint32_t reads;
+  uint64_t bytes;
+  uint64_t readUs;
+  uint32_t maxReadUs;
+  uint32_t grows;
+  uint32_t shrinks;
+};
+
+class ReadAheadPolicy {
+ public:
+  // 開始新的音檔，bytesPerSec 為播放速度（16-bit 單聲道 = 取樣率 × 2）
+  void begin(uint32_t bytesPerSec, ReadAheadClock clock) {
+    this->clock = clock;
+    limit = READ_AHEAD_MIN;
+    uint64_t horizon = (uint64_t)bytesPerSec * READ_AHEAD_HORIZON_MS / 1000;
+    while (limit * 2 <= READ_AHEAD_MAX && limit * 2 <= horizon) limit *= 2;
+    if (chunk < READ_AHEAD_MIN) chunk = READ_AHEAD_MIN;  // 沿用上一個音檔學到的大小
+    if (chunk > limit) chunk = limit;
+  }
+
+  // 檔案位置 pos 這次要讀幾個 bytes（讀到下一個 chunk 邊界為止）
+  size_t nextReadSize(uint32_t pos) const {
+    return chunk - (pos & (chunk - 1));
+  }
+
+  uint32_t startRead() const {
+    return clock != NULL ? clock() : 0;
+  }
+
+  // 讀完後記錄並調整下一次的大小
+  void finishRead(uint32_t startUs, size_t bytes) {
+    stats.reads++;
+    stats.bytes += bytes;
+    if (clock == NULL) return;
+
+    uint32_t us = clock() - startUs;
+    stats.readUs += us;
+    if (us > stats.maxReadUs) stats.maxReadUs = us;
+
+    if (us > READ_AHEAD_BUDGET_US && chunk > READ_AHEAD_MIN) {
+      chunk /= 2;
+      stats.shrinks++;
+    } else if (us < READ_AHEAD_BUDGET_US / 2 && chunk * 2 <= limit && bytes == chunk) {
+      // 只看完整大小的讀取（對齊用的零頭太短，量不出真正的速度）
+      chunk *= 2;
+      stats.grows++;
+    }
+  }
+
+  size_t chunkSize() const { return chunk; }
+  const ReadAheadStats &readStats() const { return stats; }
+  void resetStats() { stats = ReadAheadStats(); }
+
+ private:
+  ReadAheadClock clock = NULL;
+  size_t chunk = READ_AHEAD_MIN;
+  size_t limit = READ_AHEAD_MIN;
+  ReadAheadStats stats = ReadAheadStats();
+};
+
+#endif
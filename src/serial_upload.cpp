@@ -0,0 +1,300 @@
+#include "serial_upload.h"
+#include "heap_watch.h"
+#include "clip_meta.h"
+#include "crc32.h"
+
+#define FRAME_SYNC0 0xA5
+#define FRAME_SYNC1 0x5A
+#define FRAME_HEADER 5                                    // 類型、序號、長度
+#define FRAME_PAYLOAD_MAX (4 + UPLOAD_CHUNK)              // 資料封包：offset + 資料
+#define FRAME_MAX (FRAME_HEADER + FRAME_PAYLOAD_MAX + 4)  // 同步之後的部分
+#define REPLY_TYPE 'K'
+#define BAUD_SWITCH_MS 50  // 切換鮑率後等電腦端也切換好再印訊息
+
+static UploadHook beforeWriteHook = NULL;
+static UploadHook afterUploadHook = NULL;
+
+static bool active = false;
+static unsigned long startedAt = 0;
+static unsigned long lastFrameAt = 0;
+static unsigned long lastByteAt = 0;
+
+// 接收中的封包（同步之後）
+enum ParseState { WAIT_SYNC0, WAIT_SYNC1, READ_FRAME };
+static ParseState parseState = WAIT_SYNC0;
+static uint8_t frame[FRAME_MAX];
+static size_t frameLen = 0;
+static size_t frameNeed = 0;
+
+// 上一個處理過的封包（重複收到時只重送回覆）
+static bool haveLast = false;
+static uint8_t lastType = 0;
+static uint16_t lastSeq = 0;
+static uint8_t lastStatus = UPLOAD_OK;
+static uint32_t lastValue = 0;
+
+// 寫入中的檔案
+static ClipWriter *writer = NULL;
+static uint32_t fileSize = 0;
+static uint32_t fileCrc = 0;
+static uint32_t received = 0;
+static uint32_t receivedCrc = 0;
+
+// 這次上傳
+static bool stoppedPlayback = false;
+static uint16_t filesDone = 0;
+static uint32_t bytesDone = 0;
+static uint32_t resends = 0;  // 收到壞封包或重複封包的次數
+
+static inline uint16_t readLe16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t readLe32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void writeLe32(uint8_t *p, uint32_t value) {
+  p[0] = (uint8_t)value;
+  p[1] = (uint8_t)(value >> 8);
+  p[2] = (uint8_t)(value >> 16);
+  p[3] = (uint8_t)(value >> 24);
+}
+
+static void sendReply(uint16_t seq, uint8_t status, uint32_t value) {
+  uint8_t out[2 + FRAME_HEADER + 5 + 4];
+  out[0] = FRAME_SYNC0;
+  out[1] = FRAME_SYNC1;
+  out[2] = REPLY_TYPE;
+  out[3] = (uint8_t)seq;
+  out[4] = (uint8_t)(seq >> 8);
+  out[5] = 5;
+  out[6] = 0;
+  out[7] = status;
+  writeLe32(out + 8, value);
+  writeLe32(out + 12, crc32Update(0, out + 2, FRAME_HEADER + 5));
+  Serial.write(out, sizeof(out));
+}
+
+static void abortFile() {
+  if (writer != NULL) {
+    writer->abort();
+    writer = NULL;
+  }
+}
+
+// 只接受音檔與播放資訊，不能有子資料夾
+static bool validName(const char *name) {
+  size_t len = strlen(name);
+  if (len == 0 || len > UPLOAD_NAME_MAX || strchr(name, '/') != NULL) return false;
+  if (strcmp(name, CLIP_META_FILE) == 0) return true;
+  return len > 4 && strcmp(name + len - 4, ".wav") == 0;
+}
+
+static uint8_t beginFile(const uint8_t *payload, uint16_t len) {
+  if (len != CLIP_NAME_LEN + 8 || memchr(payload, 0, CLIP_NAME_LEN) == NULL) return UPLOAD_BAD_FRAME;
+  const char *name = (const char *)payload;
+  if (!validName(name)) return UPLOAD_BAD_NAME;
+
+  abortFile();
+  ClipStorage &storage = clipStorage();
+  if (!storage.writable()) return UPLOAD_UNSUPPORTED;
+  if (!stoppedPlayback) {
+    if (beforeWriteHook != NULL) beforeWriteHook();
+    stoppedPlayback = true;
+  }
+
+  writer = storage.create(name);
+  if (writer == NULL) return UPLOAD_WRITE_FAILED;
+  fileSize = readLe32(payload + CLIP_NAME_LEN);
+  fileCrc = readLe32(payload + CLIP_NAME_LEN + 4);
+  received = 0;
+  receivedCrc = 0;
+  return UPLOAD_OK;
+}
+
+static uint8_t writeData(const uint8_t *payload, uint16_t len, uint32_t &value) {
+  if (writer == NULL) return UPLOAD_BAD_STATE;
+  if (len < 4) return UPLOAD_BAD_FRAME;
+
+  value = received;
+  uint32_t offset = readLe32(payload);
+  uint16_t count = len - 4;
+  if (offset != received || count > fileSize - received) return UPLOAD_BAD_OFFSET;
+
+  if (writer->write(payload + 4, count) != count) {
+    abortFile();
+    return UPLOAD_WRITE_FAILED;
+  }
+  receivedCrc = crc32Update(receivedCrc, payload + 4, count);
+  received += count;
+  value = received;
+  return UPLOAD_OK;
+}
+
+static uint8_t endFile(uint32_t &value) {
+  if (writer == NULL) return UPLOAD_BAD_STATE;
+  value = received;
+  if (received != fileSize) return UPLOAD_BAD_OFFSET;
+  if (receivedCrc != fileCrc) {
+    abortFile();
+    return UPLOAD_BAD_CHECKSUM;
+  }
+
+  bool committed = writer->commit();
+  writer = NULL;
+  if (!committed) return UPLOAD_WRITE_FAILED;
+  filesDone++;
+  bytesDone += fileSize;
+  return UPLOAD_OK;
+}
+
+// 回到平常的鮑率；有新檔案時交給 afterUpload 重新掃描
+static void finishUpload(const char *reason) {
+  abortFile();
+  active = false;
+  Serial.flush();
+  Serial.updateBaudRate(SERIAL_BAUD);
+  delay(BAUD_SWITCH_MS);
+
+  unsigned long elapsed = millis() - startedAt;
+  printfNoAlloc(Serial, "\n📥 上傳結束（%s）：%u 個檔案，%lu bytes，%lu.%lu 秒", reason, (unsigned)filesDone,
+                        (unsigned long)bytesDone, elapsed / 1000, elapsed % 1000 / 100);
+  if (elapsed > 0 && bytesDone > 0) {
+    printfNoAlloc(Serial, "，%lu KB/s", (unsigned long)((uint64_t)bytesDone * 1000 / elapsed / 1024));
+  }
+  printfNoAlloc(Serial, "，重送 %lu 次\n", (unsigned long)resends);
+
+  if (filesDone > 0 && afterUploadHook != NULL) {
+    afterUploadHook();
+  }
+}
+
+static void handleFrame() {
+  uint8_t type = frame[0];
+  uint16_t seq = readLe16(frame + 1);
+  uint16_t len = readLe16(frame + 3);
+  const uint8_t *payload = frame + FRAME_HEADER;
+
+  if (crc32Update(0, frame, FRAME_HEADER + len) != readLe32(payload + len)) {
+    resends++;
+    sendReply(seq, UPLOAD_BAD_FRAME, 0);
+    return;
+  }
+  if (haveLast && type == lastType && seq == lastSeq) {
+    resends++;
+    sendReply(seq, lastStatus, lastValue);
+    return;
+  }
+
+  uint8_t status = UPLOAD_OK;
+  uint32_t value = 0;
+  switch (type) {
+    case 'H':
+      value = UPLOAD_CHUNK;
+      break;
+    case 'B':
+      status = beginFile(payload, len);
+      break;
+    case 'D':
+      status = writeData(payload, len, value);
+      break;
+    case 'E':
+      status = endFile(value);
+      break;
+    case 'X':
+      abortFile();
+      break;
+    case 'Q':
+      sendReply(seq, UPLOAD_OK, 0);
+      finishUpload("完成");
+      return;
+    default:
+      status = UPLOAD_BAD_FRAME;
+      break;
+  }
+
+  haveLast = true;
+  lastType = type;
+  lastSeq = seq;
+  lastStatus = status;
+  lastValue = value;
+  sendReply(seq, status, value);
+}
+
+// 收一個 byte，收完一個封包時回傳 true
+static bool feed(uint8_t c) {
+  switch (parseState) {
+    case WAIT_SYNC0:
+      if (c == FRAME_SYNC0) parseState = WAIT_SYNC1;
+      return false;
+    case WAIT_SYNC1:
+      parseState = c == FRAME_SYNC1 ? READ_FRAME : (c == FRAME_SYNC0 ? WAIT_SYNC1 : WAIT_SYNC0);
+      frameLen = 0;
+      frameNeed = FRAME_HEADER;
+      return false;
+    case READ_FRAME:
+      frame[frameLen++] = c;
+      if (frameLen == FRAME_HEADER) {
+        uint16_t len = readLe16(frame + 3);
+        if (len > FRAME_PAYLOAD_MAX) {
+          parseState = WAIT_SYNC0;  // 長度不合理，重新找同步
+          return false;
+        }
+        frameNeed = FRAME_HEADER + len + 4;
+      }
+      if (frameLen < frameNeed) return false;
+      parseState = WAIT_SYNC0;
+      return true;
+  }
+  return false;
+}
+
+void serialUploadBegin(UploadHook beforeWrite, UploadHook afterUpload) {
+  beforeWriteHook = beforeWrite;
+  afterUploadHook = afterUpload;
+}
+
+void serialUploadStart() {
+  printfNoAlloc(Serial, "📥 上傳模式：切換到 %lu bps，請用 tools/upload_clips.py 傳送音檔\n", (unsigned long)UPLOAD_BAUD);
+  printfNoAlloc(Serial, "FTBU %lu\n", (unsigned long)UPLOAD_BAUD);  // 電腦端看到這行就切換鮑率
+  Serial.flush();
+  Serial.updateBaudRate(UPLOAD_BAUD);
+
+  active = true;
+  parseState = WAIT_SYNC0;
+  haveLast = false;
+  stoppedPlayback = false;
+  filesDone = 0;
+  bytesDone = 0;
+  resends = 0;
+  startedAt = lastFrameAt = lastByteAt = millis();
+}
+
+bool serialUploadActive() {
+  return active;
+}
+
+bool serialUploadService(unsigned long now) {
+  if (!active) {
+    return false;
+  }
+
+  // 一次只處理一個封包（電腦端等到回覆才送下一個）
+  while (Serial.available() > 0) {
+    lastByteAt = now;
+    if (feed((uint8_t)Serial.read())) {
+      lastFrameAt = now;
+      handleFrame();
+      return true;
+    }
+  }
+
+  if (parseState != WAIT_SYNC0 && now - lastByteAt > UPLOAD_FRAME_GAP_MS) {
+    parseState = WAIT_SYNC0;
+  }
+  if (now - lastFrameAt > UPLOAD_IDLE_TIMEOUT_MS) {
+    finishUpload("逾時");
+  }
+  return true;
+}
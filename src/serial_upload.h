@@ -0,0 +1,60 @@
+#ifndef SERIAL_UPLOAD_H
+#define SERIAL_UPLOAD_H
+
+#include <Arduino.h>
+#include "clip_storage.h"
+
+// ========== 序列埠上傳音檔 ==========
+// 換音檔不用重新燒錄整個檔案系統（uploadfs）：序列埠指令 U 切換到 UPLOAD_BAUD，
+// 電腦端 tools/upload_clips.py 分段傳送，每段檢查 CRC 後直接寫入儲存後端（不在 RAM 裡暫存整個檔案），
+// 收完後比對整個檔案的 CRC，通過才取代舊檔。結束上傳時重新掃描音檔，不需要重新開機。
+// raw 分區後端不支援寫入（整個分區由 tools/pack_clips.py 產生）。
+//
+// 封包（小端序）：同步 A5 5A、類型(1)、序號(2)、長度(2)、資料、CRC-32（類型到資料結尾）
+// 電腦端 → 裝置：
+//   'H' 開始上傳        回覆 value = 每段資料最多幾 bytes（UPLOAD_CHUNK）
+//   'B' 開始一個檔案    name[32]、size(4)、crc(4)（整個檔案）
+//   'D' 資料            offset(4)、資料
+//   'E' 檔案結束        比對整個檔案的 CRC，通過後取代舊檔
+//   'X' 放棄目前的檔案
+//   'Q' 結束上傳        回到 SERIAL_BAUD，有新檔案時重新掃描
+// 裝置 → 電腦端：'K' 回覆，序號與收到的封包相同，資料為 status(1)、value(4)
+// 一次只送一個封包，等到回覆再送下一個；電腦端逾時或收到 UPLOAD_BAD_FRAME 時用同一個序號重送，
+// 裝置重複收到上一個序號時只重送上次的回覆（回覆遺失不會寫入兩次）。
+
+#define SERIAL_BAUD 115200         // 平常的鮑率（setup() 的 Serial.begin()）
+#ifndef UPLOAD_BAUD
+#define UPLOAD_BAUD 921600
+#endif
+#define UPLOAD_CHUNK 1024          // 每個資料封包最多幾 bytes
+#define UPLOAD_RX_BUFFER 2048      // 序列埠接收緩衝區，放得下一個完整的資料封包
+#define UPLOAD_NAME_MAX 30         // SPIFFS 檔名上限 32（含 / 與結尾 0）
+#define UPLOAD_IDLE_TIMEOUT_MS 10000  // 沒有收到封包就結束上傳（電腦端程式中斷）
+#define UPLOAD_FRAME_GAP_MS 100       // 封包收到一半停頓這麼久就丟掉（長度欄位壞掉時重新同步）
+
+enum UploadStatus : uint8_t {
+  UPLOAD_OK = 0,
+  UPLOAD_BAD_FRAME,     // CRC 錯誤或長度不符，請重送
+  UPLOAD_BAD_STATE,     // 還沒開始檔案就送資料
+  UPLOAD_BAD_OFFSET,    // 位置不連續，value = 下一個應該收到的位置
+  UPLOAD_BAD_NAME,      // 只接受 .wav 與 clips.meta，不能有 /
+  UPLOAD_UNSUPPORTED,   // 儲存後端不能寫入（raw 分區）
+  UPLOAD_WRITE_FAILED,  // 寫入失敗（空間不足）
+  UPLOAD_BAD_CHECKSUM,  // 整個檔案的 CRC 不符，沒有取代舊檔
+};
+
+typedef void (*UploadHook)();
+
+// beforeWrite：第一次寫入前（停止播放、關檔）；afterUpload：結束上傳且有新檔案時（重新掃描音檔）
+void serialUploadBegin(UploadHook beforeWrite, UploadHook afterUpload);
+
+// 序列埠指令 U：切換到 UPLOAD_BAUD，開始接收封包
+void serialUploadStart();
+
+// loop() 每次呼叫，上傳中回傳 true（這時不處理一般的序列埠指令）
+bool serialUploadService(unsigned long now);
+
+// 上傳中（序列埠指令 U 之後到結束上傳）：不開檔、不播放，音檔列表隨時可能重新建立
+bool serialUploadActive();
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <stdint.h>
+
+// ========== 單一生產者、單一消費者的環形緩衝區 ==========
+// 兩邊在不同的 task（可在不同核心）同時存取，不需要鎖：
+// 生產者只寫 head、消費者只寫 tail，位置是不斷遞增的 32-bit 計數（溢位不影響相減）。
+// N 必須是 2 的次方。
+
+template <typename T, uint32_t N>
+class SpscRing {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "N 必須是 2 的次方");
+
+ public:
+  // ---------- 生產者 ----------
+
+  uint32_t space() const { return N - (head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire)); }
+
+  // 放入最多 count 個，回傳實際放入的數量
+  uint32_t push(const T *items, uint32_t count) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t free = N - (head - tail_.load(std::memory_order_acquire));
+    if (count > free) count = free;
+    copyIn(head & (N - 1), items, count);
+    head_.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+  // 目前寫到的位置（生產者暫停時讀取，給消費者 discardTo() 用）
+  uint32_t writePosition() const { return head_.load(std::memory_order_acquire); }
+
+  // ---------- 消費者 ----------
+
+  uint32_t available() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed); }
+
+  // 取出最多 count 個，回傳實際取出的數量
+  uint32_t pop(T *items, uint32_t count) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t ready = head_.load(std::memory_order_acquire) - tail;
+    if (count > ready) count = ready;
+    copyOut(tail & (N - 1), items, count);
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  // 丟掉 position 之前的資料（已經在 position 之後時不動）
+  void discardTo(uint32_t position) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if ((int32_t)(position - tail) > 0) {
+      tail_.store(position, std::memory_order_release);
+    }
+  }
+
+  uint32_t readPosition() const { return tail_.load(std::memory_order_relaxed); }
+
+  static uint32_t capacity() { return N; }
+
+ private:
+  // 跨過結尾時分成兩段連續複製（比逐個取餘數快，編譯器可以向量化）
+  void copyIn(uint32_t at, const T *items, uint32_t count) {
+    uint32_t first = count < N - at ? count : N - at;
+    for (uint32_t i = 0; i < first; i++) items_[at + i] = items[i];
+    for (uint32_t i = first; i < count; i++) items_[i - first] = items[i];
+  }
+
+  void copyOut(uint32_t at, T *items, uint32_t count) const {
+    uint32_t first = count < N - at ? count : N - at;
+    for (uint32_t i = 0; i < first; i++) items[i] = items_[at + i];
+    for (uint32_t i = first; i < count; i++) items[i] = items_[i - first];
+  }
+
+  T items_[N];
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef STATIC_ARENA_H
+#define STATIC_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ========== 固定大小的配置區 ==========
+// 應用程式需要依執行結果決定大小的資料（例如掃描到的音檔檔名）在 setup() 時從這裡切出，
+// 不經過 heap；setup() 結束時 seal()，之後再配置一律失敗（回傳 NULL 並計數），
+// 應用程式自己的資料在 loop() 中不會再配置（檔案系統與 NVS 仍會，見 heap_watch.h）。
+// 配置區本身是全域變數（.bss），編譯時就知道大小。
+
+template <size_t SIZE>
+class StaticArena {
+ public:
+  // 切出 size bytes（對齊 align，需為 2 的次方），空間不足或已 seal() 時回傳 NULL
+  void *alloc(size_t size, size_t align = 4) {
+    size_t start = (used_ + align - 1) & ~(align - 1);
+    if (sealed_ || start > SIZE || size > SIZE - start) {
+      failures_++;
+      return NULL;
+    }
+    used_ = start + size;
+    return buffer_ + start;
+  }
+
+  // 複製字串，prefix 接在前面（例如檔名補上 "/"），失敗回傳 NULL
+  char *copyString(const char *text, const char *prefix = "") {
+    size_t prefixLen = strlen(prefix);
+    size_t textLen = strlen(text);
+    char *copy = (char *)alloc(prefixLen + textLen + 1, 1);
+    if (copy == NULL) return NULL;
+    memcpy(copy, prefix, prefixLen);
+    memcpy(copy + prefixLen, text, textLen + 1);
+    return copy;
+  }
+
+  // 清空重新切（之前切出的指標全部失效），也解除 seal()
+  void reset() {
+    used_ = 0;
+    sealed_ = false;
+  }
+
+  void seal() { sealed_ = true; }
+  bool sealed() const { return sealed_; }
+  size_t used() const { return used_; }
+  size_t capacity() const { return SIZE; }
+  uint32_t failures() const { return failures_; }
+
+ private:
+  alignas(8) uint8_t buffer_[SIZE];
+  size_t used_ = 0;
+  bool sealed_ = false;
+  uint32_t failures_ = 0;
+};
+
+#endif
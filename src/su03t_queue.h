@@ -0,0 +1,196 @@
+#ifndef SU03T_QUEUE_H
+#define SU03T_QUEUE_H
+
+#include <stdint.h>
+
+// ========== SU-03T 語音模組指令佇列 ==========
+// 播報指令排進固定大小的佇列，service() 每次只把 UART 傳送緩衝區放得下的 bytes 交出去
+// （之後由 UART 中斷送出），不會等待；取代原本兩種格式之間的 delay(100)。
+// 模組播報中（busy）不送下一筆，收到播報結束回報或超過 SU03T_BUSY_TIMEOUT_MS 才繼續，
+// 兩筆之間至少間隔 SU03T_GAP_MS（模組解析串口需要時間）。
+//
+// 串口協定（在智能公元平台設定，見 archive/SU03T燒錄步驟.md）：
+//   ESP32 → 模組：AA 55 <播報編號> 55 AA
+//   模組 → ESP32：AA 55 <代碼> 55 AA，代碼 SU03T_EVENT_DONE = 播報結束、SU03T_EVENT_WAKE = 喚醒，
+//                 其他 = 辨識到的語音指令編號（takeCommand()）
+//
+// Uart 需要 availableForWrite()、write(buf, len)、available()、read()（HardwareSerial 或測試用的假 UART）。
+// 時間由呼叫端傳入（millis()），49 天溢位不影響。
+
+#define SU03T_FRAME_LEN 5
+#define SU03T_HEAD0 0xAA
+#define SU03T_HEAD1 0x55
+#define SU03T_TAIL0 0x55
+#define SU03T_TAIL1 0xAA
+#define SU03T_EVENT_DONE 0xF0   // 播報結束
+#define SU03T_EVENT_WAKE 0xF1   // 喚醒詞
+
+#ifndef SU03T_GAP_MS
+#define SU03T_GAP_MS 100             // 兩筆指令之間的最短間隔
+#endif
+#ifndef SU03T_BUSY_TIMEOUT_MS
+#define SU03T_BUSY_TIMEOUT_MS 8000   // 模組沒有回報播報結束時，最長等這麼久
+#endif
+#define SU03T_RX_PER_SERVICE 32      // 每次 service() 最多讀幾個 byte
+
+struct Su03tStats {
+  uint32_t sent;        // 送出的指令
+  uint32_t dropped;     // 佇列滿了丟掉的指令
+  uint32_t done;        // 播報結束回報
+  uint32_t timeouts;    // 沒有回報、逾時視為結束
+  uint32_t commands;    // 辨識到的語音指令
+  uint32_t badFrames;   // 格式錯誤的回報
+  uint32_t maxWaitMs;   // 指令從排入到開始送出的最長時間
+  uint8_t maxPending;   // 佇列最多同時排了幾筆
+};
+
+template <typename Uart, uint8_t N>
+class Su03tQueue {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "N 必須是 2 的次方");
+
+ public:
+  explicit Su03tQueue(Uart &uart) : uart_(uart) {}
+
+  // 排入一筆播報，佇列滿了回傳 false（丟掉這一筆）
+  bool say(uint8_t prompt, uint32_t nowMs) {
+    if (count_ == N) {
+      stats_.dropped++;
+      return false;
+    }
+    Entry &entry = entries_[(head_ + count_) & (N - 1)];
+    entry.prompt = prompt;
+    entry.queuedAt = nowMs;
+    count_++;
+    if (count_ > stats_.maxPending) stats_.maxPending = count_;
+    return true;
+  }
+
+  // 丟掉還沒開始送的指令（送到一半的會送完）
+  void clear() { count_ = 0; }
+
+  // loop() 每次呼叫：讀回報、逾時判斷、送出放得下的 bytes
+  void service(uint32_t nowMs) {
+    receive();
+    if (busy_ && nowMs - busySince_ >= SU03T_BUSY_TIMEOUT_MS) {
+      busy_ = false;
+      stats_.timeouts++;
+    }
+    transmit(nowMs);
+  }
+
+  bool busy() const { return busy_; }
+  bool idle() const { return !busy_ && count_ == 0 && txSent_ == SU03T_FRAME_LEN; }
+  uint8_t pending() const { return count_; }
+  const Su03tStats &stats() const { return stats_; }
+
+  // 模組辨識到的語音指令編號（0 = 沒有），讀取後清除
+  uint8_t takeCommand() {
+    uint8_t command = command_;
+    command_ = 0;
+    return command;
+  }
+
+ private:
+  struct Entry {
+    uint8_t prompt;
+    uint32_t queuedAt;
+  };
+
+  void transmit(uint32_t nowMs) {
+    if (txSent_ == SU03T_FRAME_LEN) {
+      if (count_ == 0 || busy_ || (started_ && nowMs - lastSentAt_ < SU03T_GAP_MS)) return;
+
+      const Entry &entry = entries_[head_];
+      uint32_t waited = nowMs - entry.queuedAt;
+      if (waited > stats_.maxWaitMs) stats_.maxWaitMs = waited;
+      tx_[0] = SU03T_HEAD0;
+      tx_[1] = SU03T_HEAD1;
+      tx_[2] = entry.prompt;
+      tx_[3] = SU03T_TAIL0;
+      tx_[4] = SU03T_TAIL1;
+      txSent_ = 0;
+      head_ = (head_ + 1) & (N - 1);
+      count_--;
+    }
+
+    int room = uart_.availableForWrite();
+    if (room <= 0) return;
+    uint8_t count = SU03T_FRAME_LEN - txSent_;
+    if ((int)count > room) count = (uint8_t)room;
+    txSent_ += (uint8_t)uart_.write(tx_ + txSent_, count);
+
+    if (txSent_ == SU03T_FRAME_LEN) {
+      stats_.sent++;
+      started_ = true;
+      lastSentAt_ = nowMs;
+      busy_ = true;
+      busySince_ = nowMs;
+    }
+  }
+
+  void receive() {
+    for (int i = 0; i < SU03T_RX_PER_SERVICE && uart_.available() > 0; i++) {
+      uint8_t c = (uint8_t)uart_.read();
+      switch (rxLen_) {
+        case 0:
+          if (c == SU03T_HEAD0) rxLen_ = 1;
+          break;
+        case 1:
+          rxLen_ = c == SU03T_HEAD1 ? 2 : (c == SU03T_HEAD0 ? 1 : 0);
+          break;
+        case 2:
+          rxCode_ = c;
+          rxLen_ = 3;
+          break;
+        case 3:
+          if (c == SU03T_TAIL0) {
+            rxLen_ = 4;
+          } else {
+            stats_.badFrames++;
+            rxLen_ = c == SU03T_HEAD0 ? 1 : 0;
+          }
+          break;
+        default:
+          rxLen_ = 0;
+          if (c == SU03T_TAIL1) {
+            handleEvent(rxCode_);
+          } else {
+            stats_.badFrames++;
+            if (c == SU03T_HEAD0) rxLen_ = 1;
+          }
+          break;
+      }
+    }
+  }
+
+  void handleEvent(uint8_t code) {
+    if (code == SU03T_EVENT_DONE) {
+      busy_ = false;
+      stats_.done++;
+    } else if (code != SU03T_EVENT_WAKE && code != 0) {
+      command_ = code;
+      stats_.commands++;
+    }
+  }
+
+  Uart &uart_;
+  Entry entries_[N];
+  uint8_t head_ = 0;
+  uint8_t count_ = 0;
+
+  uint8_t tx_[SU03T_FRAME_LEN];
+  uint8_t txSent_ = SU03T_FRAME_LEN;  // 等於 SU03T_FRAME_LEN 表示沒有送到一半的指令
+  bool started_ = false;              // 送過任何指令（之前不需要等間隔）
+  uint32_t lastSentAt_ = 0;
+
+  bool busy_ = false;
+  uint32_t busySince_ = 0;
+
+  uint8_t rxLen_ = 0;
+  uint8_t rxCode_ = 0;
+  uint8_t command_ = 0;
+
+  Su03tStats stats_ = {};
+};
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "audio_source.h"
+
+// ========== 波表 / FM 合成器 ==========
+// 用簡短的 MML 字串描述旋律，直接合成到 A2DP 串流：
+// 慶祝音效與按鈕提示音不佔 flash 空間，也不需要讀檔。
+// 全部使用整數運算（相位累加器 + 256 點正弦波表 + 2 operator FM）。
+//
+// 旋律格式（MML 子集，空白會被忽略）：
+//   C D E F G A B  音符，可加 # 或 + 升半音、- 降半音，後接長度（4 = 四分音符）與 . 附點
+//   R              休止符，長度規則同音符
+//   O<n>           設定八度 0-8（預設 4，O4 A = 440Hz）
+//   < >            降 / 升一個八度（不超出 0-8）
+//   L<n>           預設長度 1-64（預設 4）
+//   T<n>           速度 BPM（預設 120）
+//   V<n>           音量 0-15（預設 12）
+//   @<n>           音色：0 柔和正弦、1 鐘聲、2 銅管
+// 範例："T160 O5 L16 C E G >C8"（上行琶音）
+
+#define SYNTH_ATTACK_SAMPLES 220    // 約 5ms 起音，避免爆音
+#define SYNTH_RELEASE_SAMPLES 132   // 約 3ms 收尾
+#define SYNTH_OCTAVE_MAX 8          // 八度範圍 0-8（相位步進的位移量不超過 5）
+#define SYNTH_LENGTH_MAX 64         // 最短 64 分音符（長度 0 會變成除以 0）
+
+// 音色參數
+struct SynthVoice {
+  uint16_t modRatio;   // 調變器頻率 / 載波頻率（Q8，256 = 1 倍）
+  uint16_t modDepth;   // 調變深度（相位偏移倍率，0 = 純正弦波；uint16 上限保證不會溢位）
+  uint8_t decayShift;  // 衰減速度：每個樣本 env -= env >> decayShift（0 = 不衰減）
+};
+
+static const SynthVoice SYNTH_VOICES[] = {
+  {256, 0, 0},         // @0 柔和正弦
+  {896, 42000, 13},    // @1 鐘聲：3.5 倍調變器，快速衰減
+  {256, 30000, 15},    // @2 銅管：1 倍調變器，慢衰減
+};
+#define SYNTH_VOICE_COUNT (sizeof(SYNTH_VOICES) / sizeof(SYNTH_VOICES[0]))
+
+class SynthSource : public AudioSource<SynthSource> {
+ public:
+  void begin(const char *melody, uint32_t rate) {
+    table = sineTable();
+    cursor = melody;
+    sampleRate = rate;
+    tempo = 120;
+    octave = 4;
+    defaultLength = 4;
+    volumeGain = 12 * 2184;  // V12（Q15）
+    voice = &SYNTH_VOICES[0];
+    noteLeft = 0;
+    env = 0;
+    sounding = false;
+  }
+
+  size_t pullBlock(int16_t *dst, size_t n) {
+    size_t written = 0;
+    while (written < n) {
+      if (noteLeft == 0 && !nextNote()) break;
+
+      size_t count = n - written;
+      if (count > noteLeft) count = noteLeft;
+      if (sounding) {
+        renderTone(dst + written, count);
+      } else {
+        memset(dst + written, 0, count * sizeof(int16_t));
+      }
+      noteLeft -= count;
+      written += count;
+    }
+    return written;
+  }
+
+ private:
+  // 合成一段音符（最內層迴圈：兩次查表、數次乘法，沒有除法）
+  void renderTone(int16_t *dst, size_t count) {
+    const int32_t depth = voice->modDepth;
+    const uint8_t decay = voice->decayShift;
+
+    for (size_t i = 0; i < count; i++) {
+      // 包絡：起音 → 指數衰減 → 結尾收音
+      if (noteLeft - i <= SYNTH_RELEASE_SAMPLES) {
+        env -= releaseStep;
+        if (env < 0) env = 0;
+      } else if (attackLeft > 0) {
+        env += 32767 / SYNTH_ATTACK_SAMPLES;
+        attackLeft--;
+      } else if (decay != 0) {
+        env -= env >> decay;
+      }
+
+      // FM：調變器輸出加到載波相位
+      int32_t mod = (table[modPhase >> 24] * env) >> 15;
+      int16_t sample = table[(carrierPhase + (uint32_t)(mod * depth)) >> 24];
+      carrierPhase += carrierStep;
+      modPhase += modStep;
+
+      int32_t out = (sample * env) >> 15;
+      dst[i] = (int16_t)((out * volumeGain) >> 15);
+    }
+  }
+
+  static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+  int readNumber(int fallback) {
+    if (!isDigit(*cursor)) return fallback;
+    int value = 0;
+    while (isDigit(*cursor)) value = value * 10 + (*cursor++ - '0');
+    return value;
+  }
+
+  // 音符長度（樣本數）：一拍 = 四分音符
+  uint32_t readDuration() {
+    int length = clamp(readNumber(defaultLength), 1, SYNTH_LENGTH_MAX);
+    uint32_t samples = (uint32_t)((uint64_t)sampleRate * 240 / ((uint32_t)tempo * length));
+    if (*cursor == '.') {
+      cursor++;
+      samples += samples / 2;
+    }
+    return samples;
+  }
+
+  // 解析到下一個音符或休止符，旋律結束回傳 false
+  bool nextNote() {
+    // 各音名相對於 C 的半音數（A B C D E F G）
+    static const int8_t NOTE_OFFSETS[7] = {9, 11, 0, 2, 4, 5, 7};
+    // O4 的 C ~ B 頻率（mHz）
+    static const uint32_t NOTE_MILLIHZ[12] = {
+      261626, 277183, 293665, 311127, 329628, 349228,
+      369994, 391995, 415305, 440000, 466164, 493883
+    };
+
+    while (cursor != NULL && *cursor != '\0') {
+      char c = *cursor++;
+      if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+
+      if (c >= 'A' && c <= 'G') {
+        int semitone = NOTE_OFFSETS[c - 'A'];
+        int noteOctave = octave;
+        if (*cursor == '#' || *cursor == '+') {
+          semitone++;
+          cursor++;
+        } else if (*cursor == '-') {
+          semitone--;
+          cursor++;
+        }
+        if (semitone < 0) { semitone += 12; noteOctave--; }
+        if (semitone > 11) { semitone -= 12; noteOctave++; }
+
+        startTone(NOTE_MILLIHZ[semitone], noteOctave, readDuration());
+        return true;
+      }
+
+      switch (c) {
+        case 'R':
+          sounding = false;
+          noteLeft = readDuration();
+          return true;
+        case 'O': octave = clamp(readNumber(octave), 0, SYNTH_OCTAVE_MAX); break;
+        case '<': if (octave > 0) octave--; break;
+        case '>': if (octave < SYNTH_OCTAVE_MAX) octave++; break;
+        case 'L': defaultLength = clamp(readNumber(defaultLength), 1, SYNTH_LENGTH_MAX); break;
+        case 'T': tempo = readNumber(tempo); if (tempo <= 0) tempo = 120; break;
+        case 'V': volumeGain = clamp(readNumber(12), 0, 15) * 2184; break;
+        case '@': {
+          unsigned index = (unsigned)readNumber(0);
+          voice = &SYNTH_VOICES[index < SYNTH_VOICE_COUNT ? index : 0];
+          break;
+        }
+        default: break;  // 空白或不認得的字元
+      }
+    }
+    return false;
+  }
+
+  static int clamp(int value, int low, int high) { return value < low ? low : (value > high ? high : value); }
+
+  void startTone(uint32_t milliHz, int noteOctave, uint32_t samples) {
+    // 相位步進 = 頻率 × 2^32 / 採樣率，依八度位移
+    uint64_t step = ((uint64_t)milliHz << 32) / ((uint64_t)sampleRate * 1000);
+    if (noteOctave >= 4) {
+      step <<= (noteOctave - 4);
+    } else {
+      step >>= (4 - noteOctave);
+    }
+    carrierStep = (uint32_t)step;
+    modStep = (uint32_t)((step * voice->modRatio) >> 8);
+    carrierPhase = 0;
+    modPhase = 0;
+
+    noteLeft = samples;
+    attackLeft = SYNTH_ATTACK_SAMPLES;
+    env = 0;
+    // 收尾時從最大值線性降到 0（每個音符只算一次除法）
+    releaseStep = 32767 / SYNTH_RELEASE_SAMPLES + 1;
+    sounding = true;
+  }
+
+  const int16_t *table = NULL;
+  const char *cursor = NULL;
+  const SynthVoice *voice = &SYNTH_VOICES[0];
+  uint32_t sampleRate = 44100;
+  int tempo = 120;
+  int octave = 4;
+  int defaultLength = 4;
+  int32_t volumeGain = 0;
+
+  uint32_t carrierPhase = 0;
+  uint32_t carrierStep = 0;
+  uint32_t modPhase = 0;
+  uint32_t modStep = 0;
+
+  uint32_t noteLeft = 0;
+  uint32_t attackLeft = 0;
+  int32_t env = 0;
+  int32_t releaseStep = 0;
+  bool sounding = false;
+};
+
+#endif
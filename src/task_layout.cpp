@@ -0,0 +1,220 @@
+#include "task_layout.h"
+#include "heap_watch.h"
+#include "spsc_ring.h"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#if TASK_LAYOUT == TASK_LAYOUT_PINNED
+#include <freertos/task.h>
+#endif
+
+static PlaybackSource<ClipReader> *playback = NULL;
+static SpscRing<int16_t, AUDIO_RING_SAMPLES> ring;
+static SemaphoreHandle_t sourceLock = NULL;
+
+// 換音源時的寫入位置，消費者（A2DP 回調）丟掉這之前的樣本
+static std::atomic<uint32_t> flushTo{0};
+// 音源播完時的寫入位置，消費者讀到這裡就是播完了
+static std::atomic<bool> ended{true};
+static std::atomic<uint32_t> endAt{0};
+
+// 統計
+static uint32_t fills = 0;
+static uint64_t fillUsTotal = 0;
+static uint32_t maxFillUs = 0;
+static uint32_t underruns = 0;
+static uint32_t lowWater = AUDIO_RING_SAMPLES;  // 播放中讀取時緩衝區最少剩幾個樣本
+static uint32_t lowWaterRate = 0;               // 當時的取樣率（換算成時間）
+
+#if TASK_LAYOUT == TASK_LAYOUT_PINNED
+static TaskHandle_t audioTask = NULL;
+static StackType_t audioTaskStack[AUDIO_TASK_STACK];
+static StaticTask_t audioTaskBuffer;
+#endif
+
+// 從 playbackSource 補緩衝區，最多 maxSamples 個（持有 sourceLock 時呼叫）
+static void fillRing(uint32_t maxSamples) {
+  static int16_t block[AUDIO_FILL_BLOCK];
+  if (ended || ring.space() < AUDIO_FILL_BLOCK) {
+    return;
+  }
+
+  int64_t startUs = esp_timer_get_time();
+  uint32_t filled = 0;
+  while (filled < maxSamples && ring.space() >= AUDIO_FILL_BLOCK) {
+    size_t got = playback->pull(block, AUDIO_FILL_BLOCK);
+    if (got == 0) {
+      endAt = ring.writePosition();
+      ended = true;
+      break;
+    }
+    filled += ring.push(block, got);
+  }
+
+  uint32_t elapsed = (uint32_t)(esp_timer_get_time() - startUs);
+  fills++;
+  fillUsTotal += elapsed;
+  if (elapsed > maxFillUs) maxFillUs = elapsed;
+}
+
+#if TASK_LAYOUT == TASK_LAYOUT_PINNED
+// 平常睡著，換音源或 A2DP 回調取走一半以上的樣本時被叫醒
+static void audioTaskLoop(void *arg) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    xSemaphoreTake(sourceLock, portMAX_DELAY);
+    fillRing(AUDIO_RING_SAMPLES);
+    xSemaphoreGive(sourceLock);
+  }
+}
+#endif
+
+void audioTaskBegin(PlaybackSource<ClipReader> &source) {
+  playback = &source;
+  sourceLock = xSemaphoreCreateMutex();
+#if TASK_LAYOUT == TASK_LAYOUT_PINNED
+  audioTask = xTaskCreateStaticPinnedToCore(audioTaskLoop, "audio", AUDIO_TASK_STACK, NULL, AUDIO_TASK_PRIORITY,
+                                            audioTaskStack, &audioTaskBuffer, BT_CORE);
+#endif
+}
+
+void audioSourceLock() {
+  xSemaphoreTake(sourceLock, portMAX_DELAY);
+}
+
+void audioSourceUnlock() {
+  flushTo = ring.writePosition();
+  ended = false;
+#if TASK_LAYOUT == TASK_LAYOUT_PINNED
+  xSemaphoreGive(sourceLock);
+  xTaskNotifyGive(audioTask);
+#else
+  fillRing(AUDIO_RING_SAMPLES);
+  xSemaphoreGive(sourceLock);
+#endif
+}
+
+size_t audioRingRead(int16_t *dst, size_t count) {
+  ring.discardTo(flushTo);
+
+#if TASK_LAYOUT == TASK_LAYOUT_INLINE
+  // 不夠時自己讀一個區塊（與原本每次讀 AUDIO_FILL_BLOCK 相同）；loop() 正在換音源時不等待
+  if (ring.available() < count && xSemaphoreTake(sourceLock, 0) == pdTRUE) {
+    fillRing(count);
+    xSemaphoreGive(sourceLock);
+  }
+#endif
+
+  uint32_t level = ring.available();
+  if (!ended && level < lowWater) {
+    lowWater = level;
+    lowWaterRate = playback->sampleRate;
+  }
+
+  size_t got = ring.pop(dst, count);
+  if (got < count && !ended) {
+    underruns++;
+  }
+
+#if TASK_LAYOUT == TASK_LAYOUT_PINNED
+  if (!ended && ring.available() < AUDIO_RING_SAMPLES / 2) {
+    xTaskNotifyGive(audioTask);
+  }
+#endif
+  return got;
+}
+
+void audioRingIdle() {
+  ring.discardTo(flushTo);
+#if TASK_LAYOUT == TASK_LAYOUT_PINNED
+  if (!ended && ring.available() < AUDIO_RING_SAMPLES / 2) {
+    xTaskNotifyGive(audioTask);
+  }
+#endif
+}
+
+bool audioSourceEnded() {
+  ring.discardTo(flushTo);
+  return ended && ring.readPosition() == endAt;
+}
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+#define STATS_MAX_TASKS 24
+
+// 各 task 上次 K 指令時的執行時間（算這段期間的使用率）
+struct TaskRunTime {
+  TaskHandle_t handle;
+  uint32_t runTime;
+};
+
+static TaskStatus_t taskStatus[STATS_MAX_TASKS];
+static TaskRunTime lastRunTimes[STATS_MAX_TASKS];
+static UBaseType_t lastTaskCount = 0;
+static uint32_t lastTotalRunTime = 0;
+
+static uint32_t previousRunTime(TaskHandle_t handle) {
+  for (UBaseType_t i = 0; i < lastTaskCount; i++) {
+    if (lastRunTimes[i].handle == handle) return lastRunTimes[i].runTime;
+  }
+  return 0;
+}
+
+static void printTaskUsage(Print &out) {
+  uint32_t totalRunTime = 0;
+  UBaseType_t count = uxTaskGetSystemState(taskStatus, STATS_MAX_TASKS, &totalRunTime);
+  uint32_t elapsed = totalRunTime - lastTotalRunTime;
+  if (count == 0 || elapsed == 0) {
+    out.println("  各 task：task 太多，放不下（STATS_MAX_TASKS）");
+    return;
+  }
+
+  out.println(lastTotalRunTime == 0 ? "  各 task（開機後）：" : "  各 task（上次 K 指令之後）：");
+  out.println("    名稱              核心 優先權  CPU  堆疊剩餘");
+  for (UBaseType_t i = 0; i < count; i++) {
+    const TaskStatus_t &task = taskStatus[i];
+    uint32_t used = task.ulRunTimeCounter - previousRunTime(task.xHandle);
+#if configTASKLIST_INCLUDE_COREID
+    int core = task.xCoreID == tskNO_AFFINITY ? -1 : (int)task.xCoreID;
+#else
+    int core = -1;
+#endif
+    printfNoAlloc(out, "    %-16s  %4s %6u %4u%% %8u\n", task.pcTaskName, core < 0 ? "任意" : (core == 0 ? "0" : "1"),
+                       (unsigned)task.uxCurrentPriority, (unsigned)((uint64_t)used * 100 / elapsed),
+                       (unsigned)task.usStackHighWaterMark);
+  }
+
+  for (UBaseType_t i = 0; i < count; i++) {
+    lastRunTimes[i].handle = taskStatus[i].xHandle;
+    lastRunTimes[i].runTime = taskStatus[i].ulRunTimeCounter;
+  }
+  lastTaskCount = count;
+  lastTotalRunTime = totalRunTime;
+}
+#else
+static void printTaskUsage(Print &out) {
+  out.println("  （sdkconfig 沒有開啟 CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS，看不到各 task 的 CPU 使用率）");
+}
+#endif
+
+void taskLayoutPrintStats(Print &out) {
+#if TASK_LAYOUT == TASK_LAYOUT_PINNED
+  printfNoAlloc(out, "【task 配置】core %d：藍牙、音源 task；core %d：loop()\n", BT_CORE, UI_CORE);
+  printfNoAlloc(out, "  音源 task：優先權 %d，堆疊剩餘 %u bytes\n", AUDIO_TASK_PRIORITY,
+                     (unsigned)uxTaskGetStackHighWaterMark(audioTask));
+#else
+  out.println("【task 配置】INLINE：A2DP 回調自己讀檔");
+#endif
+
+  if (fills > 0) {
+    printfNoAlloc(out, "  補緩衝區 %lu 次，平均 %lu us，最長 %lu us\n", (unsigned long)fills,
+                       (unsigned long)(fillUsTotal / fills), (unsigned long)maxFillUs);
+  }
+  printfNoAlloc(out, "  緩衝區 %d 樣本，", AUDIO_RING_SAMPLES);
+  if (lowWaterRate > 0) {
+    printfNoAlloc(out, "播放中最少剩 %lu 樣本（%lu ms），", (unsigned long)lowWater,
+                       (unsigned long)((uint64_t)lowWater * 1000 / lowWaterRate));
+  }
+  printfNoAlloc(out, "來不及補 %lu 次\n", (unsigned long)underruns);
+
+  printTaskUsage(out);
+}
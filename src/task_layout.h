@@ -0,0 +1,63 @@
+#ifndef TASK_LAYOUT_H
+#define TASK_LAYOUT_H
+
+#include <Arduino.h>
+#include "clip_storage.h"
+#include "playback_source.h"
+
+// ========== task 配置（核心與優先權）==========
+// TASK_LAYOUT_PINNED（預設）：
+//   core 0：藍牙 controller 與 Bluedroid（A2DP 資料回調在這裡執行）、A2DP 函式庫的事件 task、音源 task
+//   core 1：Arduino loop()（按鈕、燈光、狀態機、序列埠）
+//   音源 task 從 playbackSource 讀檔 / 合成，把樣本放進環形緩衝區（spsc_ring.h），
+//   A2DP 回調只從緩衝區取樣本、重採樣，不再等 flash；loop() 卡住也不會斷音。
+// TASK_LAYOUT_INLINE：原本的做法，A2DP 回調在緩衝區不夠時自己讀檔（模擬器是單執行緒，用這個）
+//
+// 優先權（數字越大越優先，ESP-IDF 最高 24）：
+//   藍牙 controller / Bluedroid   19-23（ESP-IDF 固定）
+//   A2DP 函式庫事件 task           BT_APP_TASK_PRIORITY
+//   音源 task                      AUDIO_TASK_PRIORITY：低於藍牙，補緩衝區不會延誤藍牙封包
+//   loop()                         1（Arduino 預設）
+// 序列埠指令 K 顯示各 task 的 CPU 使用率（需要 sdkconfig 開啟 FreeRTOS run time stats）、
+// 音源 task 的忙碌時間與緩衝區最低水位。
+
+#define TASK_LAYOUT_INLINE 0
+#define TASK_LAYOUT_PINNED 1
+
+#ifndef TASK_LAYOUT
+#define TASK_LAYOUT TASK_LAYOUT_PINNED
+#endif
+
+#define BT_CORE 0                  // 藍牙堆疊所在的核心（sdkconfig CONFIG_BT_BLUEDROID_PINNED_TO_CORE）
+#define UI_CORE 1                  // Arduino loop() 所在的核心（ARDUINO_RUNNING_CORE）
+
+#ifndef AUDIO_TASK_PRIORITY
+#define AUDIO_TASK_PRIORITY 10
+#endif
+#ifndef BT_APP_TASK_PRIORITY
+#define BT_APP_TASK_PRIORITY 15    // ESP32-A2DP 的預設值（configMAX_PRIORITIES - 10）
+#endif
+#define AUDIO_TASK_STACK 4096      // bytes，讀檔（SPIFFS / LittleFS）需要的深度
+
+// 環形緩衝區：8kHz 音檔約 0.5 秒、44.1kHz 合成音效約 93ms
+#define AUDIO_RING_SAMPLES 4096
+#define AUDIO_FILL_BLOCK 256       // 音源 task 每次從 playbackSource 取的樣本數
+
+// setup() 掃描音檔後呼叫，PINNED 時建立音源 task（堆疊與 TCB 都是靜態配置）
+void audioTaskBegin(PlaybackSource<ClipReader> &source);
+
+// loop() 改變 playbackSource（開檔、換音效、停止）前後呼叫；
+// 解鎖時丟掉舊音源留在緩衝區的樣本，並開始補滿新音源（PINNED 叫醒音源 task，INLINE 直接讀）
+void audioSourceLock();
+void audioSourceUnlock();
+
+// A2DP 回調：取出最多 count 個樣本；不到 count 個時用 audioSourceEnded() 分辨播完或來不及補
+size_t audioRingRead(int16_t *dst, size_t count);
+bool audioSourceEnded();
+
+// A2DP 回調沒有播放時呼叫：丟掉換音源前留下的樣本，讓新音源可以預先補滿（預讀）
+void audioRingIdle();
+
+void taskLayoutPrintStats(Print &out);
+
+#endif
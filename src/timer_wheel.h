@@ -0,0 +1,149 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ========== 計時輪（hashed timer wheel）==========
+// 取代 loop() 中每次都拿 millis() 比較的逾時判斷：
+// 計時器掛在「到期 tick % 槽數」的槽上，每個 tick 只看一個槽；
+// 沒有計時器時 advance() 只更新時間，不做任何比較。
+//
+// 計時器是單次觸發，到期後呼叫一次 callback（要週期觸發就在 callback 中重新 start）。
+// WheelTimer 由呼叫端配置（通常是全域變數），不使用動態記憶體。
+// callback 在 advance() 中呼叫（loop() 的 context），可以再 start / cancel 任何計時器。
+// 時間用 millis() 的差值計算，49 天溢位不影響。
+
+typedef void (*WheelCallback)(void *arg);
+
+struct WheelTimer {
+  WheelCallback callback;
+  void *arg;
+
+  // 以下由 TimerWheel 管理
+  WheelTimer *prev;
+  WheelTimer *next;
+  uint32_t rounds;  // 到期前還要經過這個槽幾次
+  uint16_t slot;
+  bool armed;
+  bool due;         // 這個 tick 到期，等待呼叫
+};
+
+inline void wheelTimerInit(WheelTimer &timer, WheelCallback callback, void *arg = NULL) {
+  timer.callback = callback;
+  timer.arg = arg;
+  timer.prev = NULL;
+  timer.next = NULL;
+  timer.rounds = 0;
+  timer.slot = 0;
+  timer.armed = false;
+  timer.due = false;
+}
+
+template <uint16_t SLOTS, uint32_t TICK_MS>
+class TimerWheel {
+  // tick 計數溢位時槽的位置要接得上
+  static_assert((SLOTS & (SLOTS - 1)) == 0, "SLOTS 必須是 2 的次方");
+
+ public:
+  void begin(uint32_t nowMs) {
+    for (uint16_t i = 0; i < SLOTS; i++) slots[i] = NULL;
+    lastMs = nowMs;
+    tick = 0;
+    armedCount = 0;
+  }
+
+  // 啟動（已啟動的會重新計時），nowMs + delayMs 之後觸發，不會提早（最多晚一格）
+  // 上次 advance() 之後經過的時間也要算進去（例如 loop() 中途的 delay()）
+  void start(WheelTimer &timer, uint32_t delayMs, uint32_t nowMs) {
+    cancel(timer);
+
+    uint32_t ticks = (nowMs - lastMs + delayMs + TICK_MS - 1) / TICK_MS;
+    if (ticks == 0) ticks = 1;
+    timer.slot = (uint16_t)((tick + ticks) % SLOTS);
+    timer.rounds = (ticks - 1) / SLOTS;
+    timer.due = false;
+    timer.armed = true;
+
+    timer.prev = NULL;
+    timer.next = slots[timer.slot];
+    if (timer.next != NULL) timer.next->prev = &timer;
+    slots[timer.slot] = &timer;
+    armedCount++;
+  }
+
+  void cancel(WheelTimer &timer) {
+    if (!timer.armed) return;
+
+    if (timer.prev != NULL) {
+      timer.prev->next = timer.next;
+    } else {
+      slots[timer.slot] = timer.next;
+    }
+    if (timer.next != NULL) timer.next->prev = timer.prev;
+    timer.prev = NULL;
+    timer.next = NULL;
+    timer.armed = false;
+    timer.due = false;
+    armedCount--;
+  }
+
+  bool armed(const WheelTimer &timer) const {
+    return timer.armed;
+  }
+
+  // 沒有任何計時器（可以放心休眠）
+  bool idle() const {
+    return armedCount == 0;
+  }
+
+  // 推進到 nowMs，依序觸發到期的計時器，回傳觸發次數
+  // loop() 卡住很久時一格一格補跑；lastMs 跟著每一格前進，
+  // callback 在補跑途中 start()（傳入實際的 millis()）才會從現在起算，不會提早或一次觸發好幾次
+  uint16_t advance(uint32_t nowMs) {
+    uint32_t ticks = (nowMs - lastMs) / TICK_MS;
+
+    uint16_t fired = 0;
+    while (ticks > 0 && armedCount > 0) {
+      tick++;
+      lastMs += TICK_MS;
+      ticks--;
+      fired += runSlot((uint16_t)(tick % SLOTS));
+    }
+    tick += ticks;  // 沒有計時器時直接跳過
+    lastMs += ticks * TICK_MS;
+    return fired;
+  }
+
+ private:
+  // 先標記這一輪到期的計時器，再一個一個取出呼叫：
+  // callback 裡新增的計時器不會被標記，取消的計時器也不會被呼叫
+  uint16_t runSlot(uint16_t slot) {
+    for (WheelTimer *t = slots[slot]; t != NULL; t = t->next) {
+      if (t->rounds == 0) {
+        t->due = true;
+      } else {
+        t->rounds--;
+      }
+    }
+
+    uint16_t fired = 0;
+    while (true) {
+      WheelTimer *t = slots[slot];
+      while (t != NULL && !t->due) t = t->next;
+      if (t == NULL) break;
+
+      cancel(*t);
+      t->callback(t->arg);
+      fired++;
+    }
+    return fired;
+  }
+
+  WheelTimer *slots[SLOTS];
+  uint32_t lastMs;
+  uint32_t tick;
+  uint16_t armedCount;
+};
+
+#endif
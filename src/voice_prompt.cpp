@@ -0,0 +1,39 @@
+#include "voice_prompt.h"
+#include "heap_watch.h"
+
+#if VOICE_MODULE
+#include "su03t_queue.h"
+
+static HardwareSerial voiceSerial(VOICE_UART);
+static Su03tQueue<HardwareSerial, VOICE_QUEUE_LEN> voiceQueue(voiceSerial);
+
+void voiceBegin() {
+  voiceSerial.begin(VOICE_BAUD, SERIAL_8N1, VOICE_RX_PIN, VOICE_TX_PIN);
+}
+
+void voiceSay(VoicePrompt prompt) {
+  if (!voiceQueue.say(prompt, millis())) {
+    printfNoAlloc(Serial, "⚠️  語音佇列已滿，略過播報 %u\n", (unsigned)prompt);
+  }
+}
+
+void voiceService(unsigned long now) {
+  voiceQueue.service(now);
+  uint8_t command = voiceQueue.takeCommand();
+  if (command != 0) {
+    printfNoAlloc(Serial, "🎙️  語音指令 %u\n", (unsigned)command);
+  }
+}
+
+void voicePrintStats(Print &out) {
+  const Su03tStats &stats = voiceQueue.stats();
+  printfNoAlloc(out, "【語音模組】%s，佇列 %u 筆\n", voiceQueue.busy() ? "播報中" : "閒置", (unsigned)voiceQueue.pending());
+  printfNoAlloc(out, "  送出 %lu 筆（佇列滿丟掉 %lu 筆，最多同時排 %u 筆，最長等待 %lu ms）\n",
+                     (unsigned long)stats.sent, (unsigned long)stats.dropped, (unsigned)stats.maxPending,
+                     (unsigned long)stats.maxWaitMs);
+  printfNoAlloc(out, "  播報結束回報 %lu 次，逾時 %lu 次，語音指令 %lu 次，格式錯誤 %lu 次\n",
+                     (unsigned long)stats.done, (unsigned long)stats.timeouts, (unsigned long)stats.commands,
+                     (unsigned long)stats.badFrames);
+}
+
+#endif
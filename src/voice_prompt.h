@@ -0,0 +1,49 @@
+#ifndef VOICE_PROMPT_H
+#define VOICE_PROMPT_H
+
+#include <Arduino.h>
+
+// ========== SU-03T 語音模組（選用）==========
+// 離線語音模組：播報內容是預先燒錄的語音（archive/SU03T燒錄步驟.md），ESP32 只送播報編號。
+// 指令排進佇列（su03t_queue.h），loop() 每次只把 UART 傳送緩衝區放得下的 bytes 交出去，
+// 狀態機隨時可以呼叫 voiceSay()，不會卡住 loop()。序列埠指令 V 顯示統計並播放測試語音。
+//
+// 用 -DVOICE_MODULE=1 編譯（env:esp32dev_voice），接線見 doc/wiring.md；
+// 預設不啟用，所有呼叫都是空的 inline 函式。
+
+#ifndef VOICE_MODULE
+#define VOICE_MODULE 0
+#endif
+
+#define VOICE_UART 2
+#define VOICE_TX_PIN 18       // ESP32 TX -> SU-03T RX
+#define VOICE_RX_PIN 19       // ESP32 RX -> SU-03T TX
+#define VOICE_BAUD 9600
+#define VOICE_QUEUE_LEN 4
+
+// 播報編號（與模組韌體的串口輸入設定相同）
+enum VoicePrompt : uint8_t {
+  VOICE_PROMPT_TEST = 1,             // 測試成功，語音模組正常運作
+  VOICE_PROMPT_LOTTERY_OPEN = 2,     // 三燈全亮，可以抽籤囉
+  VOICE_PROMPT_LOTTERY_EXPIRED = 3,  // 抽籤時間結束
+};
+
+#if VOICE_MODULE
+
+void voiceBegin();
+void voiceSay(VoicePrompt prompt);      // 排入播報，立即返回
+void voiceService(unsigned long now);   // 在 loop() 中呼叫
+void voicePrintStats(Print &out);
+
+#else
+
+inline void voiceBegin() {}
+inline void voiceSay(VoicePrompt prompt) {}
+inline void voiceService(unsigned long now) {}
+inline void voicePrintStats(Print &out) {
+  out.println("（這個版本沒有啟用 SU-03T 語音模組，VOICE_MODULE=0）");
+}
+
+#endif
+
+#endif
@@ -0,0 +1,138 @@
+#include "ws2812_strip.h"
+#include "heap_watch.h"
+#include <driver/rmt.h>
+#include <esp_timer.h>
+
+#define WS2812_RMT_CHANNEL RMT_CHANNEL_0
+
+// 時序（RMT 時脈 80MHz / 2 = 40MHz，每 tick 25ns）
+#define WS2812_T0H 14  // 0.35us
+#define WS2812_T0L 32  // 0.80us
+#define WS2812_T1H 28  // 0.70us
+#define WS2812_T1L 24  // 0.60us
+
+// 每幀傳送時間：每顆 24 bits，每 bit 1.25us
+#define WS2812_FRAME_US (WS2812_COUNT * 24 * 5 / 4)
+
+static PixelColor framebuffer[WS2812_COUNT];    // 繪製用
+static PixelColor sentFrame[WS2812_COUNT];      // 上一次送出的畫面（相同就不再送）
+static bool anySent = false;
+static uint8_t txBuffer[WS2812_COUNT * 3];      // 傳送中（GRB 順序，已套用亮度）
+static bool started = false;
+static bool framePending = false;
+static int64_t lastSendUs = 0;
+
+// 統計
+static uint32_t framesSent = 0;
+static uint32_t framesDeferred = 0;
+static uint32_t framesUnchanged = 0;
+static uint32_t maxEncodeUs = 0;
+
+// RMT translator：把 bytes 轉成 RMT 波形（每個 bit 一個 item，高位元先送）
+static void IRAM_ATTR translateBytes(const void *src, rmt_item32_t *dest, size_t srcSize,
+                                     size_t wantedNum, size_t *translatedSize, size_t *itemNum) {
+  const rmt_item32_t bit0 = {{{WS2812_T0H, 1, WS2812_T0L, 0}}};
+  const rmt_item32_t bit1 = {{{WS2812_T1H, 1, WS2812_T1L, 0}}};
+
+  const uint8_t *bytes = (const uint8_t *)src;
+  size_t size = 0;
+  size_t num = 0;
+  while (size < srcSize && num + 8 <= wantedNum) {
+    uint8_t value = bytes[size];
+    for (int bit = 7; bit >= 0; bit--) {
+      dest[num++] = (value & (1 << bit)) ? bit1 : bit0;
+    }
+    size++;
+  }
+  *translatedSize = size;
+  *itemNum = num;
+}
+
+// RMT 是否還在送上一幀（含幀尾的 reset 低電位）
+static bool transmitting() {
+  if (rmt_wait_tx_done(WS2812_RMT_CHANNEL, 0) != ESP_OK) return true;
+  return esp_timer_get_time() - lastSendUs < WS2812_FRAME_US + WS2812_RESET_US;
+}
+
+bool ws2812Begin() {
+  rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)WS2812_PIN, WS2812_RMT_CHANNEL);
+  config.clk_div = 2;
+  config.mem_block_num = 2;  // 128 items，減少補充中斷次數
+
+  if (rmt_config(&config) != ESP_OK ||
+      rmt_driver_install(WS2812_RMT_CHANNEL, 0, 0) != ESP_OK ||
+      rmt_translator_init(WS2812_RMT_CHANNEL, translateBytes) != ESP_OK) {
+    Serial.println("❌ WS2812 RMT 初始化失敗");
+    return false;
+  }
+
+  memset(framebuffer, 0, sizeof(framebuffer));
+  started = true;
+  ws2812Show();
+  return true;
+}
+
+PixelColor *ws2812Pixels() {
+  return framebuffer;
+}
+
+void ws2812Fill(uint8_t r, uint8_t g, uint8_t b) {
+  for (int i = 0; i < WS2812_COUNT; i++) {
+    framebuffer[i].r = r;
+    framebuffer[i].g = g;
+    framebuffer[i].b = b;
+  }
+}
+
+bool ws2812Show() {
+  if (!started) return false;
+
+  // 與上一次送出的畫面相同：不用再送（loop() 每次都會設定燈光，一直重送會讓燈條無法休眠）
+  if (anySent && memcmp(framebuffer, sentFrame, sizeof(framebuffer)) == 0) {
+    framePending = false;
+    framesUnchanged++;
+    return true;
+  }
+  // 上一幀還沒送完：留給 ws2812Service()
+  if (transmitting()) {
+    framePending = true;
+    framesDeferred++;
+    return false;
+  }
+
+  // 編碼到傳送緩衝區（WS2812 為 GRB 順序），之後繪製用畫面可以馬上再寫
+  int64_t encodeStart = esp_timer_get_time();
+  uint8_t *out = txBuffer;
+  for (int i = 0; i < WS2812_COUNT; i++) {
+    *out++ = (framebuffer[i].g * WS2812_BRIGHTNESS) >> 8;
+    *out++ = (framebuffer[i].r * WS2812_BRIGHTNESS) >> 8;
+    *out++ = (framebuffer[i].b * WS2812_BRIGHTNESS) >> 8;
+  }
+  memcpy(sentFrame, framebuffer, sizeof(framebuffer));
+  anySent = true;
+  uint32_t encodeUs = (uint32_t)(esp_timer_get_time() - encodeStart);
+  if (encodeUs > maxEncodeUs) maxEncodeUs = encodeUs;
+
+  framePending = false;
+  lastSendUs = esp_timer_get_time();
+  rmt_write_sample(WS2812_RMT_CHANNEL, txBuffer, sizeof(txBuffer), false);
+  framesSent++;
+  return true;
+}
+
+void ws2812Service() {
+  if (framePending) {
+    ws2812Show();
+  }
+}
+
+bool ws2812Idle() {
+  return !started || (!framePending && !transmitting());
+}
+
+void ws2812PrintStats(Print &out) {
+  out.println("【WS2812 燈條】");
+  printfNoAlloc(out, "  %d 顆 LED，GPIO %d，每幀傳送 %d us\n", WS2812_COUNT, WS2812_PIN, WS2812_FRAME_US);
+  printfNoAlloc(out, "  已送出 %u 幀，畫面沒變略過 %u 次，延後 %u 次，編碼最長 %u us\n",
+                     (unsigned)framesSent, (unsigned)framesUnchanged, (unsigned)framesDeferred, (unsigned)maxEncodeUs);
+}
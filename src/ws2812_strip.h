@@ -0,0 +1,46 @@
+#ifndef WS2812_STRIP_H
+#define WS2812_STRIP_H
+
+#include <Arduino.h>
+#include "pixel_kernels.h"
+
+// ========== WS2812 可定址燈條（RMT 輸出）==========
+// 用 build_flags -DLED_OUTPUT=LED_OUTPUT_WS2812 改用 WS2812 燈條，預設為類比 RGB 燈條（LEDC）。
+//
+// 雙緩衝：effects 寫入繪製用畫面（ws2812Pixels()），ws2812Show() 把畫面編碼到傳送緩衝區後
+// 交給 RMT 在背景送出（中斷補充 RMT 記憶體，ESP32 的 RMT 沒有 DMA）。
+// 上一幀還在傳送時不會等待，這一幀延到 ws2812Service() 再送，繪製迴圈永遠不會被卡住。
+// 畫面與上一次送出的相同時不再送，燈光不變時 RMT 保持閒置（ws2812Idle()，可以休眠）。
+// 只在 loop task 呼叫（藍牙與音頻回調不設定燈光），不需要鎖。
+// RMT 時脈來自 APB（80MHz），CPU 降頻到 80MHz 也不影響時序。
+
+#define LED_OUTPUT_ANALOG 0
+#define LED_OUTPUT_WS2812 1
+
+#ifndef LED_OUTPUT
+#define LED_OUTPUT LED_OUTPUT_ANALOG
+#endif
+
+#ifndef WS2812_PIN
+#define WS2812_PIN 4          // 資料腳（未被按鈕與類比燈條使用）
+#endif
+
+#ifndef WS2812_COUNT
+#define WS2812_COUNT 30       // LED 數量
+#endif
+
+#ifndef WS2812_BRIGHTNESS
+#define WS2812_BRIGHTNESS 96  // 整體亮度上限（0-255），限制燈條電流（每顆全白約 60mA）
+#endif
+
+#define WS2812_RESET_US 300   // 幀與幀之間至少保持低電位的時間（新版 WS2812B 需要 280us）
+
+bool ws2812Begin();
+PixelColor *ws2812Pixels();                        // 繪製用畫面，任何時候都可以寫入
+void ws2812Fill(uint8_t r, uint8_t g, uint8_t b);  // 整條同色
+bool ws2812Show();      // 送出畫面（沒變就不送），回傳 false 表示上一幀還在傳送（會在 ws2812Service() 補送）
+void ws2812Service();   // 在 loop() 中呼叫，送出被延後的畫面
+bool ws2812Idle();      // 沒有傳送中或等待中的畫面（可以休眠）
+void ws2812PrintStats(Print &out);
+
+#endif
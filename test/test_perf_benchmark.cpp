@@ -0,0 +1,248 @@
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <atomic>
+#include "BluetoothA2DPSource.h"
+#include "clip_storage.h"
+#include "playback_source.h"
+#include "task_layout.h"
+#include "ws2812_strip.h"
+
+// 韌體效能測試：flash 讀取速度、音頻回調產出速度、燈光更新速度
+// 與主程式一起編譯（-DPERF_BENCH），setup() 掛載儲存後端後改跑這裡，
+// 直接呼叫 src/main.cpp 的 get_sound_data()、setRGB()，量到的就是實際的程式碼。
+// 以 TASK_LAYOUT_INLINE 編譯（見 platformio.ini），回調自己讀檔，量到的是完整的產出成本。
+// 只讀不寫，音檔不受影響（與 storage_bench 不同）。
+//
+// 輸出格式（每行一筆，給 tools/compare_bench.py 解析，其他行忽略）：
+//   BENCH_INFO key=value ...          設定（CPU 頻率、儲存後端、燈光輸出）
+//   BENCH <項目>/<參數>/... key=value  量測結果，名稱以 _us 結尾的越小越好，其他越大越好
+//   BENCH_DONE
+//
+// 執行：pio run -e perf_bench --target upload && pio device monitor | tee run.txt
+// 比較：python3 tools/compare_bench.py before.txt after.txt
+
+#define PERF_SEED 12345               // 隨機讀取位置固定，每次量測相同
+#define PERF_READ_BYTES (256 * 1024)  // 循序讀取量（音檔較小時讀完整個音檔）
+#define PERF_RANDOM_READS 256         // 隨機讀取次數
+#define PERF_AUDIO_CALLS 200          // 每種音源呼叫 get_sound_data() 的次數
+#define PERF_AUDIO_FRAMES 512         // 每次要求的 frames（與藍牙堆疊相同）
+#define PERF_LED_CALLS 2000           // setRGB() 呼叫次數
+
+// src/main.cpp
+extern PlaybackSource<ClipReader> playbackSource;
+extern std::atomic<bool> isPlaying;
+int32_t get_sound_data(Frame *frame, int32_t frame_count);
+void beginSourceChange();
+void endSourceChange();
+void beginPlayback();  // 新的播放編號，回調看到後清空重採樣狀態
+void setRGB(int red, int green, int blue);
+
+static const size_t blockSizes[] = {256, 512, 1024, 2048, 4096};
+static uint8_t block[4096];
+static Frame frames[PERF_AUDIO_FRAMES];
+
+// 讀取耗時統計
+struct ReadTiming {
+  uint32_t reads;
+  uint32_t bytes;
+  uint32_t totalUs;
+  uint32_t maxUs;
+};
+
+static void addRead(ReadTiming &timing, size_t bytes, uint32_t us) {
+  timing.reads++;
+  timing.bytes += bytes;
+  timing.totalUs += us;
+  if (us > timing.maxUs) timing.maxUs = us;
+}
+
+static void printRead(const char *test, const char *backend, size_t blockSize, const ReadTiming &timing) {
+  uint32_t kbps = timing.totalUs > 0 ? (uint32_t)((uint64_t)timing.bytes * 1000000 / 1024 / timing.totalUs) : 0;
+  Serial.printf("BENCH %s/%s/%u kbps=%u avg_us=%u max_us=%u\n", test, backend, (unsigned)blockSize,
+                (unsigned)kbps, (unsigned)(timing.reads > 0 ? timing.totalUs / timing.reads : 0),
+                (unsigned)timing.maxUs);
+}
+
+// 隨機位置（對齊區塊大小，讀取不會超出範圍）
+static uint32_t randomOffset(uint32_t size, size_t blockSize) {
+  return (uint32_t)random(0, (long)(size / blockSize)) * blockSize;
+}
+
+// ---------- flash 讀取：經由儲存後端（含檔案系統成本）----------
+
+// 找最大的音檔，回傳 false 表示沒有音檔
+static bool largestClip(ClipInfo &largest) {
+  ClipInfo info;
+  largest.size = 0;
+  clipStorage().rewindClips();
+  while (clipStorage().nextClip(info)) {
+    if (info.size > largest.size) largest = info;
+  }
+  return largest.size > 0;
+}
+
+static void benchClipReads(const ClipInfo &clip) {
+  for (size_t blockSize : blockSizes) {
+    ClipReader *reader = clipStorage().open(clip.name);
+    if (reader == NULL) return;
+
+    ReadTiming timing = {};
+    uint32_t limit = min(reader->size(), (uint32_t)PERF_READ_BYTES);
+    while (timing.bytes < limit) {
+      unsigned long t0 = micros();
+      size_t n = reader->read(block, min(blockSize, (size_t)(limit - timing.bytes)));
+      unsigned long elapsed = micros() - t0;
+      if (n == 0) break;
+      addRead(timing, n, elapsed);
+    }
+    printRead("flash_seq", clipStorage().name(), blockSize, timing);
+
+    timing = ReadTiming();
+    for (int i = 0; i < PERF_RANDOM_READS && reader->size() >= blockSize; i++) {
+      uint32_t offset = randomOffset(reader->size(), blockSize);
+      unsigned long t0 = micros();
+      reader->seek(offset);
+      size_t n = reader->read(block, blockSize);
+      addRead(timing, n, micros() - t0);
+    }
+    printRead("flash_rand", clipStorage().name(), blockSize, timing);
+    reader->close();
+  }
+}
+
+// ---------- flash 讀取：直接讀分區（硬體上限，三種後端共用 spiffs 分區）----------
+
+static void benchPartitionReads() {
+  const esp_partition_t *partition = esp_partition_find_first(
+      ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, CLIP_PARTITION_LABEL);
+  if (partition == NULL) {
+    Serial.println("⚠️  找不到音檔分區，略過分區讀取");
+    return;
+  }
+
+  uint32_t limit = min(partition->size, (uint32_t)PERF_READ_BYTES);
+  for (size_t blockSize : blockSizes) {
+    ReadTiming timing = {};
+    for (uint32_t pos = 0; pos + blockSize <= limit; pos += blockSize) {
+      unsigned long t0 = micros();
+      if (esp_partition_read(partition, pos, block, blockSize) != ESP_OK) break;
+      addRead(timing, blockSize, micros() - t0);
+    }
+    printRead("flash_seq", "partition", blockSize, timing);
+
+    timing = ReadTiming();
+    for (int i = 0; i < PERF_RANDOM_READS; i++) {
+      uint32_t offset = randomOffset(partition->size, blockSize);
+      unsigned long t0 = micros();
+      if (esp_partition_read(partition, offset, block, blockSize) != ESP_OK) break;
+      addRead(timing, blockSize, micros() - t0);
+    }
+    printRead("flash_rand", "partition", blockSize, timing);
+  }
+}
+
+// ---------- 音頻回調 ----------
+
+// 呼叫 get_sound_data() 直到次數用完或音源結束，印出每秒產出的 frames
+static void benchAudio(const char *source, uint32_t rate) {
+  bool playing = isPlaying;
+  uint32_t calls = 0;
+  uint32_t totalUs = 0;
+  uint32_t maxUs = 0;
+  while (calls < PERF_AUDIO_CALLS && isPlaying == playing) {
+    unsigned long t0 = micros();
+    get_sound_data(frames, PERF_AUDIO_FRAMES);
+    uint32_t elapsed = micros() - t0;
+    calls++;
+    totalUs += elapsed;
+    if (elapsed > maxUs) maxUs = elapsed;
+  }
+  isPlaying = false;
+  audioSourceLock();
+  playbackSource.stop();
+  audioSourceUnlock();
+
+  // 即時倍數：產出速度是播放速度（44.1kHz）的幾倍，低於 1 就會斷音
+  uint64_t framesOut = (uint64_t)calls * PERF_AUDIO_FRAMES;
+  uint32_t fps = totalUs > 0 ? (uint32_t)(framesOut * 1000000 / totalUs) : 0;
+  Serial.printf("BENCH audio/%s/%u fps=%u realtime=%.1f avg_us=%u max_us=%u\n", source, (unsigned)rate,
+                (unsigned)fps, fps / 44100.0, (unsigned)(calls > 0 ? totalUs / calls : 0), (unsigned)maxUs);
+}
+
+static void benchAudioSources(const ClipInfo *clip) {
+  // 測試音：不同取樣率 = 不同的重採樣比例
+  const uint32_t rates[] = {8000, 16000, 22050, 44100};
+  for (uint32_t rate : rates) {
+    beginSourceChange();
+    playbackSource.playTone(440, rate, 60000, 8000);
+    endSourceChange();
+    beginPlayback();
+    benchAudio("tone", rate);
+  }
+
+  // 音檔串流（含讀檔，預讀大小依讀取速度調整）
+  if (clip != NULL) {
+    ClipReader *reader = clipStorage().open(clip->name);
+    if (reader != NULL) {
+      reader->seek(44);  // 跳過 WAV 標頭
+      beginSourceChange();
+      playbackSource.playStream(reader, 8000);
+      endSourceChange();
+      beginPlayback();
+      benchAudio("clip", 8000);
+    }
+  }
+
+  // 沒有播放時（藍牙連線中的靜音）
+  benchAudio("silence", 44100);
+}
+
+// ---------- 燈光 ----------
+
+static void benchLeds() {
+  unsigned long t0 = micros();
+  for (int i = 0; i < PERF_LED_CALLS; i++) {
+    setRGB(i & 0xFF, (i * 3) & 0xFF, (i * 7) & 0xFF);
+  }
+  uint32_t elapsed = micros() - t0;
+  setRGB(0, 0, 0);
+
+  Serial.printf("BENCH led/setrgb calls_per_s=%u avg_us=%u\n",
+                (unsigned)(elapsed > 0 ? (uint64_t)PERF_LED_CALLS * 1000000 / elapsed : 0),
+                (unsigned)(elapsed / PERF_LED_CALLS));
+}
+
+void perfBenchRun() {
+  Serial.println("\n========================================");
+  Serial.println("效能測試（結果用 tools/compare_bench.py 比較）");
+  Serial.println("========================================");
+
+#if LED_OUTPUT == LED_OUTPUT_WS2812
+  const char *ledOutput = "ws2812";
+#elif defined(LED_PWM_BITS) && LED_PWM_BITS > 8
+  const char *ledOutput = "pwm_hires";
+#else
+  const char *ledOutput = "pwm";
+#endif
+  Serial.printf("BENCH_INFO cpu_mhz=%u storage=%s led=%s\n", (unsigned)getCpuFrequencyMhz(),
+                clipStorage().name(), ledOutput);
+
+  randomSeed(PERF_SEED);
+  ClipInfo clip;
+  bool hasClip = largestClip(clip);
+  if (hasClip) {
+    Serial.printf("   測試音檔：%s（%u bytes）\n", clip.name, (unsigned)clip.size);
+    benchClipReads(clip);
+  } else {
+    Serial.println("⚠️  沒有音檔，略過音檔讀取");
+  }
+  benchPartitionReads();
+  benchAudioSources(hasClip ? &clip : NULL);
+  benchLeds();
+
+  Serial.println("BENCH_DONE");
+  Serial.println("✅ 效能測試完成");
+  while (1) {
+    delay(1000);
+  }
+}
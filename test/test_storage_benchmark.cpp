@@ -0,0 +1,209 @@
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <LittleFS.h>
+#include "clip_storage.h"
+
+// 音檔儲存後端效能比較：SPIFFS / LittleFS / raw 分區
+// 量測：掛載時間、列出目錄、開檔延遲、循序讀取速度
+//
+// ⚠️ 會格式化 spiffs 分區並寫入測試資料，測完請重新上傳音檔：
+//    pio run -e esp32dev --target uploadfs
+//
+// 執行：pio run -e storage_bench --target upload && pio device monitor
+
+#define TEST_CLIP_COUNT 10          // 測試檔案數量
+#define TEST_CLIP_SIZE (200 * 1024) // 每個檔案 200KB（約 6 秒 16kHz 單聲道）
+#define OPEN_REPEAT 5               // 每個檔案重複開檔次數
+
+uint8_t chunk[4096];
+
+// 測試資料內容（固定圖樣，可驗證讀取正確）
+void fillPattern(uint8_t *buf, size_t len, uint32_t offset) {
+  for (size_t i = 0; i < len; i++) {
+    buf[i] = (uint8_t)((offset + i) * 31);
+  }
+}
+
+void testClipName(int index, char *name) {
+  snprintf(name, CLIP_NAME_LEN, "Bench_%02d.wav", index);
+}
+
+// ---------- 寫入測試資料 ----------
+
+bool prepareFs(fs::FS &fs) {
+  char name[CLIP_NAME_LEN + 1];
+  for (int i = 0; i < TEST_CLIP_COUNT; i++) {
+    name[0] = '/';
+    testClipName(i, name + 1);
+    File file = fs.open(name, "w");
+    if (!file) return false;
+    for (uint32_t pos = 0; pos < TEST_CLIP_SIZE; pos += sizeof(chunk)) {
+      fillPattern(chunk, sizeof(chunk), pos);
+      file.write(chunk, min((uint32_t)sizeof(chunk), TEST_CLIP_SIZE - pos));
+    }
+    file.close();
+  }
+  return true;
+}
+
+bool prepareSpiffs() {
+  if (!SPIFFS.begin(true) || !SPIFFS.format() || !SPIFFS.begin(true)) return false;
+  bool ok = prepareFs(SPIFFS);
+  SPIFFS.end();
+  return ok;
+}
+
+bool prepareLittlefs() {
+  if (!LittleFS.begin(true, "/littlefs", 10, CLIP_PARTITION_LABEL) || !LittleFS.format() ||
+      !LittleFS.begin(true, "/littlefs", 10, CLIP_PARTITION_LABEL)) {
+    return false;
+  }
+  bool ok = prepareFs(LittleFS);
+  LittleFS.end();
+  return ok;
+}
+
+bool prepareRaw() {
+  const esp_partition_t *partition = esp_partition_find_first(
+      ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, CLIP_PARTITION_LABEL);
+  if (partition == NULL) return false;
+
+  // 與 tools/pack_clips.py 相同的格式
+  uint32_t dataStart = 4096;
+  uint32_t clipStride = (TEST_CLIP_SIZE + 4095) / 4096 * 4096;
+  uint32_t total = dataStart + clipStride * TEST_CLIP_COUNT;
+  if (esp_partition_erase_range(partition, 0, total) != ESP_OK) return false;
+
+  uint32_t header[2] = {RAW_CLIP_MAGIC, RAW_CLIP_VERSION | (TEST_CLIP_COUNT << 16)};
+  esp_partition_write(partition, 0, header, sizeof(header));
+
+  for (int i = 0; i < TEST_CLIP_COUNT; i++) {
+    RawClipEntry entry = {};
+    testClipName(i, entry.name);
+    entry.offset = dataStart + clipStride * i;
+    entry.size = TEST_CLIP_SIZE;
+    esp_partition_write(partition, sizeof(header) + i * sizeof(entry), &entry, sizeof(entry));
+
+    for (uint32_t pos = 0; pos < TEST_CLIP_SIZE; pos += sizeof(chunk)) {
+      fillPattern(chunk, sizeof(chunk), pos);
+      esp_partition_write(partition, entry.offset + pos, chunk,
+                          min((uint32_t)sizeof(chunk), TEST_CLIP_SIZE - pos));
+    }
+  }
+  return true;
+}
+
+// ---------- 量測 ----------
+
+void benchmark(ClipStorage &storage) {
+  Serial.print("\n【");
+  Serial.print(storage.name());
+  Serial.println("】");
+
+  // 掛載
+  unsigned long t0 = micros();
+  if (!storage.begin()) {
+    Serial.println("  ❌ 掛載失敗");
+    return;
+  }
+  unsigned long mountUs = micros() - t0;
+
+  // 列出目錄
+  t0 = micros();
+  ClipInfo info;
+  int listed = 0;
+  storage.rewindClips();
+  while (storage.nextClip(info)) listed++;
+  unsigned long listUs = micros() - t0;
+
+  // 開檔延遲（含關檔）
+  char name[CLIP_NAME_LEN];
+  unsigned long openTotalUs = 0;
+  unsigned long openMaxUs = 0;
+  for (int repeat = 0; repeat < OPEN_REPEAT; repeat++) {
+    for (int i = 0; i < TEST_CLIP_COUNT; i++) {
+      testClipName(i, name);
+      t0 = micros();
+      ClipReader *reader = storage.open(name);
+      unsigned long elapsed = micros() - t0;
+      if (reader == NULL) {
+        Serial.print("  ❌ 無法開啟 ");
+        Serial.println(name);
+        storage.end();
+        return;
+      }
+      reader->close();
+      openTotalUs += elapsed;
+      openMaxUs = max(openMaxUs, elapsed);
+    }
+  }
+
+  Serial.printf("  掛載: %lu us\n", mountUs);
+  Serial.printf("  列出 %d 個檔案: %lu us\n", listed, listUs);
+  Serial.printf("  開檔: 平均 %lu us，最大 %lu us\n",
+                openTotalUs / (OPEN_REPEAT * TEST_CLIP_COUNT), openMaxUs);
+
+  // 循序讀取（不同區塊大小）
+  const size_t blockSizes[] = {512, 1024, 4096};
+  for (size_t blockSize : blockSizes) {
+    testClipName(0, name);
+    ClipReader *reader = storage.open(name);
+    bool correct = true;
+    uint32_t total = 0;
+    t0 = micros();
+    while (true) {
+      size_t n = reader->read(chunk, blockSize);
+      if (n == 0) break;
+      // 抽查第一個 byte，確認內容正確
+      if (chunk[0] != (uint8_t)(total * 31)) correct = false;
+      total += n;
+    }
+    unsigned long readUs = micros() - t0;
+    reader->close();
+
+    Serial.printf("  循序讀取 %4u bytes/次: %lu KB/s%s\n", (unsigned)blockSize,
+                  readUs > 0 ? (unsigned long)((uint64_t)total * 1000000 / 1024 / readUs) : 0UL,
+                  correct && total == TEST_CLIP_SIZE ? "" : "（❌ 內容錯誤）");
+  }
+
+  storage.end();
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.println("========================================");
+  Serial.println("音檔儲存後端效能測試");
+  Serial.println("⚠️  spiffs 分區會被格式化，測完請重新 uploadfs");
+  Serial.println("========================================");
+
+  Serial.println("\n寫入 SPIFFS 測試資料...");
+  if (prepareSpiffs()) {
+    benchmark(spiffsClipStorage());
+  } else {
+    Serial.println("❌ SPIFFS 測試資料寫入失敗");
+  }
+
+  Serial.println("\n寫入 LittleFS 測試資料...");
+  if (prepareLittlefs()) {
+    benchmark(littlefsClipStorage());
+  } else {
+    Serial.println("❌ LittleFS 測試資料寫入失敗");
+  }
+
+  Serial.println("\n寫入 raw 分區測試資料...");
+  if (prepareRaw()) {
+    benchmark(rawClipStorage());
+  } else {
+    Serial.println("❌ raw 分區寫入失敗");
+  }
+
+  Serial.println("\n========================================");
+  Serial.println("測試完成");
+  Serial.println("========================================");
+}
+
+void loop() {
+  delay(1000);
+}
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""分析 data/ 中的音檔：量測響度、找出頭尾靜音，產生播放資訊 clips.meta。
+
+用法：
+  python3 tools/analyze_clips.py data/                 # 產生 data/clips.meta
+  python3 tools/analyze_clips.py data/ --target -16    # 目標響度（LUFS）
+
+裝置播放時依 clips.meta 跳過頭尾的靜音、把每個音檔調到相同響度（見 src/clip_meta.h），
+不需要修改音檔。之後照常 uploadfs（或 pack_clips.py 打包），clips.meta 會一起上傳。
+換過音檔要重新執行，否則大小不符的音檔會照原樣播放。
+
+響度依 ITU-R BS.1770（K 加權、400ms 區塊、絕對 -70 LUFS 與相對 -10 LU 閘門），
+增益限制在 ±--max-gain dB，且峰值不超過 --peak dBFS。
+"""
+
+import argparse
+import math
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b"FTBM"
+VERSION = 1
+NAME_LEN = 32
+MAX_CLIPS = 32
+ENTRY = struct.Struct("<%dsIIIHh" % NAME_LEN)
+GAIN_UNITY = 4096  # Q12
+META_NAME = "clips.meta"
+
+WINDOW_MS = 10        # 靜音偵測的視窗
+PAD_START_MS = 20     # 保留開頭的淡入
+PAD_END_MS = 150      # 保留結尾的餘音
+
+
+def read_wav(path):
+    """回傳 (取樣率, 樣本, data chunk 起點, 檔案大小)，只接受 16-bit 單聲道 PCM"""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[0:4] != b"RIFF" or data[8:12] != b"WAVE":
+        raise ValueError("不是 WAV 檔")
+
+    rate = None
+    pos = 12
+    while pos + 8 <= len(data):
+        chunk_id, size = struct.unpack_from("<4sI", data, pos)
+        body = pos + 8
+        if chunk_id == b"fmt ":
+            fmt, channels, rate, _, _, bits = struct.unpack_from("<HHIIHH", data, body)
+            if fmt != 1 or channels != 1 or bits != 16:
+                raise ValueError("需要 16-bit 單聲道 PCM（格式 %d，%d 聲道，%d bits）" % (fmt, channels, bits))
+        elif chunk_id == b"data":
+            if rate is None:
+                raise ValueError("data 在 fmt 之前")
+            size = min(size, len(data) - body) // 2 * 2
+            samples = struct.unpack_from("<%dh" % (size // 2), data, body)
+            return rate, samples, body, len(data)
+        pos = body + size + (size & 1)
+    raise ValueError("找不到 data chunk")
+
+
+def biquad(samples, b, a):
+    b0, b1, b2 = b
+    _, a1, a2 = a
+    x1 = x2 = y1 = y2 = 0.0
+    out = []
+    for x in samples:
+        y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2
+        x2, x1 = x1, x
+        y2, y1 = y1, y
+        out.append(y)
+    return out
+
+
+def k_weighting(rate):
+    """BS.1770 的 K 加權濾波器（高架 + 高通），依取樣率計算係數（同 libebur128）"""
+    f0, gain, q = 1681.974450955533, 3.999843853973347, 0.7071752369554196
+    k = math.tan(math.pi * f0 / rate)
+    vh = 10.0 ** (gain / 20.0)
+    vb = vh ** 0.4996667741545416
+    a0 = 1.0 + k / q + k * k
+    shelf_b = ((vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0)
+    shelf_a = (1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0)
+
+    f0, q = 38.13547087602444, 0.5003270373238773
+    k = math.tan(math.pi * f0 / rate)
+    a0 = 1.0 + k / q + k * k
+    high_b = (1.0, -2.0, 1.0)
+    high_a = (1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0)
+    return (shelf_b, shelf_a), (high_b, high_a)
+
+
+def integrated_loudness(samples, rate):
+    """回傳整合響度（LUFS），太短或全是靜音時回傳 None"""
+    (sb, sa), (hb, ha) = k_weighting(rate)
+    weighted = biquad(biquad([s / 32768.0 for s in samples], sb, sa), hb, ha)
+
+    block = int(rate * 0.4)
+    step = block // 4
+    if len(weighted) < block:
+        return None
+    # 先算前綴平方和，每個區塊 O(1)
+    prefix = [0.0]
+    for value in weighted:
+        prefix.append(prefix[-1] + value * value)
+    powers = [(prefix[i + block] - prefix[i]) / block for i in range(0, len(weighted) - block + 1, step)]
+
+    def loudness(power):
+        return -0.691 + 10.0 * math.log10(power) if power > 0 else -math.inf
+
+    gated = [p for p in powers if loudness(p) > -70.0]
+    if not gated:
+        return None
+    relative = loudness(sum(gated) / len(gated)) - 10.0
+    gated = [p for p in gated if loudness(p) > relative]
+    return loudness(sum(gated) / len(gated))
+
+
+def trim_silence(samples, rate, threshold_db):
+    """回傳有聲音的範圍 (start, end)（樣本索引），全是靜音時回傳 None"""
+    window = max(1, rate * WINDOW_MS // 1000)
+    limit = (10.0 ** (threshold_db / 20.0) * 32768.0) ** 2
+    loud = []
+    for i in range(0, len(samples), window):
+        chunk = samples[i:i + window]
+        loud.append(sum(s * s for s in chunk) / len(chunk) > limit)
+    if not any(loud):
+        return None
+
+    first = loud.index(True)
+    last = len(loud) - 1 - loud[::-1].index(True)
+    start = max(0, first * window - rate * PAD_START_MS // 1000)
+    end = min(len(samples), (last + 1) * window + rate * PAD_END_MS // 1000)
+    return start, end
+
+
+def analyze(path, args):
+    rate, samples, data_start, file_size = read_wav(path)
+    span = trim_silence(samples, rate, args.silence)
+    if span is None:
+        raise ValueError("整個音檔都是靜音")
+    start, end = span
+
+    loudness = integrated_loudness(samples[start:end], rate)
+    gain_db = 0.0
+    if loudness is not None:
+        gain_db = args.target - loudness
+    peak = max(abs(s) for s in samples[start:end]) or 1
+    peak_db = 20.0 * math.log10(peak / 32768.0)
+    gain_db = min(gain_db, args.peak - peak_db, args.max_gain)
+    gain_db = max(gain_db, -args.max_gain)
+    gain = max(1, min(0xFFFF, int(round(GAIN_UNITY * 10.0 ** (gain_db / 20.0)))))
+
+    return {
+        "rate": rate,
+        "size": file_size,
+        "start": data_start + start * 2,
+        "end": data_start + end * 2,
+        "lead_ms": start * 1000 // rate,
+        "tail_ms": (len(samples) - end) * 1000 // rate,
+        "loudness": loudness,
+        "gain": gain,
+        "gain_db": 20.0 * math.log10(gain / GAIN_UNITY),
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="音檔資料夾（例如 data/）")
+    parser.add_argument("-o", "--output", help="輸出檔（預設 <source>/%s）" % META_NAME)
+    parser.add_argument("--target", type=float, default=-16.0, help="目標響度 LUFS（預設 -16）")
+    parser.add_argument("--silence", type=float, default=-45.0, help="低於幾 dBFS 算靜音（預設 -45）")
+    parser.add_argument("--peak", type=float, default=-1.0, help="峰值上限 dBFS（預設 -1）")
+    parser.add_argument("--max-gain", type=float, default=12.0, help="增益上限 dB（預設 12）")
+    args = parser.parse_args()
+
+    names = sorted(n for n in os.listdir(args.source) if n.lower().endswith(".wav"))
+    if not names:
+        raise SystemExit("%s 中沒有 .wav 檔" % args.source)
+    if len(names) > MAX_CLIPS:
+        raise SystemExit("最多 %d 個音檔，目前 %d 個" % (MAX_CLIPS, len(names)))
+
+    entries = []
+    print("%-24s %8s %8s %10s %8s" % ("音檔", "開頭靜音", "結尾靜音", "響度", "增益"))
+    for name in names:
+        encoded = name.encode("utf-8")
+        if len(encoded) >= NAME_LEN:
+            raise SystemExit("檔名太長（上限 %d bytes）：%s" % (NAME_LEN - 1, name))
+        try:
+            info = analyze(os.path.join(args.source, name), args)
+        except ValueError as e:
+            print("⚠️  %s：%s，略過" % (name, e))
+            continue
+
+        loudness = info["loudness"]
+        loudness_tenths = int(round(loudness * 10)) if loudness is not None else -32768
+        entries.append(ENTRY.pack(encoded, info["size"], info["start"], info["end"], info["gain"],
+                                  max(-32768, min(32767, loudness_tenths))))
+        print("%-24s %6d ms %6d ms %10s %+6.1f dB" % (
+            name, info["lead_ms"], info["tail_ms"],
+            "%.1f LUFS" % loudness if loudness is not None else "（太短）", info["gain_db"]))
+
+    body = MAGIC + struct.pack("<HH", VERSION, len(entries)) + b"".join(entries)
+    output = args.output or os.path.join(args.source, META_NAME)
+    with open(output, "wb") as f:
+        f.write(body + struct.pack("<I", zlib.crc32(body)))
+    print("✅ %s：%d 個音檔（目標 %.1f LUFS）" % (output, len(entries), args.target))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
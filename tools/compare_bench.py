@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""解析效能測試韌體（env:perf_bench）的輸出，比較兩次量測。
+
+用法：
+  # 列出一次量測的結果
+  python3 tools/compare_bench.py run.txt
+
+  # 比較修改前後，變差超過 --threshold 的項目標成 ❌，有任何一項變差時結束碼為 1
+  python3 tools/compare_bench.py before.txt after.txt --threshold 5
+
+  # 直接從序列埠讀取（需要 pyserial，會重新啟動開發板），並存檔
+  python3 tools/compare_bench.py --port /dev/cu.usbserial-1120 --save after.txt before.txt
+
+格式定義見 test/test_perf_benchmark.cpp：
+  BENCH_INFO key=value ...
+  BENCH <項目> key=value ...     名稱以 _us 結尾的越小越好，其他越大越好
+  BENCH_DONE
+"""
+
+import argparse
+import re
+import sys
+import time
+
+# 序列埠監視器可能在每行前面加上時間戳記，只找 BENCH 開頭的部分
+LINE = re.compile(r"(BENCH_INFO|BENCH_DONE|BENCH)\b(.*)")
+
+
+def parse_fields(text):
+    fields = {}
+    for token in text.split():
+        if "=" in token:
+            key, value = token.split("=", 1)
+            fields[key] = value
+    return fields
+
+
+def parse(text):
+    """回傳 (info, results, done)，results 為 {項目: {指標: 數值}}，保留輸出順序"""
+    info = {}
+    results = {}
+    done = False
+    for line in text.splitlines():
+        match = LINE.search(line)
+        if not match:
+            continue
+        kind, rest = match.group(1), match.group(2).strip()
+        if kind == "BENCH_INFO":
+            info.update(parse_fields(rest))
+        elif kind == "BENCH_DONE":
+            done = True
+        elif rest:
+            name, _, metrics = rest.partition(" ")
+            values = {}
+            for key, value in parse_fields(metrics).items():
+                try:
+                    values[key] = float(value)
+                except ValueError:
+                    pass
+            results[name] = values
+    return info, results, done
+
+
+def lower_is_better(metric):
+    return metric.endswith("_us")
+
+
+def read_from_port(port, baud, timeout):
+    import serial  # pyserial
+
+    with serial.Serial(port, baud, timeout=0.2) as ser:
+        # 拉 RTS 重新啟動（效能測試只在開機時執行一次）
+        ser.dtr = False
+        ser.rts = True
+        time.sleep(0.1)
+        ser.rts = False
+        ser.reset_input_buffer()
+
+        data = b""
+        deadline = time.time() + timeout
+        while time.time() < deadline and b"BENCH_DONE" not in data:
+            data += ser.read(4096)
+        return data.decode("utf-8", errors="replace")
+
+
+def load(path):
+    with open(path, "rb") as f:
+        return f.read().decode("utf-8", errors="replace")
+
+
+def format_value(value):
+    return "%.1f" % value if value != int(value) else "%d" % value
+
+
+def show(info, results):
+    if info:
+        print("設定：" + "，".join("%s=%s" % item for item in info.items()))
+    for name, values in results.items():
+        print("%-28s %s" % (name, "  ".join("%s=%s" % (k, format_value(v)) for k, v in values.items())))
+
+
+def compare(before, after, threshold):
+    """印出比較表，回傳變差的項目數"""
+    info_a, results_a, _ = before
+    info_b, results_b, _ = after
+
+    for key in sorted(set(info_a) | set(info_b)):
+        if info_a.get(key) != info_b.get(key):
+            print("⚠️  設定不同：%s %s → %s" % (key, info_a.get(key, "-"), info_b.get(key, "-")))
+
+    regressions = 0
+    print("%-28s %-14s %12s %12s %9s" % ("項目", "指標", "修改前", "修改後", "變化"))
+    for name, values_b in results_b.items():
+        values_a = results_a.get(name)
+        if values_a is None:
+            print("%-28s （新增）" % name)
+            continue
+        for metric, new in values_b.items():
+            if metric not in values_a:
+                continue
+            old = values_a[metric]
+            if old == 0:
+                change = 0.0 if new == 0 else float("inf")
+            else:
+                change = (new - old) * 100.0 / old
+            worse = change > threshold if lower_is_better(metric) else change < -threshold
+            better = change < -threshold if lower_is_better(metric) else change > threshold
+            mark = "❌" if worse else ("✅" if better else "")
+            regressions += worse
+            print(("%-28s %-14s %12s %12s %+8.1f%% %s" % (
+                name, metric, format_value(old), format_value(new), change, mark)).rstrip())
+    for name in results_a:
+        if name not in results_b:
+            print("%-28s （少了這項）" % name)
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("files", nargs="*", help="序列埠輸出檔：一個列出結果，兩個為修改前、修改後")
+    parser.add_argument("--port", help="從序列埠讀取這次的量測（當作修改後）")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=60.0)
+    parser.add_argument("--save", help="把序列埠讀到的輸出存檔")
+    parser.add_argument("--threshold", type=float, default=5.0, help="變化超過幾 %% 才算變好或變差（預設 5）")
+    args = parser.parse_args()
+
+    texts = [load(path) for path in args.files]
+    if args.port:
+        text = read_from_port(args.port, args.baud, args.timeout)
+        if args.save:
+            with open(args.save, "w") as f:
+                f.write(text)
+        texts.append(text)
+    if not 1 <= len(texts) <= 2:
+        parser.error("請指定一到兩個輸出檔（或 --port）")
+
+    runs = [parse(text) for text in texts]
+    for i, (info, results, done) in enumerate(runs):
+        if not results:
+            print("❌ 第 %d 份輸出沒有量測結果" % (i + 1), file=sys.stderr)
+            return 1
+        if not done:
+            print("⚠️  第 %d 份輸出不完整（沒有 BENCH_DONE）" % (i + 1), file=sys.stderr)
+
+    if len(runs) == 1:
+        show(runs[0][0], runs[0][1])
+        return 0
+
+    regressions = compare(runs[0], runs[1], args.threshold)
+    if regressions:
+        print("\n❌ %d 項變差超過 %.0f%%" % (regressions, args.threshold))
+        return 1
+    print("\n✅ 沒有變差超過 %.0f%% 的項目" % args.threshold)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""解析 ESP32 事件紀錄的二進位輸出（序列埠指令 L）。
+
+用法：
+  # 直接從序列埠讀取（需要 pyserial）
+  python3 tools/decode_event_log.py --port /dev/cu.usbserial-1120
+
+  # 解析先前存下來的序列埠輸出
+  python3 tools/decode_event_log.py capture.bin
+
+格式定義見 src/event_log.cpp 的 eventLogDump()。
+"""
+
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+MAGIC = b"FTBL"
+HEADER = struct.Struct("<4sBBHHH")
+EVENT = struct.Struct("<HBBI")
+
+EVENT_NAMES = {
+    1: "開機",
+    2: "任務切換",
+    3: "開放抽籤",
+    4: "抽籤",
+    5: "播放音檔",
+    6: "抽籤逾時",
+    7: "跳過播放",
+    8: "音檔排隊",
+    9: "藍牙連線",
+}
+
+COLORS = ["紅", "綠", "藍"]
+CATEGORIES = ["Dad", "Mom", "SX"]
+
+RESET_REASONS = [
+    "UNKNOWN", "POWERON", "EXT", "SW", "PANIC", "INT_WDT",
+    "TASK_WDT", "WDT", "DEEPSLEEP", "BROWNOUT", "SDIO",
+]
+
+
+def describe(event_type, arg):
+    if event_type == 1:
+        return RESET_REASONS[arg] if arg < len(RESET_REASONS) else str(arg)
+    if event_type == 2:
+        color = COLORS[arg & 0x03] if (arg & 0x03) < 3 else "?"
+        return color + ("燈開啟" if arg & 0x80 else "燈關閉")
+    if event_type == 9:
+        return "連線" if arg else "斷線"
+    if event_type in (4, 5, 8):
+        if arg == 0xFF:
+            return "（未知音檔）"
+        category = arg >> 4
+        name = CATEGORIES[category] if category < len(CATEGORIES) else "?"
+        return "%s #%d" % (name, arg & 0x0F)
+    return ""
+
+
+def decode(data):
+    start = data.find(MAGIC)
+    if start < 0:
+        raise ValueError("找不到事件紀錄標頭（FTBL）")
+
+    magic, version, record_size, count, boot, dropped = HEADER.unpack_from(data, start)
+    if version != 1 or record_size != EVENT.size:
+        raise ValueError("不支援的格式：版本 %d，單筆 %d bytes" % (version, record_size))
+
+    body_end = start + HEADER.size + count * record_size
+    if len(data) < body_end + 4:
+        raise ValueError("資料不完整：預期 %d 筆事件" % count)
+
+    (crc,) = struct.unpack_from("<I", data, body_end)
+    if zlib.crc32(data[start:body_end]) != crc:
+        raise ValueError("CRC 錯誤，資料可能在傳輸時損毀")
+
+    events = [EVENT.unpack_from(data, start + HEADER.size + i * record_size) for i in range(count)]
+    return boot, dropped, events
+
+
+def read_from_port(port, baud, timeout):
+    import serial  # pyserial
+
+    with serial.Serial(port, baud, timeout=0.2) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"L")
+        data = b""
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            data += ser.read(4096)
+            try:
+                decode(data)
+                return data
+            except ValueError:
+                continue
+        return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", nargs="?", help="序列埠輸出檔（省略時使用 --port）")
+    parser.add_argument("--port", help="序列埠裝置")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=5.0)
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    elif args.port:
+        data = read_from_port(args.port, args.baud, args.timeout)
+    else:
+        parser.error("請指定檔案或 --port")
+
+    try:
+        boot, dropped, events = decode(data)
+    except ValueError as e:
+        print("❌ %s" % e, file=sys.stderr)
+        return 1
+
+    print("目前開機次數：%d，共 %d 筆事件，丟棄 %d 筆" % (boot, len(events), dropped))
+    print("%-6s %-12s %-10s %s" % ("開機", "時間(秒)", "事件", "內容"))
+    for boot_no, event_type, arg, ms in events:
+        name = EVENT_NAMES.get(event_type, "類型%d" % event_type)
+        print("%-6d %-12.1f %-10s %s" % (boot_no, ms / 1000.0, name, describe(event_type, arg)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
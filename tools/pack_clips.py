@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""把 data/ 中的 WAV 音檔打包成 raw 音檔分區映像（CLIP_STORAGE_RAW 使用）。
+
+用法：
+  python3 tools/pack_clips.py data/ -o clips.bin
+  esptool.py --chip esp32 write_flash 0x140000 clips.bin
+
+格式定義見 src/clip_storage.h（RawClipStorage）。
+分區位址與大小預設取自 partitions_custom.csv 的 spiffs 分區。
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = b"FTBC"
+VERSION = 1
+NAME_LEN = 32
+MAX_CLIPS = 32
+SECTOR = 4096
+ENTRY = struct.Struct("<%dsII" % NAME_LEN)
+META_NAME = "clips.meta"
+
+
+def read_partition(csv_path, label):
+    with open(csv_path) as f:
+        for line in f:
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            fields = [x.strip() for x in line.split(",")]
+            if fields[0] == label:
+                return int(fields[3], 0), int(fields[4], 0)
+    raise SystemExit("partitions 檔中找不到分區 '%s'" % label)
+
+
+def align(value, boundary=SECTOR):
+    return (value + boundary - 1) // boundary * boundary
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="音檔資料夾（例如 data/）")
+    parser.add_argument("-o", "--output", default="clips.bin")
+    parser.add_argument("--partitions", default="partitions_custom.csv")
+    parser.add_argument("--label", default="spiffs")
+    args = parser.parse_args()
+
+    offset, size = read_partition(args.partitions, args.label)
+    names = sorted(n for n in os.listdir(args.source) if n.lower().endswith(".wav"))
+    if not names:
+        raise SystemExit("%s 中沒有 .wav 檔" % args.source)
+    # analyze_clips.py 產生的播放資訊（音量、頭尾靜音）一起打包
+    if os.path.exists(os.path.join(args.source, META_NAME)):
+        names.append(META_NAME)
+    if len(names) > MAX_CLIPS:
+        raise SystemExit("最多 %d 個檔案，目前 %d 個" % (MAX_CLIPS, len(names)))
+
+    header_len = 8 + len(names) * ENTRY.size
+    position = align(header_len)
+    entries = []
+    blobs = []
+    for name in names:
+        encoded = name.encode("utf-8")
+        if len(encoded) >= NAME_LEN:
+            raise SystemExit("檔名太長（上限 %d bytes）：%s" % (NAME_LEN - 1, name))
+        with open(os.path.join(args.source, name), "rb") as f:
+            data = f.read()
+        entries.append(ENTRY.pack(encoded, position, len(data)))
+        blobs.append((position, data))
+        position = align(position + len(data))
+
+    if position > size:
+        raise SystemExit("音檔總大小 %d bytes 超過分區大小 %d bytes" % (position, size))
+
+    image = bytearray(b"\xff" * position)
+    image[0:8] = MAGIC + struct.pack("<HH", VERSION, len(names))
+    image[8:header_len] = b"".join(entries)
+    for start, data in blobs:
+        image[start:start + len(data)] = data
+
+    with open(args.output, "wb") as f:
+        f.write(image)
+
+    for name, (start, data) in zip(names, blobs):
+        print("  %-31s offset 0x%06x  %8d bytes" % (name, start, len(data)))
+    print("✅ %s：%d 個檔案，%d / %d bytes" % (args.output, len(names), len(image), size))
+    print("燒錄：esptool.py --chip esp32 write_flash 0x%x %s" % (offset, args.output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
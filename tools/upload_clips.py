@@ -0,0 +1,269 @@
+#!/usr/bin/env python3
+"""透過序列埠上傳音檔到裝置（不用重新燒錄整個檔案系統，也不用重新開機）。
+
+用法：
+  python3 tools/upload_clips.py --port /dev/cu.usbserial-1120 data/Dad_1.wav data/Mom_2.wav
+  python3 tools/upload_clips.py --port /dev/cu.usbserial-1120 data/*.wav data/clips.meta
+
+送出序列埠指令 U，裝置切換到高速鮑率後分段傳送；每段都有 CRC，錯誤或逾時自動重送，
+整個檔案的 CRC 通過後裝置才取代舊檔，結束後重新掃描音檔。
+換了音檔記得用 tools/analyze_clips.py 重新產生 clips.meta 一起上傳。
+
+協定定義見 src/serial_upload.h。有安裝 pyserial 時使用 pyserial，
+否則直接用 termios（Linux / macOS，模擬器的虛擬終端機也可以）。
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+import zlib
+
+SYNC = b"\xa5\x5a"
+HEADER = struct.Struct("<BHH")
+REPLY = struct.Struct("<BI")
+NAME_LEN = 32
+NAME_MAX = 30
+META_NAME = "clips.meta"
+NORMAL_BAUD = 115200
+
+OK, BAD_FRAME, BAD_STATE, BAD_OFFSET, BAD_NAME, UNSUPPORTED, WRITE_FAILED, BAD_CHECKSUM = range(8)
+STATUS_TEXT = {
+    BAD_FRAME: "封包損壞",
+    BAD_STATE: "裝置沒有開始接收檔案",
+    BAD_OFFSET: "資料位置不連續",
+    BAD_NAME: "檔名不接受（只能是 .wav 或 clips.meta，最多 %d 個字元）" % NAME_MAX,
+    UNSUPPORTED: "儲存後端不能寫入（raw 分區請用 tools/pack_clips.py）",
+    WRITE_FAILED: "寫入失敗（空間不足？）",
+    BAD_CHECKSUM: "整個檔案的 CRC 不符",
+}
+
+REPLY_TIMEOUT = 0.5
+RETRIES = 10
+
+
+class UploadError(Exception):
+    pass
+
+
+class TermiosPort:
+    """不依賴 pyserial 的序列埠（raw 模式）"""
+
+    def __init__(self, path, baud):
+        import termios
+        self.termios = termios
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+        attrs = termios.tcgetattr(self.fd)
+        attrs[0] = 0                                    # iflag
+        attrs[1] = 0                                    # oflag
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attrs[3] = 0                                    # lflag：不回顯、不處理換行
+        attrs[6][termios.VMIN] = 0
+        attrs[6][termios.VTIME] = 0
+        termios.tcsetattr(self.fd, termios.TCSANOW, attrs)
+        self.set_baud(baud)
+
+    def set_baud(self, baud):
+        speed = getattr(self.termios, "B%d" % baud, None)
+        if speed is None:
+            raise UploadError("termios 不支援 %d bps，請安裝 pyserial" % baud)
+        attrs = self.termios.tcgetattr(self.fd)
+        attrs[4] = attrs[5] = speed
+        self.termios.tcsetattr(self.fd, self.termios.TCSADRAIN, attrs)
+
+    def write(self, data):
+        import select
+        view = memoryview(data)
+        while view:
+            select.select([], [self.fd], [], 1.0)
+            try:
+                view = view[os.write(self.fd, view):]
+            except BlockingIOError:
+                pass
+
+    def read(self, timeout):
+        import select
+        if not select.select([self.fd], [], [], timeout)[0]:
+            return b""
+        try:
+            return os.read(self.fd, 4096)
+        except BlockingIOError:
+            return b""
+
+    def close(self):
+        os.close(self.fd)
+
+
+class PySerialPort:
+    def __init__(self, path, baud):
+        import serial  # pyserial
+        self.ser = serial.Serial(path, baud, timeout=0)
+
+    def set_baud(self, baud):
+        self.ser.flush()
+        self.ser.baudrate = baud
+
+    def write(self, data):
+        self.ser.write(data)
+
+    def read(self, timeout):
+        self.ser.timeout = timeout
+        return self.ser.read(max(1, self.ser.in_waiting))
+
+    def close(self):
+        self.ser.close()
+
+
+def open_port(path, baud=NORMAL_BAUD):
+    try:
+        import serial  # noqa: F401
+    except ImportError:
+        return TermiosPort(path, baud)
+    return PySerialPort(path, baud)
+
+
+def frame(kind, seq, payload=b""):
+    body = HEADER.pack(ord(kind), seq, len(payload)) + payload
+    return SYNC + body + struct.pack("<I", zlib.crc32(body))
+
+
+class Uploader:
+    def __init__(self, port, log=print):
+        self.port = port
+        self.log = log
+        self.rx = bytearray()
+        self.seq = 0
+        self.chunk = 0
+        self.resends = 0
+
+    def enter(self, timeout=10.0):
+        """送出指令 U，等裝置回報上傳鮑率後切換"""
+        self.port.write(b"U")
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            self.rx += self.port.read(0.1)
+            while b"\n" in self.rx:
+                line, _, rest = bytes(self.rx).partition(b"\n")
+                self.rx = bytearray(rest)
+                if line.startswith(b"FTBU "):
+                    baud = int(line.split()[1])
+                    self.port.set_baud(baud)
+                    time.sleep(0.05)
+                    self.rx.clear()
+                    _, self.chunk = self.request("H")
+                    return baud
+        raise UploadError("裝置沒有進入上傳模式（序列埠指令 U）")
+
+    def leave(self):
+        try:
+            self.request("Q")
+        finally:
+            self.port.set_baud(NORMAL_BAUD)
+
+    def request(self, kind, payload=b""):
+        """送出一個封包並等待回覆，逾時或封包損壞時用同一個序號重送"""
+        self.seq = (self.seq + 1) & 0xFFFF
+        data = frame(kind, self.seq, payload)
+        for attempt in range(RETRIES):
+            if attempt > 0:
+                self.resends += 1
+            self.port.write(data)
+            reply = self.read_reply(self.seq)
+            if reply is None or reply[0] == BAD_FRAME:
+                continue
+            return reply
+        raise UploadError("裝置沒有回應（重送 %d 次）" % RETRIES)
+
+    def read_reply(self, seq):
+        deadline = time.monotonic() + REPLY_TIMEOUT
+        while True:
+            start = self.rx.find(SYNC)
+            if start < 0:
+                del self.rx[:max(0, len(self.rx) - 1)]  # 其他序列埠輸出
+            else:
+                del self.rx[:start]
+                size = 2 + HEADER.size + REPLY.size + 4
+                if len(self.rx) >= size:
+                    body = bytes(self.rx[2:size - 4])
+                    crc, = struct.unpack_from("<I", self.rx, size - 4)
+                    kind, reply_seq, length = HEADER.unpack_from(body)
+                    if crc != zlib.crc32(body) or kind != ord("K") or length != REPLY.size:
+                        del self.rx[:1]  # 不是回覆，繼續找下一個同步
+                        continue
+                    del self.rx[:size]
+                    if reply_seq == seq:
+                        return REPLY.unpack_from(body, HEADER.size)
+                    continue  # 先前重送的封包的回覆
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return None
+            self.rx += self.port.read(remaining)
+
+    def check(self, status, what):
+        if status != OK:
+            raise UploadError("%s：%s" % (what, STATUS_TEXT.get(status, "錯誤 %d" % status)))
+
+    def upload(self, name, data):
+        encoded = name.encode("utf-8")
+        status, _ = self.request("B", struct.pack("<%dsII" % NAME_LEN, encoded, len(data), zlib.crc32(data)))
+        self.check(status, name)
+
+        offset = 0
+        while offset < len(data):
+            piece = data[offset:offset + self.chunk]
+            status, value = self.request("D", struct.pack("<I", offset) + piece)
+            if status not in (OK, BAD_OFFSET):
+                self.check(status, name)
+            offset = value  # 位置不連續時從裝置收到的位置繼續
+
+        status, _ = self.request("E")
+        self.check(status, name)
+
+
+def check_name(path):
+    name = os.path.basename(path)
+    if len(name.encode("utf-8")) > NAME_MAX or not (name.endswith(".wav") or name == META_NAME):
+        raise SystemExit("檔名不接受（只能是 .wav 或 %s，最多 %d 個字元）：%s" % (META_NAME, NAME_MAX, name))
+    return name
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", required=True, help="序列埠（例如 /dev/cu.usbserial-1120）")
+    parser.add_argument("files", nargs="+", help=".wav 音檔或 clips.meta")
+    args = parser.parse_args()
+
+    names = [check_name(path) for path in args.files]
+    port = open_port(args.port)
+    uploader = Uploader(port)
+    try:
+        baud = uploader.enter()
+        print("上傳模式 %d bps，每段 %d bytes" % (baud, uploader.chunk))
+        total = 0
+        start = time.monotonic()
+        for path, name in zip(args.files, names):
+            with open(path, "rb") as f:
+                data = f.read()
+            file_start = time.monotonic()
+            uploader.upload(name, data)
+            elapsed = time.monotonic() - file_start
+            print("  ✅ %-30s %7d bytes  %.1f KB/s" % (name, len(data), len(data) / 1024 / max(elapsed, 1e-6)))
+            total += len(data)
+        uploader.leave()
+    except UploadError as error:
+        try:
+            uploader.leave()
+        except UploadError:
+            pass
+        raise SystemExit("❌ %s" % error)
+    finally:
+        port.close()
+
+    elapsed = time.monotonic() - start
+    print("共 %d bytes，%.1f 秒（%.1f KB/s），重送 %d 次；裝置會重新掃描音檔" %
+          (total, elapsed, total / 1024 / max(elapsed, 1e-6), uploader.resends))
+
+
+if __name__ == "__main__":
+    main()